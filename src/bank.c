@@ -0,0 +1,265 @@
+//  Sample banks: files of stored truncated Gaussian values.
+//  See bank.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtnorm_impl.h"
+#include "chunks.h"
+#include "binio.h"
+#include "bank.h"
+
+// Blocks are aligned on boundaries of this many bytes.
+#define BANK_ALIGN 4096
+
+_Static_assert(sizeof(BankHeader) == 152, "BankHeader has padding");
+
+struct Bank {
+    char       *map;
+    size_t      mapsize;
+    const BankHeader *hdr;
+    const uint64_t *sum;        // checksum of each block
+};
+
+// Arguments of fill_block
+typedef struct Fill {
+    const BankHeader *hdr;
+    char       *map;
+    uint64_t   *sum;
+} Fill;
+
+static size_t round_up(size_t x, size_t m);
+static size_t block_size(const BankHeader * hdr, size_t i);
+static void fill_block(gsl_rng * rng, long i, void *arg);
+static int  host_is_little_endian(void);
+
+static size_t round_up(size_t x, size_t m) {
+    return (x + m - 1) / m * m;
+}
+
+// Number of values in block i
+static size_t block_size(const BankHeader * hdr, size_t i) {
+    size_t      first = i * hdr->block_len;
+    return hdr->n - first < hdr->block_len ? hdr->n - first : hdr->block_len;
+}
+
+static int host_is_little_endian(void) {
+    const uint16_t one = 1;
+    return *(const unsigned char *) &one == 1;
+}
+
+// 64-bit checksum of size bytes at buf. Four independent lanes
+// multiply and mix 8-byte words, so that the checksum runs at memory
+// speed; bytes left over at the end are folded in one at a time.
+uint64_t bank_checksum(const void *buf, size_t size) {
+    const unsigned char *p = buf;
+    const uint64_t mul = 0x9e3779b97f4a7c15ULL;
+    uint64_t    h[4] = { 1, 2, 3, 4 }, w, r;
+    size_t      i, j;
+
+    for(i = 0; i + 32 <= size; i += 32) {
+        for(j = 0; j < 4; ++j) {
+            memcpy(&w, p + i + 8 * j, 8);
+            h[j] = (h[j] ^ w) * mul;
+            h[j] ^= h[j] >> 29;
+        }
+    }
+    r = size;
+    for(j = 0; j < 4; ++j)
+        r = (r ^ h[j]) * mul;
+    for(; i < size; ++i)
+        r = (r ^ p[i]) * mul;
+    r ^= r >> 32;
+    return r;
+}
+
+// Generate block i into its place in the map, and record its checksum.
+// The block is written through the cache, since the checksum reads it
+// back at once.
+static void fill_block(gsl_rng * rng, long i, void *arg) {
+    Fill       *f = arg;
+    size_t      len = block_size(f->hdr, i);
+    double     *v = (double *) (f->map + f->hdr->data_offset
+                                + i * f->hdr->block_stride);
+
+    rtnorm_fill_cached(rng, f->hdr->a, f->hdr->b, f->hdr->mu, f->hdr->sigma,
+                       len, v);
+    f->sum[i] = bank_checksum(v, len * sizeof(double));
+}
+
+void bank_write(const char *fname, double a, double b, double mu,
+                double sigma, const gsl_rng_type *T, unsigned long seed,
+                size_t n, int nthreads) {
+    BankHeader  hdr;
+    Fill        f;
+    size_t      size;
+
+    if(!host_is_little_endian()) {
+        fprintf(stderr, "%s:%d: bank files are little-endian,"
+                " and this host is not\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    if(strlen(T->name) >= sizeof(hdr.generator)) {
+        fprintf(stderr, "%s:%d: generator name too long: %s\n",
+                __FILE__, __LINE__, T->name);
+        exit(1);
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    strcpy(hdr.magic, BANK_MAGIC);
+    hdr.version = BANK_VERSION;
+    hdr.header_size = sizeof(hdr);
+    hdr.a = a;
+    hdr.b = b;
+    hdr.mu = mu;
+    hdr.sigma = sigma;
+    strcpy(hdr.generator, T->name);
+    hdr.seed = seed;
+    hdr.streams = BANK_STREAMS_CHUNKED;
+    hdr.elsize = sizeof(double);
+    hdr.table_version = rtnorm_table_version();
+    hdr.n = n;
+    hdr.block_len = RTNORM_CHUNK;
+    hdr.nblocks = (n + RTNORM_CHUNK - 1) / RTNORM_CHUNK;
+    hdr.block_stride = round_up(RTNORM_CHUNK * sizeof(double), BANK_ALIGN);
+    hdr.data_offset = round_up(sizeof(hdr) + hdr.nblocks * sizeof(uint64_t),
+                               BANK_ALIGN);
+    hdr.checksum = bank_checksum(&hdr, offsetof(BankHeader, checksum));
+
+    size = hdr.data_offset;
+    if(hdr.nblocks > 0)
+        size += (hdr.nblocks - 1) * hdr.block_stride
+            + block_size(&hdr, hdr.nblocks - 1) * sizeof(double);
+
+    f.map = binio_map_out(fname, size);
+    memcpy(f.map, &hdr, sizeof(hdr));
+    f.hdr = (const BankHeader *) f.map;
+    f.sum = (uint64_t *) (f.map + sizeof(hdr));
+    chunks_run(T, seed, 0, hdr.nblocks, nthreads, fill_block, &f);
+    binio_unmap(f.map, size);
+}
+
+Bank *bank_open(const char *fname) {
+    Bank       *bank = malloc(sizeof(Bank));
+    const BankHeader *hdr;
+    size_t      need;
+
+    if(bank == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    bank->map = binio_map_in(fname, &bank->mapsize);
+    hdr = bank->hdr = (const BankHeader *) bank->map;
+    if(bank->mapsize < sizeof(BankHeader)
+       || memcmp(hdr->magic, BANK_MAGIC, sizeof(BANK_MAGIC)) != 0) {
+        fprintf(stderr, "%s: not a sample bank\n", fname);
+        goto fail;
+    }
+    if(!host_is_little_endian()) {
+        fprintf(stderr, "%s:%d: bank files are little-endian,"
+                " and this host is not\n", __FILE__, __LINE__);
+        goto fail;
+    }
+    if(hdr->version != BANK_VERSION
+       || hdr->header_size != sizeof(BankHeader)) {
+        fprintf(stderr, "%s: unsupported bank version %u\n",
+                fname, (unsigned) hdr->version);
+        goto fail;
+    }
+    if(hdr->checksum != bank_checksum(hdr, offsetof(BankHeader, checksum))
+       || hdr->elsize != sizeof(double)
+       || hdr->block_len == 0
+       || hdr->nblocks != (hdr->n + hdr->block_len - 1) / hdr->block_len
+       || hdr->block_stride < hdr->block_len * sizeof(double)
+       || hdr->data_offset < sizeof(BankHeader)
+       + hdr->nblocks * sizeof(uint64_t)) {
+        fprintf(stderr, "%s: corrupt bank header\n", fname);
+        goto fail;
+    }
+    need = hdr->data_offset;
+    if(hdr->nblocks > 0)
+        need += (hdr->nblocks - 1) * hdr->block_stride
+            + block_size(hdr, hdr->nblocks - 1) * sizeof(double);
+    if(bank->mapsize < need) {
+        fprintf(stderr, "%s: truncated bank\n", fname);
+        goto fail;
+    }
+    bank->sum = (const uint64_t *) (bank->map + sizeof(BankHeader));
+    return bank;
+
+  fail:
+    bank_close(bank);
+    return NULL;
+}
+
+void bank_close(Bank * bank) {
+    binio_unmap(bank->map, bank->mapsize);
+    free(bank);
+}
+
+const BankHeader *bank_header(const Bank * bank) {
+    return bank->hdr;
+}
+
+// Pointer to block i, which is found in constant time.
+const double *bank_block(const Bank * bank, size_t i, size_t *len) {
+    const BankHeader *hdr = bank->hdr;
+
+    if(i >= hdr->nblocks) {
+        fprintf(stderr, "%s:%d: block %zu out of range [0,%zu)\n",
+                __FILE__, __LINE__, i, (size_t) hdr->nblocks);
+        exit(1);
+    }
+    *len = block_size(hdr, i);
+    return (const double *) (bank->map + hdr->data_offset
+                             + i * hdr->block_stride);
+}
+
+double bank_value(const Bank * bank, size_t j) {
+    size_t      len;
+    const double *v = bank_block(bank, j / bank->hdr->block_len, &len);
+
+    return v[j % bank->hdr->block_len];
+}
+
+int bank_verify(const Bank * bank, size_t i) {
+    size_t      len;
+    const double *v = bank_block(bank, i, &len);
+
+    return bank_checksum(v, len * sizeof(double)) == bank->sum[i];
+}
+
+int bank_regenerate(const Bank * bank, size_t i) {
+    const BankHeader *hdr = bank->hdr;
+    const gsl_rng_type *T = chunks_rng_type(hdr->generator);
+    gsl_rng    *rng;
+    double     *v;
+    const double *stored;
+    size_t      len;
+    int         same;
+
+    if(T == NULL || hdr->streams != BANK_STREAMS_CHUNKED
+       || hdr->table_version != rtnorm_table_version())
+        return -1;
+
+    stored = bank_block(bank, i, &len);
+    v = malloc(len * sizeof(double));
+    rng = gsl_rng_alloc(T);
+    if(v == NULL || rng == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    gsl_rng_set(rng, chunk_seed(hdr->seed, i));
+    rtnorm_fill_cached(rng, hdr->a, hdr->b, hdr->mu, hdr->sigma, len, v);
+    same = memcmp(v, stored, len * sizeof(double)) == 0;
+    gsl_rng_free(rng);
+    free(v);
+    return same;
+}
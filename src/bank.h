@@ -0,0 +1,85 @@
+//  Sample banks: files of stored truncated Gaussian values.
+//
+//  A bank begins with a header (BankHeader) that records how the
+//  values were generated: the parameters, the GSL generator and seed,
+//  the layout of the random number streams, and a version number of
+//  the tables used by rtnorm. The header is followed by a table of
+//  checksums, one per block, and then by the blocks themselves. Block
+//  i holds values i*block_len, ..., (i+1)*block_len - 1, generated
+//  from a generator seeded with chunk_seed(seed, i). Blocks begin on
+//  page boundaries, so block i starts at byte
+//  data_offset + i*block_stride, and any block can be read, verified,
+//  or regenerated without touching the others.
+//
+//  All integers and values are little-endian.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __BANK_H
+#define __BANK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <gsl/gsl_rng.h>
+
+#define BANK_MAGIC "RTNBANK"
+#define BANK_VERSION 1
+
+// Streams: block i uses a generator seeded with chunk_seed(seed, i)
+#define BANK_STREAMS_CHUNKED 1
+
+// Header of a bank file
+typedef struct BankHeader {
+    char        magic[8];       // BANK_MAGIC, null-terminated
+    uint32_t    version;        // BANK_VERSION
+    uint32_t    header_size;    // sizeof(BankHeader)
+    double      a, b, mu, sigma;    // parameters of rtnorm
+    char        generator[32];  // name of GSL generator
+    uint64_t    seed;           // seed passed to chunk_seed
+    uint32_t    streams;        // BANK_STREAMS_CHUNKED
+    uint32_t    elsize;         // bytes per value: 8
+    uint64_t    table_version;  // rtnorm_table_version() of the writer
+    uint64_t    n;              // number of values
+    uint64_t    block_len;      // values per block
+    uint64_t    nblocks;        // number of blocks
+    uint64_t    block_stride;   // bytes from one block to the next
+    uint64_t    data_offset;    // offset of block 0
+    uint64_t    checksum;       // bank_checksum of preceding fields
+} BankHeader;
+
+typedef struct Bank Bank;
+
+// 64-bit checksum of size bytes at buf.
+uint64_t    bank_checksum(const void *buf, size_t size);
+
+// Generate n values with nthreads threads and store them, as a bank,
+// in file fname. Exits on error.
+void        bank_write(const char *fname, double a, double b, double mu,
+                       double sigma, const gsl_rng_type *T,
+                       unsigned long seed, size_t n, int nthreads);
+
+// Map bank file fname. Returns NULL, after printing a message, if it
+// isn't a valid bank.
+Bank       *bank_open(const char *fname);
+void        bank_close(Bank *bank);
+
+// Header of an open bank.
+const BankHeader *bank_header(const Bank *bank);
+
+// Pointer to block i; set *len to the number of values it holds.
+const double *bank_block(const Bank *bank, size_t i, size_t *len);
+
+// Value number j.
+double      bank_value(const Bank *bank, size_t j);
+
+// Return 1 if block i matches its checksum, 0 otherwise.
+int         bank_verify(const Bank *bank, size_t i);
+
+// Regenerate block i from the recorded generator and seed, and return
+// 1 if the result equals the stored block, 0 otherwise. Returns -1 if
+// the block can't be regenerated here, because the generator is not
+// available or rtnorm's tables differ from the writer's.
+int         bank_regenerate(const Bank *bank, size_t i);
+
+#endif //__BANK_H
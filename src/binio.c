@@ -0,0 +1,197 @@
+//  Binary input and output of arrays of floating-point numbers.
+//  See binio.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "binio.h"
+
+static const char npy_magic[] = "\x93NUMPY";
+
+// Write a NumPy .npy (version 1.0) header into buf. The header is
+// padded with blanks and terminated by a newline.
+size_t npy_header(char *buf, const char *descr, size_t n) {
+    int         len;
+
+    memset(buf, ' ', NPY_HEADER_SIZE);
+    memcpy(buf, npy_magic, 6);
+    buf[6] = 1;                 // major version
+    buf[7] = 0;                 // minor version
+    buf[8] = (NPY_HEADER_SIZE - 10) & 0xff; // header length, little-endian
+    buf[9] = (NPY_HEADER_SIZE - 10) >> 8;
+    len = snprintf(buf + 10, NPY_HEADER_SIZE - 10,
+                   "{'descr': '%s', 'fortran_order': False, 'shape': (%zu,), }",
+                   descr, n);
+    if(len < 0 || len >= NPY_HEADER_SIZE - 11) {
+        fprintf(stderr, "%s:%d: npy header overflow\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    buf[10 + len] = ' ';        // overwrite snprintf's terminating null
+    buf[NPY_HEADER_SIZE - 1] = '\n';
+    return NPY_HEADER_SIZE;
+}
+
+// Parse a .npy header of version 1.0 or 2.0.
+size_t npy_parse(const char *buf, size_t size, char *descr, size_t *n) {
+    size_t      hlen, off;
+    const char *p, *end;
+    char        dict[4096];
+
+    if(size < 10 || memcmp(buf, npy_magic, 6) != 0)
+        return 0;
+    if(buf[6] == 1) {
+        hlen = (unsigned char) buf[8] | ((unsigned char) buf[9] << 8);
+        off = 10;
+    } else if(buf[6] == 2 && size >= 12) {
+        hlen = (unsigned char) buf[8] | ((unsigned char) buf[9] << 8)
+            | ((size_t) (unsigned char) buf[10] << 16)
+            | ((size_t) (unsigned char) buf[11] << 24);
+        off = 12;
+    } else
+        return 0;
+    if(off + hlen > size || hlen >= sizeof(dict))
+        return 0;
+    memcpy(dict, buf + off, hlen);
+    dict[hlen] = '\0';
+    end = dict + hlen;
+
+    if(strstr(dict, "'fortran_order': False") == NULL)
+        return 0;
+    p = strstr(dict, "'descr':");
+    if(p == NULL || sscanf(p, "'descr': '%7[^']'", descr) != 1)
+        return 0;
+    p = strstr(dict, "'shape':");
+    if(p == NULL || sscanf(p, "'shape': (%zu,)", n) != 1)
+        return 0;
+    // Reject arrays of more than one dimension.
+    p = strchr(p, '(');
+    if(p == NULL || (p = strchr(p, ')')) == NULL || p >= end
+       || p[-1] != ',')
+        return 0;
+    return off + hlen;
+}
+
+static int host_is_big_endian(void) {
+    const uint16_t one = 1;
+    return *(const unsigned char *) &one == 0;
+}
+
+// Convert n doubles in place between native and little-endian order.
+void binio_le64(double *v, size_t n) {
+    size_t      i;
+    uint64_t    u;
+
+    if(!host_is_big_endian())
+        return;
+    for(i = 0; i < n; ++i) {
+        memcpy(&u, v + i, sizeof(u));
+        u = __builtin_bswap64(u);
+        memcpy(v + i, &u, sizeof(u));
+    }
+}
+
+// Convert n floats in place between native and little-endian order.
+void binio_le32(float *v, size_t n) {
+    size_t      i;
+    uint32_t    u;
+
+    if(!host_is_big_endian())
+        return;
+    for(i = 0; i < n; ++i) {
+        memcpy(&u, v + i, sizeof(u));
+        u = __builtin_bswap32(u);
+        memcpy(v + i, &u, sizeof(u));
+    }
+}
+
+// Write size bytes to fd, retrying after partial writes.
+void binio_write(int fd, const void *buf, size_t size) {
+    const char *p = buf;
+    ssize_t     m;
+
+    while(size > 0) {
+        m = write(fd, p, size);
+        if(m < 0) {
+            if(errno == EINTR)
+                continue;
+            fprintf(stderr, "%s:%d: write: %s\n",
+                    __FILE__, __LINE__, strerror(errno));
+            exit(1);
+        }
+        p += m;
+        size -= m;
+    }
+}
+
+// Create file fname with length size and map it read/write.
+void *binio_map_out(const char *fname, size_t size) {
+    int         fd;
+    void       *addr;
+
+    fd = open(fname, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(fd < 0) {
+        fprintf(stderr, "%s:%d: can't open %s: %s\n",
+                __FILE__, __LINE__, fname, strerror(errno));
+        exit(1);
+    }
+    if(ftruncate(fd, size) != 0) {
+        fprintf(stderr, "%s:%d: can't extend %s: %s\n",
+                __FILE__, __LINE__, fname, strerror(errno));
+        exit(1);
+    }
+    if(size == 0) {
+        close(fd);
+        return NULL;
+    }
+    addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if(addr == MAP_FAILED) {
+        fprintf(stderr, "%s:%d: can't map %s: %s\n",
+                __FILE__, __LINE__, fname, strerror(errno));
+        exit(1);
+    }
+    close(fd);
+    return addr;
+}
+
+// Map existing file fname read-only.
+void *binio_map_in(const char *fname, size_t *size) {
+    int         fd;
+    struct stat st;
+    void       *addr;
+
+    fd = open(fname, O_RDONLY);
+    if(fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "%s:%d: can't open %s: %s\n",
+                __FILE__, __LINE__, fname, strerror(errno));
+        exit(1);
+    }
+    *size = st.st_size;
+    if(*size == 0) {
+        close(fd);
+        return NULL;
+    }
+    addr = mmap(NULL, *size, PROT_READ, MAP_SHARED, fd, 0);
+    if(addr == MAP_FAILED) {
+        fprintf(stderr, "%s:%d: can't map %s: %s\n",
+                __FILE__, __LINE__, fname, strerror(errno));
+        exit(1);
+    }
+    close(fd);
+    return addr;
+}
+
+// Unmap a region returned by binio_map_out or binio_map_in.
+void binio_unmap(void *addr, size_t size) {
+    if(addr != NULL && size > 0)
+        munmap(addr, size);
+}
@@ -0,0 +1,48 @@
+//  Binary input and output of arrays of floating-point numbers: raw
+//  little-endian files, NumPy .npy files, and memory-mapped files.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __BINIO_H
+#define __BINIO_H
+
+#include <stddef.h>
+
+// Length of the .npy headers written by npy_header. Always a
+// multiple of 64, so that the data that follow are aligned.
+#define NPY_HEADER_SIZE 128
+
+// Write a NumPy .npy (version 1.0) header describing a 1-dimensional
+// array of n elements into buf, which must hold at least
+// NPY_HEADER_SIZE bytes. descr is a NumPy type string such as "<f8"
+// or "<f4". Returns NPY_HEADER_SIZE.
+size_t npy_header(char *buf, const char *descr, size_t n);
+
+// Read a .npy header at the beginning of buf, which holds size
+// bytes. On success, set *descr (at least 8 bytes) and *n, and return
+// the offset of the data. Return 0 if buf does not hold the header of
+// a 1-dimensional, C-ordered array.
+size_t npy_parse(const char *buf, size_t size, char *descr, size_t *n);
+
+// Convert n doubles or floats in place between native and
+// little-endian byte order. These are no-ops on little-endian hosts.
+void binio_le64(double *v, size_t n);
+void binio_le32(float *v, size_t n);
+
+// Write size bytes to file descriptor fd, retrying after partial
+// writes. Exits on error.
+void binio_write(int fd, const void *buf, size_t size);
+
+// Create (or truncate) file fname, extend it to size bytes, and map
+// it into memory for reading and writing. Exits on error.
+void *binio_map_out(const char *fname, size_t size);
+
+// Map existing file fname into memory for reading, and set *size to
+// its length. Exits on error.
+void *binio_map_in(const char *fname, size_t *size);
+
+// Unmap a region returned by binio_map_out or binio_map_in.
+void binio_unmap(void *addr, size_t size);
+
+#endif //__BINIO_H
@@ -0,0 +1,111 @@
+//  Parallel generation of pseudorandom numbers in fixed-size chunks.
+//  See chunks.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <gsl/gsl_rng.h>
+
+#include "chunks.h"
+#include "xoshiro.h"
+
+// State shared by the threads of one call to chunks_run
+typedef struct Shared {
+    const gsl_rng_type *T;
+    unsigned long seed;
+    long        next, end;      // next chunk to hand out; one past last
+    ChunkFn    *fn;
+    void       *arg;
+} Shared;
+
+static void *worker(void *varg);
+
+// Seed of chunk number "chunk" in the stream with the given seed.
+// This is the splitmix64 finalizer applied to a Weyl sequence, so
+// that neighboring chunks get unrelated seeds.
+unsigned long chunk_seed(unsigned long seed, long chunk) {
+    unsigned long long z = (unsigned long long) seed
+        + 0x9e3779b97f4a7c15ULL * (unsigned long long) (chunk + 1);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return (unsigned long) z;
+}
+
+// Each thread pulls chunk indices off the shared counter until none
+// are left.
+static void *worker(void *varg) {
+    Shared     *sh = varg;
+    gsl_rng    *rng = gsl_rng_alloc(sh->T);
+    long        chunk;
+
+    if(rng == NULL) {
+        fprintf(stderr, "%s:%d: can't allocate generator\n",
+                __FILE__, __LINE__);
+        exit(1);
+    }
+
+    while((chunk = __atomic_fetch_add(&sh->next, 1, __ATOMIC_RELAXED))
+          < sh->end) {
+        gsl_rng_set(rng, chunk_seed(sh->seed, chunk));
+        sh->fn(rng, chunk, sh->arg);
+    }
+
+    gsl_rng_free(rng);
+    return NULL;
+}
+
+// Call fn on chunks first, first+1, ..., first+nchunks-1 using
+// nthreads threads. With a single thread, or a single chunk, no
+// threads are created.
+void chunks_run(const gsl_rng_type *T, unsigned long seed, long first,
+                long nchunks, int nthreads, ChunkFn *fn, void *arg) {
+    Shared      sh = {.T = T, .seed = seed, .next = first,
+        .end = first + nchunks, .fn = fn, .arg = arg };
+    pthread_t  *thread;
+    int         i, status;
+
+    if(nthreads > nchunks)
+        nthreads = nchunks;
+    if(nthreads <= 1) {
+        worker(&sh);
+        return;
+    }
+
+    thread = malloc(nthreads * sizeof(thread[0]));
+    if(thread == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    for(i = 0; i < nthreads; ++i) {
+        status = pthread_create(thread + i, NULL, worker, &sh);
+        if(status) {
+            fprintf(stderr, "%s:%d: pthread_create: %s\n",
+                    __FILE__, __LINE__, strerror(status));
+            exit(1);
+        }
+    }
+    for(i = 0; i < nthreads; ++i)
+        pthread_join(thread[i], NULL);
+    free(thread);
+}
+
+// Look up a generator type by name, among GSL's and our own.
+const gsl_rng_type *chunks_rng_type(const char *name) {
+    const gsl_rng_type **t;
+
+    if(strcmp(rtnorm_rng_xoshiro256p->name, name) == 0)
+        return rtnorm_rng_xoshiro256p;
+    if(strcmp(rtnorm_rng_xoshiro256px8->name, name) == 0)
+        return rtnorm_rng_xoshiro256px8;
+    for(t = gsl_rng_types_setup(); *t != NULL; ++t) {
+        if(strcmp((*t)->name, name) == 0)
+            return *t;
+    }
+    return NULL;
+}
@@ -0,0 +1,38 @@
+//  Parallel generation of pseudorandom numbers in fixed-size chunks.
+//
+//  Output is divided into chunks of RTNORM_CHUNK values. Before chunk
+//  c is generated, the random number generator is seeded with
+//  chunk_seed(seed, c). The output therefore depends only on the
+//  seed and the generator type, and not on the number of threads or
+//  the order in which threads happen to process the chunks.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __CHUNKS_H
+#define __CHUNKS_H
+
+#include <gsl/gsl_rng.h>
+
+// Number of values per chunk
+#define RTNORM_CHUNK 65536
+
+// Function that generates chunk number "chunk". On entry, rng has
+// already been seeded for this chunk. arg is passed through from
+// chunks_run.
+typedef void ChunkFn(gsl_rng *rng, long chunk, void *arg);
+
+// Seed of chunk number "chunk" in the stream with the given seed.
+unsigned long chunk_seed(unsigned long seed, long chunk);
+
+// Call fn on chunks first, first+1, ..., first+nchunks-1 using
+// nthreads threads, each with its own generator of type T.
+void chunks_run(const gsl_rng_type *T, unsigned long seed, long first,
+                long nchunks, int nthreads, ChunkFn *fn, void *arg);
+
+// Look up a generator type by name: one of GSL's, "xoshiro256+" or
+// "xoshiro256+x8" (see xoshiro.h). Returns NULL if there is no such
+// generator.
+const gsl_rng_type *chunks_rng_type(const char *name);
+
+#endif //__CHUNKS_H
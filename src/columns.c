@@ -0,0 +1,178 @@
+//  Truncated Gaussian values for every row of a set of binary column
+//  files. See columns.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "chunks.h"
+#include "binio.h"
+#include "columns.h"
+
+// Rows per call to rtnorm_fill_rows. With five columns, a block
+// occupies 40 KB.
+#define BLOCK 1024
+
+// Chunks processed before the pages behind them are released
+#define WINDOW 16
+
+// A memory-mapped column
+typedef struct Column {
+    const char *fname;
+    char       *map;            // beginning of mapping
+    size_t      mapsize;        // bytes mapped
+    size_t      off;            // offset of first value
+    double     *v;              // first value
+    size_t      n;              // number of values
+} Column;
+
+// Everything the threads need
+typedef struct Job {
+    Column      col[5];         // a, b, mu, sigma, out
+    size_t      n;
+} Job;
+
+enum { A, B, MU, SIGMA, OUT };
+
+static void col_open(Column * c, const char *fname);
+static void col_release(Column * c, size_t first, size_t end);
+static void do_chunk(gsl_rng * rng, long chunk, void *arg);
+
+// Map column file fname, which holds raw doubles or a .npy array.
+static void col_open(Column * c, const char *fname) {
+    char        descr[8];
+
+    c->fname = fname;
+    c->map = binio_map_in(fname, &c->mapsize);
+    c->off = npy_parse(c->map, c->mapsize, descr, &c->n);
+    if(c->off > 0) {
+        if(strcmp(descr, "<f8") != 0 || c->off + 8 * c->n > c->mapsize) {
+            fprintf(stderr, "%s:%d: %s: expecting an array of '<f8'\n",
+                    __FILE__, __LINE__, fname);
+            exit(1);
+        }
+    } else {
+        if(c->mapsize % sizeof(double) != 0) {
+            fprintf(stderr, "%s:%d: %s: size isn't a multiple of %zu\n",
+                    __FILE__, __LINE__, fname, sizeof(double));
+            exit(1);
+        }
+        c->n = c->mapsize / sizeof(double);
+    }
+    c->v = (double *) (c->map + c->off);
+    madvise(c->map, c->mapsize, MADV_SEQUENTIAL);
+}
+
+// Release the whole pages that hold rows [first, end) of column c.
+static void col_release(Column * c, size_t first, size_t end) {
+    size_t      page = sysconf(_SC_PAGESIZE);
+    size_t      lo = c->off + first * sizeof(double);
+    size_t      hi = c->off + end * sizeof(double);
+
+    if(c->map == NULL)
+        return;
+    lo = (lo + page - 1) / page * page;
+    hi = hi / page * page;
+    if(hi > lo)
+        madvise(c->map + lo, hi - lo, MADV_DONTNEED);
+}
+
+// Process rows of one chunk, a block at a time.
+static void do_chunk(gsl_rng * rng, long chunk, void *arg) {
+    Job        *job = arg;
+    Column     *c = job->col;
+    size_t      i = (size_t) chunk * RTNORM_CHUNK;
+    size_t      end = i + RTNORM_CHUNK, m;
+
+    if(end > job->n)
+        end = job->n;
+
+    for(; i < end; i += m) {
+        m = end - i;
+        if(m > BLOCK)
+            m = BLOCK;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        {
+            double      buf[4][BLOCK];
+            int         j;
+
+            for(j = A; j <= SIGMA; ++j) {
+                if(c[j].map == NULL)
+                    continue;
+                memcpy(buf[j], c[j].v + i, m * sizeof(double));
+                binio_le64(buf[j], m);
+            }
+            rtnorm_fill_rows(rng, m, buf[A], buf[B],
+                             c[MU].map ? buf[MU] : NULL,
+                             c[SIGMA].map ? buf[SIGMA] : NULL,
+                             c[OUT].v + i);
+        }
+#else
+        rtnorm_fill_rows(rng, m, c[A].v + i, c[B].v + i,
+                         c[MU].map ? c[MU].v + i : NULL,
+                         c[SIGMA].map ? c[SIGMA].v + i : NULL,
+                         c[OUT].v + i);
+#endif
+        binio_le64(c[OUT].v + i, m);
+    }
+}
+
+size_t rtnorm_columns(const char *a, const char *b, const char *mu,
+                      const char *sigma, const char *out,
+                      const gsl_rng_type *T, unsigned long seed,
+                      int nthreads) {
+    Job         job;
+    const char *in[4] = { a, b, mu, sigma };
+    Column     *oc = job.col + OUT;
+    long        nchunks, c, w;
+    int         j;
+
+    memset(&job, 0, sizeof(job));
+    for(j = A; j <= SIGMA; ++j) {
+        if(in[j] == NULL)
+            continue;
+        col_open(job.col + j, in[j]);
+        if(j > A && job.col[j].n != job.col[A].n) {
+            fprintf(stderr, "%s:%d: %s has %zu rows but %s has %zu\n",
+                    __FILE__, __LINE__, in[j], job.col[j].n,
+                    a, job.col[A].n);
+            exit(1);
+        }
+    }
+    job.n = job.col[A].n;
+
+    // Output has the format of column a.
+    oc->fname = out;
+    oc->off = job.col[A].off > 0 ? NPY_HEADER_SIZE : 0;
+    oc->mapsize = oc->off + job.n * sizeof(double);
+    oc->map = binio_map_out(out, oc->mapsize);
+    if(oc->off > 0)
+        npy_header(oc->map, "<f8", job.n);
+    oc->v = (double *) (oc->map + oc->off);
+    oc->n = job.n;
+
+    nchunks = (job.n + RTNORM_CHUNK - 1) / RTNORM_CHUNK;
+    for(c = 0; c < nchunks; c += w) {
+        size_t      first = (size_t) c * RTNORM_CHUNK;
+        size_t      end;
+
+        w = nchunks - c < WINDOW ? nchunks - c : WINDOW;
+        end = (size_t) (c + w) * RTNORM_CHUNK;
+        if(end > job.n)
+            end = job.n;
+        chunks_run(T, seed, c, w, nthreads, do_chunk, &job);
+        for(j = A; j <= OUT; ++j)
+            col_release(job.col + j, first, end);
+    }
+
+    for(j = A; j <= OUT; ++j)
+        binio_unmap(job.col[j].map, job.col[j].mapsize);
+    return job.n;
+}
@@ -0,0 +1,33 @@
+//  Truncated Gaussian values for every row of a set of binary column
+//  files.
+//
+//  Each column holds one double per row, either as raw little-endian
+//  values or as a 1-dimensional NumPy .npy array of type '<f8'. The
+//  columns are memory-mapped, processed in chunks of RTNORM_CHUNK rows
+//  by parallel threads, and the results are written directly into a
+//  memory-mapped output column. Pages that have been processed are
+//  released as the computation proceeds, so memory use does not grow
+//  with the number of rows.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __COLUMNS_H
+#define __COLUMNS_H
+
+#include <stddef.h>
+#include <gsl/gsl_rng.h>
+
+// Draw out[i] from the Gaussian with mean mu[i] and standard
+// deviation sigma[i], truncated to [a[i], b[i]], where each argument
+// names a column file. mu and sigma may be NULL, meaning 0 and 1.
+// The output file has the format of column a. Chunk c is generated
+// with a generator of type T seeded with chunk_seed(seed, c), so the
+// result does not depend on nthreads. Returns the number of rows.
+// Exits on error.
+size_t rtnorm_columns(const char *a, const char *b, const char *mu,
+                      const char *sigma, const char *out,
+                      const gsl_rng_type *T, unsigned long seed,
+                      int nthreads);
+
+#endif //__COLUMNS_H
@@ -0,0 +1,274 @@
+//  Design of rtnorm's tables. See design.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "design.h"
+#include "record.h"
+
+// Designs needing more boxes than this are refused.
+#define MAXBOX (1 << 24)
+
+// log(2*pi)/2
+#define HALF_LOG_2PI 0.918938533204672741780329736406
+
+static double phi(double x);
+static double walk(int n, double A);
+static double solve_xmax(int nright);
+static void finish(Design * d);
+
+// Standard Gaussian density
+static double phi(double x) {
+    return exp(-0.5 * x * x - HALF_LOG_2PI);
+}
+
+// Right end of n boxes of area A laid end to end from 0, each as high
+// as the density at its left end. HUGE_VAL if they run off the table.
+static double walk(int n, double A) {
+    double      x = 0.0;
+    int         i;
+
+    for(i = 0; i < n; ++i) {
+        x += A / phi(x);
+        if(!(x < 40.0))
+            return HUGE_VAL;
+    }
+    return x;
+}
+
+// The xmax at which nright boxes of area Q(xmax) end at xmax. The
+// boxes end further out as xmax falls, so bisect.
+static double solve_xmax(int nright) {
+    double      lo = 0.05, hi = 10.0, mid;
+    int         i;
+
+    for(i = 0; i < 60; ++i) {
+        mid = 0.5 * (lo + hi);
+        if(walk(nright, exp(rtnorm_log_upper(mid))) > mid)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return 0.5 * (lo + hi);
+}
+
+// Set the members of d that follow from its table.
+static void finish(Design * d) {
+    d->A = exp(rtnorm_log_upper(d->t.xmax));
+    d->miss = malloc(2 * (d->t.N + 1) * sizeof(d->miss[0]));
+    if(d->miss == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    rtnorm_table_miss(&d->t, d->miss);
+}
+
+Design *design_build(int nleft, int nright, int kmin) {
+    Design     *d;
+    RtnormTable *t;
+    double     *x, *yu, A;
+    int        *ncell, N = nleft + nright, i, k;
+
+    if(nleft < 1 || nright < 2 || kmin < 0 || N > MAXBOX) {
+        fprintf(stderr, "%s:%d: bad design: %d left, %d right, kmin %d\n",
+                __FILE__, __LINE__, nleft, nright, kmin);
+        return NULL;
+    }
+    d = calloc(1, sizeof(Design));
+    x = malloc((N + 1) * sizeof(double));
+    yu = malloc(N * sizeof(double));
+    if(d == NULL || x == NULL || yu == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+
+    // Right boxes are as high as the density at their left ends, left
+    // boxes as the density at their right ends.
+    A = exp(rtnorm_log_upper(solve_xmax(nright)));
+    x[nleft] = 0.0;
+    for(k = nleft; k < N; ++k) {
+        yu[k] = phi(x[k]);
+        x[k + 1] = x[k] + A / yu[k];
+    }
+    for(k = nleft - 1; k >= 0; --k) {
+        yu[k] = phi(x[k + 1]);
+        x[k] = x[k + 1] - A / yu[k];
+    }
+
+    t = &d->t;
+    t->N = N;
+    t->kmode = nleft - 1;
+    t->kmin = kmin;
+    t->xmin = x[0];
+    t->xmax = x[N];
+    t->xgauss = t->xmin;
+    t->xexp = t->xmax;
+    t->INVH = phi(0.0) / A;
+    t->I0 = -floor(t->xmin * t->INVH);
+    t->nncell = t->I0 + floor(t->xmax * t->INVH) + 1;
+    t->yl0 = phi(t->xmin);
+    t->ylN = phi(t->xmax);
+
+    // ncell[i] is the box holding the left end of cell i.
+    ncell = malloc(t->nncell * sizeof(int));
+    if(ncell == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    for(i = k = 0; i < t->nncell; ++i) {
+        while(k < N - 1 && x[k + 1] <= (i - t->I0) / t->INVH)
+            ++k;
+        ncell[i] = k;
+    }
+
+    t->x = d->xbuf = x;
+    t->yu = d->yubuf = yu;
+    t->ncell = d->ncellbuf = ncell;
+    finish(d);
+    return d;
+}
+
+Design *design_span(double xmin, double xmax, int kmin) {
+    double      A, x;
+    int         nleft, nright;
+
+    if(!(xmin < 0.0 && xmax > 0.0)) {
+        fprintf(stderr, "%s:%d: bad span: [%g, %g]\n", __FILE__, __LINE__,
+                xmin, xmax);
+        return NULL;
+    }
+
+    // Count the boxes of area Q(xmax) that reach xmax, then adjust
+    // xmax so that that many boxes end exactly there.
+    A = exp(rtnorm_log_upper(xmax));
+    for(x = 0.0, nright = 0; x < xmax && nright <= MAXBOX; ++nright)
+        x += A / phi(x);
+    if(nright < 2)
+        nright = 2;
+    A = exp(rtnorm_log_upper(solve_xmax(nright)));
+    for(x = 0.0, nleft = 0; x > xmin && nleft <= MAXBOX; ++nleft)
+        x -= A / phi(x);
+    if(nleft + nright > MAXBOX) {
+        fprintf(stderr, "%s:%d: span [%g, %g] needs too many boxes\n",
+                __FILE__, __LINE__, xmin, xmax);
+        return NULL;
+    }
+    return design_build(nleft, nright, kmin);
+}
+
+Design *design_shipped(void) {
+    Design     *d = calloc(1, sizeof(Design));
+
+    if(d == NULL) {
+        fprintf(stderr, "%s:%d: bad calloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    d->t = rtnorm_table;
+    finish(d);
+    return d;
+}
+
+void design_free(Design * d) {
+    free(d->miss);
+    free(d->xbuf);
+    free(d->yubuf);
+    free(d->ncellbuf);
+    free(d);
+}
+
+size_t design_bytes(const Design * d) {
+    return (2 * d->t.N + 1) * sizeof(double) + d->t.nncell * sizeof(int);
+}
+
+void design_cost(const Design * d, double a, double b, RtnormCost * c) {
+    rtnorm_table_cost(&d->t, d->miss, a, b, c);
+}
+
+void design_write(const Design * d, FILE * fp) {
+    const RtnormTable *t = &d->t;
+    int         k;
+
+    fprintf(fp, "// Pregenerated tables\n\n");
+    fprintf(fp, "// Design constants of the tables. Box k covers [x[k],"
+            " x[k+1]], and all\n"
+            "// boxes have area Q(xmax), the upper tail probability of"
+            " xmax. Boxes\n"
+            "// 0..RTNORM_KMODE lie left of the mode. Tables written by"
+            " rtnormdesign\n"
+            "// (see design.h) have the same form, and can replace this"
+            " file.\n");
+    fprintf(fp, "#define RTNORM_N     %-22d // Index of the right tail\n",
+            t->N);
+    fprintf(fp, "#define RTNORM_KMODE %-22d // Last box left of the mode\n",
+            t->kmode);
+    fprintf(fp, "#define RTNORM_KMIN  %-22d // if kb-ka < kmin then use a"
+            " rejection algorithm\n", t->kmin);
+    fprintf(fp, "#define RTNORM_XMIN  %-22.17g // Left bound\n", t->xmin);
+    fprintf(fp, "#define RTNORM_XMAX  %-22.17g // Right bound\n", t->xmax);
+    fprintf(fp, "#define RTNORM_INVH  %-22.17g // = 1/h, h being the minimal"
+            " interval range\n", t->INVH);
+    fprintf(fp, "#define RTNORM_I0    %-22d // = - floor(x(0)/h)\n", t->I0);
+    fprintf(fp, "#define RTNORM_NCELL %-22d // Length of ncell\n",
+            t->nncell);
+    fprintf(fp, "#define RTNORM_YL0   %-22.17g // y_l of the leftmost"
+            " rectangle\n", t->yl0);
+    fprintf(fp, "#define RTNORM_YLN   %-22.17g // y_l of the rightmost"
+            " rectangle\n", t->ylN);
+
+    fprintf(fp, "\nstatic const double x[%d]=\n{", t->N + 1);
+    for(k = 0; k <= t->N; ++k)
+        fprintf(fp, "%s%.17g%s", k % 4 ? "" : "\n      ", t->x[k],
+                k < t->N ? ", " : " ");
+    fprintf(fp, "\n};\n\n\nstatic const double yu[%d] =\n{", t->N);
+    for(k = 0; k < t->N; ++k)
+        fprintf(fp, "%s%.17g%s", k % 4 ? "" : "\n      ", t->yu[k],
+                k < t->N - 1 ? ", " : " ");
+    fprintf(fp, "\n};\n\n\nstatic const int ncell[%d] =\n{", t->nncell);
+    for(k = 0; k < t->nncell; ++k)
+        fprintf(fp, "%s%d%s", k % 20 ? "" : "\n      ", t->ncell[k],
+                k < t->nncell - 1 ? ", " : "");
+    fprintf(fp, "\n};\n");
+}
+
+int design_workload_load(Workload * w, const char *fname) {
+    size_t      i;
+
+    if(record_load(fname, &w->n, &w->a, &w->b, &w->count) != 0)
+        return -1;
+    for(i = 0, w->total = 0.0; i < w->n; ++i)
+        w->total += w->count[i];
+    if(w->total == 0.0) {
+        fprintf(stderr, "%s: no intervals recorded\n", fname);
+        design_workload_free(w);
+        return -1;
+    }
+    return 0;
+}
+
+void design_workload_free(Workload * w) {
+    free(w->a);
+    free(w->b);
+    free(w->count);
+    w->a = w->b = w->count = NULL;
+    w->n = 0;
+    w->total = 0.0;
+}
+
+double design_workload_cost(const Design * d, const Workload * w,
+                            const DesignWeights * wt) {
+    RtnormCost  c;
+    double      s = 0.0;
+    size_t      i;
+
+    for(i = 0; i < w->n; ++i) {
+        design_cost(d, w->a[i], w->b[i], &c);
+        s += w->count[i] * (wt->uniform * c.uniforms + wt->log * c.logs
+                            + wt->normal * c.normals
+                            + wt->iter[c.regime] * c.iters);
+    }
+    return s / w->total;
+}
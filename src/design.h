@@ -0,0 +1,84 @@
+//  Design of the tables used by rtnorm, and a model of what they cost.
+//
+//  A design is a set of Chopin's boxes: N boxes of equal area A =
+//  Q(xmax) between xmin and xmax, where Q is the upper tail
+//  probability of the standard Gaussian, plus the tail beyond xmax.
+//  Together with kmin, the span in boxes below which rtnorm uses the
+//  exponential proposal, the boxes decide how many uniforms and
+//  logarithms each draw costs on each interval. design_cost predicts
+//  those counts for any design, and design_write writes a design as a
+//  replacement for rtnorm_data.h. design_workload_cost weighs the
+//  counts over a histogram of intervals saved by record.h, on which
+//  rtnormdesign searches for the cheapest design and rtnormtune for
+//  the cheapest thresholds.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __DESIGN_H
+#define __DESIGN_H
+
+#include <stdio.h>
+
+#include "rtnorm_impl.h"
+
+typedef struct Design {
+    RtnormTable t;              // tables and design constants
+    double      A;              // area of each box, = Q(xmax)
+    double     *miss;           // from rtnorm_table_miss
+    double     *xbuf, *yubuf;   // arrays owned by this design, or NULL
+    int        *ncellbuf;
+} Design;
+
+// Build boxes nleft to the left of 0 and nright to the right. The
+// area of the boxes is chosen so that the last right box ends where
+// the tail begins.
+Design     *design_build(int nleft, int nright, int kmin);
+
+// Build boxes reaching about to xmin and exactly to a value of xmax
+// near the one given. Return NULL if xmin or xmax is out of range.
+Design     *design_span(double xmin, double xmax, int kmin);
+
+// The design of the tables compiled into rtnorm
+Design     *design_shipped(void);
+
+void        design_free(Design * d);
+
+// Bytes of table data in design d
+size_t      design_bytes(const Design * d);
+
+// Expected cost of one draw from the standardized interval [a,b]; as
+// rtnorm_cost, for design d.
+void        design_cost(const Design * d, double a, double b,
+                        RtnormCost * c);
+
+// Write d as a replacement for rtnorm_data.h.
+void        design_write(const Design * d, FILE * fp);
+
+// Costs of the operations counted by design_cost, in any unit. The
+// rest of an iteration may cost more in one regime than in another.
+typedef struct DesignWeights {
+    double      uniform, log, normal;
+    double      iter[3];        // indexed by regime
+} DesignWeights;
+
+// A histogram of intervals: count[i] draws from [a[i],b[i]], and
+// total draws in all.
+typedef struct Workload {
+    size_t      n;
+    double     *a, *b, *count, total;
+} Workload;
+
+// Load w from a histogram saved by record_save. Return 0 on success,
+// or -1, with a message, if the file can't be read or records no
+// draws.
+int         design_workload_load(Workload * w, const char *fname);
+
+// Free the arrays of w.
+void        design_workload_free(Workload * w);
+
+// Expected cost per draw of design d on workload w, with weights wt
+double      design_workload_cost(const Design * d, const Workload * w,
+                                 const DesignWeights * wt);
+
+#endif //__DESIGN_H
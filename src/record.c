@@ -0,0 +1,167 @@
+//  Histogram of standardized intervals. See record.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "record.h"
+#include "rtnorm_impl.h"
+
+// Bins of a: underflow, NA_IN bins over [A_LO, A_HI], overflow
+#define NA_IN 256
+#define NA (NA_IN + 2)
+#define A_LO -8.0
+#define A_HI 8.0
+
+// Bins of log10(b-a): underflow, NW_IN bins over [W_LO, W_HI],
+// overflow, which includes infinite widths
+#define NW_IN 64
+#define NW (NW_IN + 2)
+#define W_LO -4.0
+#define W_HI 3.0
+
+static unsigned long *hist;     // NA*NW counts, a-major
+
+static void add(double a, double b, size_t n);
+static int  bin(double v, double lo, double hi, int n);
+static double center(int i, double lo, double hi, int n);
+
+// Bin of v among n bins over [lo,hi], with underflow 0 and overflow
+// n+1. NaN goes to overflow.
+static int bin(double v, double lo, double hi, int n) {
+    if(v < lo)
+        return 0;
+    if(!(v < hi))
+        return n + 1;
+    return 1 + (int) ((v - lo) / (hi - lo) * n);
+}
+
+// Value representing bin i, which is in the range for inner bins.
+// Underflow and overflow are represented by the ends of the range.
+static double center(int i, double lo, double hi, int n) {
+    if(i == 0)
+        return lo;
+    if(i == n + 1)
+        return hi;
+    return lo + (i - 0.5) * (hi - lo) / n;
+}
+
+static void add(double a, double b, size_t n) {
+    int         i = bin(a, A_LO, A_HI, NA_IN);
+    int         j = bin(log10(b - a), W_LO, W_HI, NW_IN);
+
+    __atomic_fetch_add(hist + i * NW + j, n, __ATOMIC_RELAXED);
+}
+
+void record_start(void) {
+    if(hist == NULL)
+        hist = malloc(NA * NW * sizeof(hist[0]));
+    if(hist == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    memset(hist, 0, NA * NW * sizeof(hist[0]));
+    __atomic_store_n(&rtnorm_plan_hook, add, __ATOMIC_RELEASE);
+}
+
+void record_stop(void) {
+    __atomic_store_n(&rtnorm_plan_hook, NULL, __ATOMIC_RELEASE);
+}
+
+unsigned long record_count(void) {
+    unsigned long n = 0;
+    int         i;
+
+    for(i = 0; hist != NULL && i < NA * NW; ++i)
+        n += hist[i];
+    return n;
+}
+
+// Underflow and overflow in a stand for A_LO and A_HI: beyond them,
+// every interval is sampled alike. Overflow in width stands for
+// infinity.
+int record_save(const char *fname) {
+    FILE       *fp = fopen(fname, "w");
+    double      a, w;
+    int         i, j;
+
+    if(fp == NULL) {
+        fprintf(stderr, "%s:%d: can't write %s: %s\n", __FILE__, __LINE__,
+                fname, strerror(errno));
+        return -1;
+    }
+    fprintf(fp, "# rtnorm interval histogram: a b count\n");
+    for(i = 0; hist != NULL && i < NA; ++i) {
+        for(j = 0; j < NW; ++j) {
+            if(hist[i * NW + j] == 0)
+                continue;
+            a = center(i, A_LO, A_HI, NA_IN);
+            w = (j == NW - 1) ? INFINITY
+                : pow(10.0, center(j, W_LO, W_HI, NW_IN));
+            fprintf(fp, "%.17g %.17g %lu\n", a, a + w, hist[i * NW + j]);
+        }
+    }
+    if(fclose(fp) != 0) {
+        fprintf(stderr, "%s:%d: can't write %s: %s\n", __FILE__, __LINE__,
+                fname, strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+int record_load(const char *fname, size_t *n, double **a, double **b,
+                double **count) {
+    FILE       *fp = fopen(fname, "r");
+    char        line[256];
+    size_t      size = 0, line_no = 0;
+    double      u, v, c;
+
+    *n = 0;
+    *a = *b = *count = NULL;
+    if(fp == NULL) {
+        fprintf(stderr, "%s:%d: can't read %s: %s\n", __FILE__, __LINE__,
+                fname, strerror(errno));
+        return -1;
+    }
+    while(fgets(line, sizeof(line), fp) != NULL) {
+        ++line_no;
+        if(line[0] == '#' || line[strspn(line, " \t\n")] == '\0')
+            continue;
+        if(sscanf(line, "%lf %lf %lf", &u, &v, &c) != 3 || !(u < v)
+           || !(c >= 0)) {
+            fprintf(stderr, "%s:%d: %s line %zu: bad bin\n", __FILE__,
+                    __LINE__, fname, line_no);
+            goto fail;
+        }
+        if(*n == size) {
+            size = size ? 2 * size : 1024;
+            *a = realloc(*a, size * sizeof(double));
+            *b = realloc(*b, size * sizeof(double));
+            *count = realloc(*count, size * sizeof(double));
+            if(*a == NULL || *b == NULL || *count == NULL) {
+                fprintf(stderr, "%s:%d: bad realloc\n", __FILE__, __LINE__);
+                exit(1);
+            }
+        }
+        (*a)[*n] = u;
+        (*b)[*n] = v;
+        (*count)[*n] = c;
+        ++*n;
+    }
+    fclose(fp);
+    return 0;
+
+  fail:
+    fclose(fp);
+    free(*a);
+    free(*b);
+    free(*count);
+    *a = *b = *count = NULL;
+    *n = 0;
+    return -1;
+}
@@ -0,0 +1,44 @@
+//  Record the standardized intervals that rtnorm is asked to sample.
+//
+//  While recording, every draw by rtnorm, rtnorm_fill, rtnormf_fill
+//  and the samplers built on them is counted in a histogram of the
+//  standardized bounds (a,b) of its interval, taken after the flip
+//  that puts the larger bound in absolute value on the right. The
+//  histogram is binned on a, in steps of 1/16 over [-8,8], and on the
+//  width b-a, in steps of 7/64 decades over [1e-4,1e3], with overflow
+//  bins on both sides of each range. rtnormdesign (see design.h) reads the
+//  saved histogram and designs tables for it.
+//
+//  Recording adds an atomic add to each interval, not each draw. It is
+//  safe with any number of threads, but start and stop it while no
+//  other thread is sampling.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __RECORD_H
+#define __RECORD_H
+
+#include <stddef.h>
+
+// Start recording, into an empty histogram.
+void        record_start(void);
+
+// Stop recording. The histogram is kept until the next record_start.
+void        record_stop(void);
+
+// Number of draws recorded.
+unsigned long record_count(void);
+
+// Write the nonzero bins of the histogram to a text file, one bin per
+// line as "a b count", where a and b represent the bin. Return 0 on
+// success, or -1 with a message if the file can't be written.
+int         record_save(const char *fname);
+
+// Read a file written by record_save into newly allocated arrays of
+// bounds and counts, and set *n to their length. Return 0 on success,
+// or -1 with a message on failure. Free the arrays with free.
+int         record_load(const char *fname, size_t *n, double **a,
+                        double **b, double **count);
+
+#endif //__RECORD_H
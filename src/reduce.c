@@ -0,0 +1,144 @@
+//  Reductions over truncated Gaussian samples. See reduce.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtnorm_impl.h"
+#include "reduce.h"
+
+// State of the folds below
+typedef struct Sums {
+    double      sum, sumsq;
+} Sums;
+
+typedef struct Hist {
+    double      lo, scale;      // scale = nbins / (hi - lo)
+    int         nbins;
+    unsigned long *count;
+} Hist;
+
+typedef struct Expect {
+    RtnormFn   *f;
+    void       *data;
+    double      sum;
+} Expect;
+
+static void fold_sums(const double *x, size_t m, void *state);
+static void fold_moments(const double *x, size_t m, void *state);
+static void fold_hist(const double *x, size_t m, void *state);
+static void fold_expect(const double *x, size_t m, void *state);
+
+void rtnorm_reduce(gsl_rng * gen, double a, double b, double mu,
+                   double sigma, size_t n, RtnormFold * fold, void *state) {
+    double      x[RTNORM_REDUCE_BLOCK];
+    size_t      m;
+
+    while(n > 0) {
+        m = n < RTNORM_REDUCE_BLOCK ? n : RTNORM_REDUCE_BLOCK;
+        rtnorm_fill_cached(gen, a, b, mu, sigma, m, x);
+        fold(x, m, state);
+        n -= m;
+    }
+}
+
+// Sums within a block are formed separately and then added to the
+// totals, which limits the growth of rounding error.
+static void fold_sums(const double *x, size_t m, void *state) {
+    Sums       *s = state;
+    double      sum = 0.0, sumsq = 0.0;
+    size_t      i;
+
+    for(i = 0; i < m; ++i) {
+        sum += x[i];
+        sumsq += x[i] * x[i];
+    }
+    s->sum += sum;
+    s->sumsq += sumsq;
+}
+
+void rtnorm_sums(gsl_rng * gen, double a, double b, double mu,
+                 double sigma, size_t n, double *sum, double *sumsq) {
+    Sums        s = { 0.0, 0.0 };
+
+    rtnorm_reduce(gen, a, b, mu, sigma, n, fold_sums, &s);
+    *sum += s.sum;
+    *sumsq += s.sumsq;
+}
+
+// Two passes over the block, which is in cache, give its mean and m2
+// accurately; the block is then merged into the running moments.
+static void fold_moments(const double *x, size_t m, void *state) {
+    RtnormMoments blk = { m, 0.0, 0.0 };
+    double      d;
+    size_t      i;
+
+    for(i = 0; i < m; ++i)
+        blk.mean += x[i];
+    blk.mean /= m;
+    for(i = 0; i < m; ++i) {
+        d = x[i] - blk.mean;
+        blk.m2 += d * d;
+    }
+    rtnorm_moments_merge(state, &blk);
+}
+
+void rtnorm_moments(gsl_rng * gen, double a, double b, double mu,
+                    double sigma, size_t n, RtnormMoments * m) {
+    rtnorm_reduce(gen, a, b, mu, sigma, n, fold_moments, m);
+}
+
+// Chan, Golub, and LeVeque's formula for combining moments.
+void rtnorm_moments_merge(RtnormMoments * into, const RtnormMoments * from) {
+    double      n = into->n + from->n, d;
+
+    if(from->n == 0)
+        return;
+    d = from->mean - into->mean;
+    into->mean += d * from->n / n;
+    into->m2 += from->m2 + d * d * into->n * from->n / n;
+    into->n = n;
+}
+
+static void fold_hist(const double *x, size_t m, void *state) {
+    Hist       *h = state;
+    double      t;
+    size_t      i;
+
+    for(i = 0; i < m; ++i) {
+        t = (x[i] - h->lo) * h->scale;
+        if(t >= 0.0 && t < h->nbins)
+            h->count[(int) t] += 1;
+    }
+}
+
+void rtnorm_hist(gsl_rng * gen, double a, double b, double mu,
+                 double sigma, size_t n, double lo, double hi,
+                 int nbins, unsigned long *count) {
+    Hist        h = { lo, nbins / (hi - lo), nbins, count };
+
+    rtnorm_reduce(gen, a, b, mu, sigma, n, fold_hist, &h);
+}
+
+static void fold_expect(const double *x, size_t m, void *state) {
+    Expect     *e = state;
+    double      sum = 0.0;
+    size_t      i;
+
+    for(i = 0; i < m; ++i)
+        sum += e->f(x[i], e->data);
+    e->sum += sum;
+}
+
+double rtnorm_expect(gsl_rng * gen, double a, double b, double mu,
+                     double sigma, size_t n, RtnormFn * f, void *data) {
+    Expect      e = { f, data, 0.0 };
+
+    if(n == 0)
+        return NAN;
+    rtnorm_reduce(gen, a, b, mu, sigma, n, fold_expect, &e);
+    return e.sum / n;
+}
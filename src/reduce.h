@@ -0,0 +1,61 @@
+//  Reductions over truncated Gaussian samples, computed without
+//  storing the samples.
+//
+//  Each function draws its values in small blocks that stay in the L1
+//  cache and folds each block into the result before drawing the
+//  next, so the cost does not depend on memory bandwidth. Values are
+//  drawn in the same order as by rtnorm_fill, so given the same
+//  generator state a reduction sees exactly the values rtnorm_fill
+//  would have stored.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __REDUCE_H
+#define __REDUCE_H
+
+#include <stddef.h>
+#include <gsl/gsl_rng.h>
+
+// Values per block
+#define RTNORM_REDUCE_BLOCK 256
+
+// Function that folds the m values in x into state.
+typedef void RtnormFold(const double *x, size_t m, void *state);
+
+// Function of one value, for rtnorm_expect.
+typedef double RtnormFn(double x, void *data);
+
+// Count, mean, and sum of squared deviations from the mean.
+typedef struct RtnormMoments {
+    double      n, mean, m2;
+} RtnormMoments;
+
+// Draw n values, passing them to fold a block at a time.
+void rtnorm_reduce(gsl_rng *gen, double a, double b, double mu,
+                   double sigma, size_t n, RtnormFold *fold, void *state);
+
+// Add the sum of n values to *sum and the sum of their squares to
+// *sumsq.
+void rtnorm_sums(gsl_rng *gen, double a, double b, double mu,
+                 double sigma, size_t n, double *sum, double *sumsq);
+
+// Add n values to the moments in *m. Initialize *m to zeros before
+// the first call. Mean and variance are m->mean and m->m2/m->n.
+void rtnorm_moments(gsl_rng *gen, double a, double b, double mu,
+                    double sigma, size_t n, RtnormMoments *m);
+
+// Combine moments from separate samples (e.g. separate threads).
+void rtnorm_moments_merge(RtnormMoments *into, const RtnormMoments *from);
+
+// Count n values in nbins equal bins spanning [lo, hi). Values
+// outside that range are not counted. Counts are added to count[].
+void rtnorm_hist(gsl_rng *gen, double a, double b, double mu,
+                 double sigma, size_t n, double lo, double hi,
+                 int nbins, unsigned long *count);
+
+// Monte Carlo estimate of E[f(X)] from n values. NaN if n is 0.
+double rtnorm_expect(gsl_rng *gen, double a, double b, double mu,
+                     double sigma, size_t n, RtnormFn *f, void *data);
+
+#endif //__REDUCE_H
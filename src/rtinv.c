@@ -0,0 +1,187 @@
+//  Samplers that draw truncated Gaussians by inverting the CDF. See
+//  rtinv.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm_impl.h"
+#include "rtinv.h"
+
+static double extreme(gsl_rng *gen, double n, double a, double b,
+                      double mu, double sigma, int max);
+static void stratify(gsl_rng *gen, double a, double b, double mu,
+                     double sigma, size_t n, const size_t *perm,
+                     size_t stride, double *out);
+
+// The largest of n draws if max, else the smallest. With t =
+// -log(U)/n, U^(1/n) = exp(-t) and its complement is -expm1(-t), each
+// to full precision: the complement is what matters for the maximum,
+// which lies near the upper tail of F when n is large.
+static double extreme(gsl_rng * gen, double n, double a, double b,
+                      double mu, double sigma, int max) {
+    RtnormInverse q;
+    double      t, r;
+
+    if(!(n > 0.0)) {
+        fprintf(stderr, "%s:%d: need n > 0, got %g\n", __FILE__, __LINE__,
+                n);
+        exit(1);
+    }
+
+    // Scaling
+    if(mu != 0 || sigma != 1) {
+        a = (a - mu) / sigma;
+        b = (b - mu) / sigma;
+    }
+
+    rtnorm_inverse_init(&q, a, b);
+    t = -log(gsl_rng_uniform_pos(gen)) / n;
+    if(max)
+        r = rtnorm_inverse(&q, exp(-t), -expm1(-t));
+    else
+        r = rtnorm_inverse(&q, -expm1(-t), exp(-t));
+
+    // Scaling
+    if(mu != 0 || sigma != 1)
+        r = r * sigma + mu;
+
+    return r;
+}
+
+double rtnorm_max(gsl_rng * gen, double n, double a, double b, double mu,
+                  double sigma) {
+    return extreme(gen, n, a, b, mu, sigma, 1);
+}
+
+double rtnorm_min(gsl_rng * gen, double n, double a, double b, double mu,
+                  double sigma) {
+    return extreme(gen, n, a, b, mu, sigma, 0);
+}
+
+void rtnorm_max_rows(gsl_rng * gen, size_t m, const double *n,
+                     const double *a, const double *b, const double *mu,
+                     const double *sigma, double *out) {
+    size_t      i;
+
+    for(i = 0; i < m; ++i)
+        out[i] = extreme(gen, n[i], a[i], b[i], mu ? mu[i] : 0.0,
+                         sigma ? sigma[i] : 1.0, 1);
+}
+
+void rtnorm_min_rows(gsl_rng * gen, size_t m, const double *n,
+                     const double *a, const double *b, const double *mu,
+                     const double *sigma, double *out) {
+    size_t      i;
+
+    for(i = 0; i < m; ++i)
+        out[i] = extreme(gen, n[i], a[i], b[i], mu ? mu[i] : 0.0,
+                         sigma ? sigma[i] : 1.0, 0);
+}
+
+// Draw one value from each of n strata of the interval, and store the
+// one from stratum perm[i], or i if perm is NULL, in out[i*stride].
+// Quantile (k+w)/n is passed with its complement ((n-1-k) + (1-w))/n,
+// formed without cancellation, so the top strata keep their precision
+// in the upper tail. w is never 0 or 1, which would put a value on an
+// infinite bound.
+static void stratify(gsl_rng * gen, double a, double b, double mu,
+                     double sigma, size_t n, const size_t *perm,
+                     size_t stride, double *out) {
+    RtnormInverse q;
+    double      w, r, h = 1.0 / n;
+    size_t      i, k;
+
+    // Scaling
+    if(mu != 0 || sigma != 1) {
+        a = (a - mu) / sigma;
+        b = (b - mu) / sigma;
+    }
+
+    rtnorm_inverse_init(&q, a, b);
+    for(i = 0; i < n; ++i) {
+        k = perm ? perm[i] : i;
+        w = gsl_rng_uniform_pos(gen);
+        r = rtnorm_inverse(&q, (k + w) * h, ((n - 1 - k) + (1.0 - w)) * h);
+
+        // Scaling
+        if(mu != 0 || sigma != 1)
+            r = r * sigma + mu;
+        out[i * stride] = r;
+    }
+}
+
+void rtnorm_fill_stratified(gsl_rng * gen, double a, double b, double mu,
+                            double sigma, size_t n, double *out) {
+    stratify(gen, a, b, mu, sigma, n, NULL, 1, out);
+}
+
+// Each column gets a fresh Fisher-Yates shuffle of 0..n-1.
+void rtnorm_fill_lhs(gsl_rng * gen, size_t n, size_t d, const double *a,
+                     const double *b, const double *mu,
+                     const double *sigma, double *out) {
+    size_t     *perm, i, j, k, tmp;
+
+    if(n == 0 || d == 0)
+        return;
+    perm = malloc(n * sizeof(perm[0]));
+    if(perm == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    for(i = 0; i < n; ++i)
+        perm[i] = i;
+    for(j = 0; j < d; ++j) {
+        for(i = n - 1; i > 0; --i) {
+            k = gsl_rng_uniform(gen) * (i + 1);
+            tmp = perm[i];
+            perm[i] = perm[k];
+            perm[k] = tmp;
+        }
+        stratify(gen, a[j], b[j], mu ? mu[j] : 0.0,
+                 sigma ? sigma[j] : 1.0, n, perm, d, out + j);
+    }
+    free(perm);
+}
+
+// gsl_rng_uniform_pos returns multiples of 2^-32 or 2^-53 strictly
+// between 0 and 1, whose complements are exact, so the quantiles of a
+// pair are exactly complementary, and neither is an infinite bound.
+void rtnorm_fill_antithetic(gsl_rng * gen, double a, double b, double mu,
+                            double sigma, size_t n, double *out) {
+    RtnormInverse q;
+    double      u, r, s;
+    size_t      i;
+    int         mirror, scale = mu != 0 || sigma != 1;
+
+    // Scaling
+    if(scale) {
+        a = (a - mu) / sigma;
+        b = (b - mu) / sigma;
+    }
+
+    rtnorm_inverse_init(&q, a, b);
+    mirror = a == -b;
+    for(i = 0; i + 1 < n; i += 2) {
+        u = gsl_rng_uniform_pos(gen);
+        r = rtnorm_inverse(&q, u, 1.0 - u);
+        s = mirror ? -r : rtnorm_inverse(&q, 1.0 - u, u);
+
+        // Scaling
+        if(scale) {
+            r = r * sigma + mu;
+            s = s * sigma + mu;
+        }
+        out[i] = r;
+        out[i + 1] = s;
+    }
+    if(i < n) {
+        u = gsl_rng_uniform_pos(gen);
+        r = rtnorm_inverse(&q, u, 1.0 - u);
+        out[i] = scale ? r * sigma + mu : r;
+    }
+}
@@ -0,0 +1,88 @@
+//  Samplers that draw truncated Gaussians by inverting the CDF.
+//
+//  rtnorm rejects: the number of uniforms behind each value is random,
+//  so the uniforms cannot be chosen with structure. These samplers use
+//  one uniform per value and map it through the inverse CDF of the
+//  interval, computed in the tail where the interval lies, and in logs
+//  beyond about 37 standard deviations, so they are accurate in every
+//  regime rtnorm handles. Each costs an inverse Gaussian CDF or two
+//  evaluations of log erfc per value: slower than rtnorm for plain
+//  draws, but the uniform can be replaced by one the caller wants.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __RTINV_H
+#define __RTINV_H
+
+#include <stddef.h>
+#include <gsl/gsl_rng.h>
+
+// The largest of n independent draws from the Gaussian with mean mu
+// and standard deviation sigma, truncated to [a,b], drawn directly in
+// O(1): its CDF is F^n, where F is that of one draw, so it is
+// F^-1(U^(1/n)). U^(1/n) and its complement are computed from
+// log(U)/n, which keeps their precision however large n is; but once
+// the extreme lies within a few units in the last place of a finite
+// bound, it can take only the few doubles there. Requires n > 0,
+// which need not be an integer.
+double      rtnorm_max(gsl_rng *gen, double n, double a, double b,
+                       double mu, double sigma);
+
+// The smallest of n such draws: F^-1(1 - U^(1/n)).
+double      rtnorm_min(gsl_rng *gen, double n, double a, double b,
+                       double mu, double sigma);
+
+// Heterogeneous versions: out[i] is the largest, or smallest, of n[i]
+// draws with bounds a[i] and b[i], mean mu[i] and standard deviation
+// sigma[i]. mu and sigma may be NULL, meaning 0 and 1.
+void        rtnorm_max_rows(gsl_rng *gen, size_t m, const double *n,
+                            const double *a, const double *b,
+                            const double *mu, const double *sigma,
+                            double *out);
+void        rtnorm_min_rows(gsl_rng *gen, size_t m, const double *n,
+                            const double *a, const double *b,
+                            const double *mu, const double *sigma,
+                            double *out);
+
+// Stratified sampling: fill out[0..n-1] with one draw from each of n
+// strata of equal probability under the Gaussian with mean mu and
+// standard deviation sigma, truncated to [a,b]. out[i] lies in stratum
+// i, between the quantiles i/n and (i+1)/n, at a position drawn
+// uniformly in probability, so the output is ascending; shuffle it if
+// order matters. Every value has the distribution of rtnorm, and the
+// mean of a smooth function of them has far less variance than over
+// independent draws. Uses n uniforms.
+void        rtnorm_fill_stratified(gsl_rng *gen, double a, double b,
+                                   double mu, double sigma, size_t n,
+                                   double *out);
+
+// Latin hypercube sample of n points in d dimensions: out[i*d + j]
+// is coordinate j of point i, and coordinate j has bounds a[j] and
+// b[j], mean mu[j] and standard deviation sigma[j]; mu and sigma may
+// be NULL, meaning 0 and 1. Each coordinate is stratified as by
+// rtnorm_fill_stratified, and its strata are assigned to points by
+// an independent random permutation, so that the points cover every
+// stratum of every margin once. Uses 2n-1 uniforms per coordinate,
+// and a scratch array of n indices.
+void        rtnorm_fill_lhs(gsl_rng *gen, size_t n, size_t d,
+                            const double *a, const double *b,
+                            const double *mu, const double *sigma,
+                            double *out);
+
+// Antithetic pairs: fill out[0..n-1] with pairs F^-1(U), F^-1(1-U),
+// one uniform U per pair, where F is the CDF of the Gaussian with mean
+// mu and standard deviation sigma, truncated to [a,b]: out[2i+1] is
+// the partner of out[2i], and if n is odd, the last value has none.
+// Each value has the distribution of rtnorm, and the two in a pair
+// are negatively correlated, so the mean of a monotone function over
+// pairs has less variance than over independent draws. The tail
+// computations of the interval are shared by both members of a pair;
+// if the interval is symmetric about mu, the partner is the mirror
+// image of the first value, and the inverse CDF is evaluated once.
+// Uses (n+1)/2 uniforms.
+void        rtnorm_fill_antithetic(gsl_rng *gen, double a, double b,
+                                   double mu, double sigma, size_t n,
+                                   double *out);
+
+#endif //__RTINV_H
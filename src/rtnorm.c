@@ -30,16 +30,335 @@
 //  OS: Unix based system
 
 #include <math.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <gsl/gsl_cdf.h>
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_randist.h>
 #include <gsl/gsl_sf_erf.h>
 
 #include "rtnorm.h"
 #include "rtnorm_data.h"
+#include "rtnorm_config.h"
+#include "rtnorm_impl.h"
 
-int         N = 4001;           // Index of the right tail
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+int         N = RTNORM_N;       // Index of the right tail
+
+// Values drawn between streaming stores in rtnorm_fill: small enough
+// to stay in L1.
+#define STREAM_BLOCK 512
+
+// Fills of at least this many bytes bypass the cache; see
+// rtnorm_set_stream_bytes.
+static size_t stream_bytes = (size_t) 64 << 20;
+
+// Design variables
+static const double xmax = RTNORM_XMAX;     // Right bound
+static const double ALPHA = 1.837877066409345;  // = log(2*pi)
+
+// Revision of the sampling algorithm, raised whenever the same tables,
+// thresholds and random numbers would yield different values. Part of
+// rtnorm_table_version, so that samples stored by an older revision
+// are reported as not reproducible rather than as mismatches.
+//  1: kb is the box holding b, not the box holding the left end of
+//     b's grid cell, which had cut off the top of many narrow
+//     intervals.
+//  2: a proposal in the right tail that the exponential envelope
+//     rejects is redrawn within the tail, rather than sending the
+//     sampler back to choose a box, which had given every interval
+//     with b > xmax about 7% too little mass beyond xmax.
+//  3: rtnorm_inverse takes the mass of intervals that straddle 0
+//     from erf, and inverts narrow intervals by Newton's method from
+//     a + u*(b-a), where P(a) + u*m had rounded most quantiles of
+//     intervals narrower than about 1e-12 to a few values.
+#define RTNORM_REVISION 3
+
+// Sums of rtnorm_table_miss for rtnorm_table, made on first use by
+// rtnorm_cost
+static double miss[2 * (RTNORM_N + 1)];
+static pthread_once_t miss_once = PTHREAD_ONCE_INIT;
+
+// Squeezes of the boxes of rtnorm_table, made by the first plan that
+// uses them, and the copy the samplers read
+static RtnormSqueeze squeeze[RTNORM_N];
+static pthread_once_t squeeze_once = PTHREAD_ONCE_INIT;
+static const RtnormSqueeze *live_squeeze = squeeze;
+
+// Below this log upper tail probability, which is about that of 37
+// standard deviations, rtnorm_inverse works in logs, because tail
+// probabilities approach the smallest doubles.
+#define LOG_TINY (-690.0)
+
+// rtnorm_inverse treats [a,b] as narrow if (b-a)*(|a|+(b-a)+1) is at
+// most this, after flipping: the density changes little across it,
+// and its mass is found by a series rather than as a difference of
+// tail probabilities.
+#define NARROW 0.125
+
+// Size of a huge page, and what rtnorm_table_hugepage managed
+#define HUGEPAGE ((size_t) 2 << 20)
+static int  pages = -1;
+static pthread_once_t pages_once = PTHREAD_ONCE_INIT;
+
+static double table_yl(const RtnormTable * t, int k);
+static double phi(double z);
+static double exp_accept(double a, double b, double lp);
+static int  below_pdf(int k, double sim, double simy);
+static void init_miss(void);
+static void init_squeeze(void);
+static void init_pages(void);
+static void draw_scaled(const RtnormPlan * p, gsl_rng * gen, double mu,
+                        double sigma, size_t n, double *out);
+static void fill_plan(gsl_rng * gen, double a, double b, double mu,
+                      double sigma, size_t n, double *out, int stream);
+static void fill_stream(const RtnormPlan * p, gsl_rng * gen, double mu,
+                        double sigma, size_t n, double *out);
+static double narrow_mass(double a, double t);
+static double inverse_at(const RtnormInverse * q, double u, double v);
+static double tail_quantile(double lq);
+
+// The tables and their design constants, for the other samplers in
+// this directory. rtnorm_table_hugepage moves x, yu and ncell.
+RtnormTable rtnorm_table = {
+    .N = RTNORM_N,
+    .kmode = RTNORM_KMODE,
+    .kmin = RTNORM_CFG_KMIN,
+    .I0 = RTNORM_I0,
+    .nncell = RTNORM_NCELL,
+    .xmin = RTNORM_XMIN,
+    .xmax = RTNORM_XMAX,
+    .xgauss = RTNORM_CFG_XMIN > RTNORM_XMIN ? RTNORM_CFG_XMIN : RTNORM_XMIN,
+    .xexp = RTNORM_CFG_XMAX < RTNORM_XMAX ? RTNORM_CFG_XMAX : RTNORM_XMAX,
+    .INVH = RTNORM_INVH,
+    .yl0 = RTNORM_YL0,
+    .ylN = RTNORM_YLN,
+    .x = x,
+    .yu = yu,
+    .ncell = ncell
+};
+
+// Called by rtnorm_plan_note, if not NULL. See record.h.
+void        (*rtnorm_plan_hook) (double a, double b, size_t n) = NULL;
+
+// If not NULL, rtnorm_plan_init gets plans here. See rtnorm_cache.h.
+void        (*rtnorm_plan_cache) (RtnormPlan * p, double a, double b) = NULL;
+
+// Set up plan for sampling the standardized interval [a,b].
+void rtnorm_plan_init(RtnormPlan * p, double a, double b) {
+    void        (*cache) (RtnormPlan *, double, double) =
+        __atomic_load_n(&rtnorm_plan_cache, __ATOMIC_ACQUIRE);
+
+    if(cache)
+        cache(p, a, b);
+    else
+        rtnorm_plan_init_table(p, &rtnorm_table, a, b);
+}
+
+// Report n draws with plan p to the hook, if there is one.
+void rtnorm_plan_note(const RtnormPlan * p, size_t n) {
+    void        (*hook) (double, double, size_t) =
+        __atomic_load_n(&rtnorm_plan_hook, __ATOMIC_RELAXED);
+
+    if(hook)
+        hook(p->a, p->b, n);
+}
+
+// Set up plan p as if table t were the one in use.
+void rtnorm_plan_init_table(RtnormPlan * p, const RtnormTable * t,
+                            double a, double b) {
+    int         i;
+
+    // Check if a < b
+    if(a >= b) {
+        fprintf(stderr, "%s:%d: *** B must be greater than A ! ***\n",
+                __FILE__, __LINE__);
+        exit(1);
+    }
+
+    // Check if |a| < |b|
+    p->flip = fabs(a) > fabs(b);
+    if(p->flip) {
+        double      tmp = a;
+        a = -b;
+        b = -tmp;
+    }
+    p->a = a;
+    p->b = b;
+
+    // If a in the right tail (a > xexp <= xmax), use rejection
+    // algorithm with a truncated exponential proposal
+    if(a > t->xexp)
+        p->regime = RTNORM_EXPONENTIAL;
+
+    // If a in the left tail (a < xgauss >= xmin), use rejection
+    // algorithm with a Gaussian proposal
+    else if(a < t->xgauss)
+        p->regime = RTNORM_GAUSSIAN;
+
+    // In other cases (xgauss <= a <= xexp), use Chopin's algorithm
+    else {
+        // Compute ka
+        i = t->I0 + floor(a * t->INVH);
+        p->ka = t->ncell[i];
+
+        // Compute kb. ncell gives the box holding the left end of b's
+        // grid cell, and b itself may lie in the next box.
+        (b >= t->xmax) ?
+            p->kb = t->N : (i = t->I0 + floor(b * t->INVH),
+                            p->kb = t->ncell[i]);
+        if(p->kb < t->N && t->x[p->kb + 1] < b)
+            p->kb += 1;
+
+        // If |b-a| is small, use rejection algorithm with a truncated
+        // exponential proposal. Its rate is a, so not if a is 0.
+        p->regime = (abs(p->kb - p->ka) < t->kmin && a != 0.0) ?
+            RTNORM_EXPONENTIAL : RTNORM_CHOPIN;
+    }
+
+    if(p->regime == RTNORM_EXPONENTIAL) {
+        p->twoasq = 2 * a * a;
+        p->expab = expm1(-a * (b - a));
+    } else if(p->regime == RTNORM_CHOPIN)
+        pthread_once(&squeeze_once, init_squeeze);
+}
+
+void rtnorm_plan_prepare(void) {
+    pthread_once(&squeeze_once, init_squeeze);
+}
+
+// Is simy below the density at sim, which lies in box k? The squeeze
+// of the box decides all but a sliver of points, and a log the rest.
+static inline int below_pdf(int k, double sim, double simy) {
+    const RtnormSqueeze *q = live_squeeze + k;
+    double      s = sim - rtnorm_table.x[k];
+    double      f = q->c0 + s * (q->c1 + s * q->c2);
+
+    if(simy < f - q->eps)
+        return true;
+    if(simy > f + q->eps)
+        return false;
+    return (sim * sim + 2 * log(simy) + ALPHA) < 0;
+}
+
+// One iteration of Chopin's algorithm in box k; see rtnorm_impl.h.
+// Between them, the draw of k and u by the caller and this function
+// consume random numbers in exactly the same order as one pass
+// through the loop of the original recursive rtnorm.
+int rtnorm_plan_step(const RtnormPlan * p, gsl_rng * gen, int k, double u,
+                     double *r) {
+    const double a = p->a, b = p->b;
+    const int   ka = p->ka, kb = p->kb;
+    const double *tx = rtnorm_table.x, *tyu = rtnorm_table.yu;
+    double      z, e, ylk, simy, lbound, d, sim;
+
+    if(k == N) {
+        // Right tail. The box was chosen with the weight of its area,
+        // Q(xmax), so draw from the whole tail beyond xmax: repeat the
+        // exponential proposal until it is accepted, and only then
+        // check b. Returning to the choice of box after a rejected
+        // proposal would weight the tail by its acceptance rate,
+        // xmax*Q(xmax)/phi(xmax), or about 0.93.
+        lbound = tx[N];
+        z = -log(u);
+        e = -log(gsl_rng_uniform(gen));
+        z = z / lbound;
+        while(z*z > 2 * e) {
+            z = -log(gsl_rng_uniform(gen)) / lbound;
+            e = -log(gsl_rng_uniform(gen));
+        }
+
+        if(z < b - lbound) {
+            // Accept this proposition, otherwise reject
+            *r = lbound + z;
+            return true;
+        }
+    }
+
+    else if((k <= ka + 1) || (k >= kb - 1 && b < xmax)) {
+
+        // Two leftmost and rightmost regions
+        sim = tx[k] + (tx[k + 1] - tx[k]) * u;
+
+        if((sim >= a) && (sim <= b)) {
+            // Accept this proposition, otherwise reject
+            simy = tyu[k] * gsl_rng_uniform(gen);
+            if((simy < yl(k)) || below_pdf(k, sim, simy)) {
+                *r = sim;
+                return true;
+            }
+        }
+    }
+
+    else                        // All the other boxes
+    {
+        simy = tyu[k] * u;
+        d = tx[k + 1] - tx[k];
+        ylk = yl(k);
+        if(simy < ylk)          // That's what happens most of the time 
+        {
+            *r = tx[k] + u * d * tyu[k] / ylk;
+            return true;
+        } else {
+            sim = tx[k] + d * gsl_rng_uniform(gen);
+
+            // Otherwise, check you're below the pdf curve
+            if(below_pdf(k, sim, simy)) {
+                *r = sim;
+                return true;
+            }
+        }
+
+    }
+    return false;
+}
+
+// Draw a standardized value using plan p. Consumes random numbers in
+// exactly the same order as the original recursive rtnorm.
+double rtnorm_plan_draw(const RtnormPlan * p, gsl_rng * gen) {
+    const double a = p->a, b = p->b;
+    const int   ka = p->ka, kb = p->kb;
+    int         stop = false;
+
+    double      r = 0.0, z, e, u;
+    int         k;
+
+    switch (p->regime) {
+    case RTNORM_EXPONENTIAL:
+        do {
+            z = log(1 + gsl_rng_uniform(gen) * p->expab);
+            e = -log(gsl_rng_uniform(gen));
+        } while(p->twoasq * e <= z * z);
+        r = a - z / a;
+        break;
+
+    case RTNORM_GAUSSIAN:
+        while(!stop) {
+            r = gsl_ran_gaussian_ziggurat(gen, 1);
+            stop = (r >= a) && (r <= b);
+        }
+        break;
+
+    case RTNORM_CHOPIN:
+        while(!stop) {
+            // Sample integer between ka and kb
+            k = floor(gsl_rng_uniform(gen) * (kb - ka + 1)) + ka;
+            u = gsl_rng_uniform(gen);
+            stop = rtnorm_plan_step(p, gen, k, u, &r);
+        }
+        break;
+    }
+
+    return p->flip ? -r : r;
+}
 
 //------------------------------------------------------------
 // Pseudorandom numbers from a truncated Gaussian distribution
@@ -48,18 +367,45 @@ int         N = 4001;           // Index of the right tail
 // Returns the random variable x and its probability p(x).
 double rtnorm(gsl_rng * gen,
             double a, double b, const double mu, const double sigma) {
-    // Design variables
-    double      xmin = -2.00443204036;  // Left bound
-    double      xmax = 3.48672170399;   // Right bound
-    int         kmin = 5;       // if kb-ka < kmin then use a rejection algorithm
-    double      INVH = 1631.73284006;   // = 1/h, h being the minimal interval range
-    int         I0 = 3271;      // = - floor(x(0)/h)
-    double      ALPHA = 1.837877066409345;  // = log(2*pi)
-    int         xsize = sizeof(x) / sizeof(double); // Length of table x
-    int         stop = false;
+    RtnormPlan  plan;
+    double      r;
 
-    double      r, z, e, ylk, simy, lbound, u, d, sim;
-    int         i, ka, kb, k;
+    // Scaling
+    if(mu != 0 || sigma != 1) {
+        a = (a - mu) / sigma;
+        b = (b - mu) / sigma;
+    }
+
+    rtnorm_plan_init(&plan, a, b);
+    rtnorm_plan_note(&plan, 1);
+    r = rtnorm_plan_draw(&plan, gen);
+
+    // Scaling
+    if(mu != 0 || sigma != 1)
+        r = r * sigma + mu;
+
+    return r;
+}
+
+// Fill out[0..n-1] with n draws from the truncated Gaussian.  The
+// interval is standardized and checked once, rather than once per
+// draw, but the random numbers are consumed exactly as n calls to
+// rtnorm would consume them, so the output is identical.
+void rtnorm_fill(gsl_rng * gen, double a, double b, const double mu,
+                 const double sigma, size_t n, double *out) {
+    fill_plan(gen, a, b, mu, sigma, n, out,
+              n >= rtnorm_stream_threshold() / sizeof(double));
+}
+
+void rtnorm_fill_cached(gsl_rng * gen, double a, double b, double mu,
+                        double sigma, size_t n, double *out) {
+    fill_plan(gen, a, b, mu, sigma, n, out, 0);
+}
+
+// rtnorm_fill, writing with non-temporal stores if stream is nonzero
+static void fill_plan(gsl_rng * gen, double a, double b, double mu,
+                      double sigma, size_t n, double *out, int stream) {
+    RtnormPlan  plan;
 
     // Scaling
     if(mu != 0 || sigma != 1) {
@@ -67,130 +413,380 @@ double rtnorm(gsl_rng * gen,
         b = (b - mu) / sigma;
     }
 
+    rtnorm_plan_init(&plan, a, b);
+    rtnorm_plan_note(&plan, n);
+
+    if(stream)
+        fill_stream(&plan, gen, mu, sigma, n, out);
+    else
+        draw_scaled(&plan, gen, mu, sigma, n, out);
+}
+
+size_t rtnorm_set_stream_bytes(size_t bytes) {
+    return __atomic_exchange_n(&stream_bytes, bytes, __ATOMIC_RELAXED);
+}
+
+size_t rtnorm_stream_threshold(void) {
+    return __atomic_load_n(&stream_bytes, __ATOMIC_RELAXED);
+}
+
+void rtnorm_stream_copy(void *dst, const void *src, size_t bytes) {
+#ifdef __SSE2__
+    char       *d = dst;
+    const char *s = src;
+    size_t      head = (16 - ((uintptr_t) d & 15)) & 15;
+
+    // Streaming stores need 16-byte alignment.
+    head = head < bytes ? head : bytes;
+    memcpy(d, s, head);
+    d += head;
+    s += head;
+    bytes -= head;
+    for(; bytes >= 16; bytes -= 16, d += 16, s += 16)
+        _mm_stream_si128((__m128i *) d,
+                         _mm_loadu_si128((const __m128i *) s));
+    memcpy(d, s, bytes);
+
+    // Make the streamed bytes visible to other threads in order with
+    // later stores.
+    _mm_sfence();
+#else
+    memcpy(dst, src, bytes);
+#endif
+}
+
+// Fill out[0..n-1] with draws using plan p, scaled by sigma and mu.
+static void draw_scaled(const RtnormPlan * p, gsl_rng * gen, double mu,
+                        double sigma, size_t n, double *out) {
+    size_t      i;
+
+    if(mu != 0 || sigma != 1) {
+        for(i = 0; i < n; ++i)
+            out[i] = rtnorm_plan_draw(p, gen) * sigma + mu;
+    } else {
+        for(i = 0; i < n; ++i)
+            out[i] = rtnorm_plan_draw(p, gen);
+    }
+}
+
+// As draw_scaled, but draw each block into a buffer in L1 and copy it
+// out with rtnorm_stream_copy, which writes around the cache rather
+// than evict the tables. Output is the same.
+static void fill_stream(const RtnormPlan * p, gsl_rng * gen, double mu,
+                        double sigma, size_t n, double *out) {
+    double      buf[STREAM_BLOCK];
+    size_t      i, m;
+
+    for(i = 0; i < n; i += m) {
+        m = n - i < STREAM_BLOCK ? n - i : STREAM_BLOCK;
+        draw_scaled(p, gen, mu, sigma, m, buf);
+        rtnorm_stream_copy(out + i, buf, m * sizeof(double));
+    }
+}
+
+// Partial sums of n+1 standard exponentials, divided by their total,
+// are distributed as the order statistics of n uniforms (Devroye,
+// Non-Uniform Random Variate Generation, section V.2). Each sorted
+// uniform u = c/s, where c is the running sum and s the total, is
+// passed to the inverse CDF of the interval with v = 1-u computed as
+// (s-c)/s. The subtraction carries an error of about an ulp of s, so
+// v has an absolute error near 1e-16, like u, and the last few
+// values lose relative precision as v approaches it. The inverse is
+// monotone, so the output comes out sorted in one pass. Clamping to
+// the previous value absorbs the last-bit wobble of the inverse where
+// it switches from P to Q.
+void rtnorm_fill_sorted(gsl_rng * gen, double a, double b, const double mu,
+                        const double sigma, size_t n, double *out) {
+    RtnormInverse q;
+    double      s, c, w, r, lo;
+    size_t      i;
+
+    // Scaling
+    if(mu != 0 || sigma != 1) {
+        a = (a - mu) / sigma;
+        b = (b - mu) / sigma;
+    }
+
+    rtnorm_inverse_init(&q, a, b);
+    if(n == 0)
+        return;
+
+    for(s = 0.0, i = 0; i < n; ++i) {
+        s -= log(gsl_rng_uniform_pos(gen));
+        out[i] = s;
+    }
+    s -= log(gsl_rng_uniform_pos(gen));
+    w = 1.0 / s;
+
+    lo = a;
+    for(i = 0; i < n; ++i) {
+        c = out[i];
+        r = rtnorm_inverse(&q, c * w, (s - c) * w);
+        r = r < lo ? lo : r;
+        lo = r;
+        out[i] = r;
+    }
+
+    // Scaling
+    if(mu != 0 || sigma != 1) {
+        for(i = 0; i < n; ++i)
+            out[i] = out[i] * sigma + mu;
+    }
+}
+
+// Intervals left of zero are mirrored, so that the tail probabilities
+// used are those of the upper tail, which keep their precision far
+// from the mode. Deep intervals need only log Q.
+void rtnorm_inverse_init(RtnormInverse * q, double a, double b) {
     // Check if a < b
     if(a >= b) {
         fprintf(stderr, "%s:%d: *** B must be greater than A ! ***\n",
                 __FILE__, __LINE__);
         exit(1);
     }
+    q->a = a;
+    q->b = b;
+    q->flip = b <= 0.0;
+    if(q->flip) {
+        double      tmp = a;
+        a = -b;
+        b = -tmp;
+    }
+    q->w = b - a;
+    q->narrow = q->w * (fabs(a) + q->w + 1.0) <= NARROW;
+    if(q->narrow) {
+        q->m = narrow_mass(a, q->w);
+        return;
+    }
+    q->lqa = rtnorm_log_upper(a);
+    q->deep = q->lqa < LOG_TINY;
+    if(q->deep) {
+        q->r = exp(rtnorm_log_upper(b) - q->lqa);
+        return;
+    }
+    q->pa = gsl_cdf_ugaussian_P(a);
+    q->qb = gsl_cdf_ugaussian_Q(b);
+    if(a >= 0.0)
+        q->m = gsl_cdf_ugaussian_Q(a) - q->qb;
+    else
+        q->m = 0.5 * (gsl_sf_erf(b * M_SQRT1_2) - gsl_sf_erf(a * M_SQRT1_2));
+}
 
-    // Check if |a| < |b|
-    else if(fabs(a) > fabs(b))
-        r = -rtnorm(gen, -b, -a, 0.0, 1.0);
+double rtnorm_inverse(const RtnormInverse * q, double u, double v) {
+    double      r = q->flip ? -inverse_at(q, v, u) : inverse_at(q, u, v);
 
-    // If a in the right tail (a > xmax), use rejection algorithm with
-    // a truncated exponential proposal   
-    else if(a > xmax)
-        r = rtexp(gen, a, b);
+    r = r < q->a ? q->a : r;
+    return r > q->b ? q->b : r;
+}
 
-    // If a in the left tail (a < xmin), use rejection algorithm with
-    // a Gaussian proposal 
-    else if(a < xmin) {
-        while(!stop) {
-            r = gsl_ran_gaussian_ziggurat(gen, 1);
-            stop = (r >= a) && (r <= b);
+// Mass of [a,a+t], divided by phi(a), for t*(|a|+t+1) at most
+// NARROW: the sum over n of (-1)^n He_n(a) t^(n+1)/(n+1)!, He_n being
+// the Hermite polynomials. He_n(0) vanishes for odd n, so the sum
+// stops after two negligible terms in a row.
+static double narrow_mass(double a, double t) {
+    double      h0 = 1.0, h1 = a, h, c = t, sum = t, last = t;
+    int         n;
+
+    for(n = 1; n < 40; ++n) {
+        c *= -t / (n + 1);
+        sum += c * h1;
+        if(fabs(c * h1) <= 1e-17 * sum && fabs(last) <= 1e-17 * sum)
+            break;
+        last = c * h1;
+        h = a * h1 - n * h0;
+        h0 = h1;
+        h1 = h;
+    }
+    return sum;
+}
+
+// Quantile u, where v = 1-u, of the interval of q after flipping.
+// In a narrow interval, take Newton steps from a + u*(b-a) on the
+// mass of [a,x] divided by phi(a), whose slope is phi(x)/phi(a).
+// Below the median of the whole Gaussian, invert P(x) = P(a) + u*m;
+// above it, Q(x) = Q(b) + v*m, which keeps the precision of small v
+// near b.
+static double inverse_at(const RtnormInverse * q, double u, double v) {
+    double      p, a = q->flip ? -q->b : q->a, t, d;
+    int         i;
+
+    if(q->narrow) {
+        t = u * q->w;
+        for(i = 0; i < 8; ++i) {
+            d = (narrow_mass(a, t) - u * q->m) / exp(-a * t - 0.5 * t * t);
+            t -= d;
+            if(fabs(d) <= 1e-17 * q->w)
+                break;
         }
+        return a + (t < 0.0 ? 0.0 : t > q->w ? q->w : t);
     }
+    if(q->deep)
+        return tail_quantile(q->lqa + log(q->r + v * (1.0 - q->r)));
+    p = q->pa + u * q->m;
+    if(p < 0.5)
+        return gsl_cdf_ugaussian_Pinv(p);
+    return gsl_cdf_ugaussian_Qinv(q->qb + v * q->m);
+}
 
-    // In other cases (xmin < a < xmax), use Chopin's algorithm
-    else {
-        // Compute ka
-        i = I0 + floor(a * INVH);
-        ka = ncell[i];
+// The z at which log Q(z) = lq, for lq < LOG_TINY, where Q(z) itself
+// may underflow. Start from Q(z) ~ phi(z)/z, then take Newton steps
+// on log Q, whose slope is -phi(z)/Q(z); two reach full precision.
+static double tail_quantile(double lq) {
+    double      z = sqrt(-2.0 * lq), l;
+    int         i;
 
-        // Compute kb
-        (b >= xmax) ?
-            kb = N : (i = I0 + floor(b * INVH), kb = ncell[i]
-            );
+    z = sqrt(-2.0 * lq - ALPHA - 2.0 * log(z));
+    for(i = 0; i < 2; ++i) {
+        l = rtnorm_log_upper(z);
+        z += (l - lq) / exp(-0.5 * (z * z + ALPHA) - l);
+    }
+    return z;
+}
 
-        // If |b-a| is small, use rejection algorithm with a truncated
-        // exponential proposal 
-        if(abs(kb - ka) < kmin) {
-            r = rtexp(gen, a, b);
-            stop = true;
-        }
+// Heterogeneous version of rtnorm_fill: out[i] is drawn from the
+// Gaussian with mean mu[i] and standard deviation sigma[i], truncated
+// to [a[i], b[i]]. If mu is NULL, all means are 0; if sigma is NULL,
+// all standard deviations are 1.
+void rtnorm_fill_rows(gsl_rng * gen, size_t n, const double *a,
+                      const double *b, const double *mu,
+                      const double *sigma, double *out) {
+    size_t      i;
 
-        while(!stop) {
-            // Sample integer between ka and kb
-            k = floor(gsl_rng_uniform(gen) * (kb - ka + 1)) + ka;
+    for(i = 0; i < n; ++i)
+        out[i] = rtnorm(gen, a[i], b[i],
+                        mu ? mu[i] : 0.0, sigma ? sigma[i] : 1.0);
+}
 
-            if(k == N) {
-                // Right tail
-                lbound = x[xsize - 1];
-                z = -log(gsl_rng_uniform(gen));
-                e = -log(gsl_rng_uniform(gen));
-                z = z / lbound;
-
-                if((z*z <= 2 * e) && (z < b - lbound)) {
-                    // Accept this proposition, otherwise reject
-                    r = lbound + z;
-                    stop = true;
-                }
-            }
+// Rows per block of rtnorm_fill_rows_sorted, buckets its rows are
+// sorted into, and rows ahead of the current one whose table lines
+// are prefetched
+#define SORT_BLOCK 1024
+#define SORT_BUCKETS 256
+#define PREFETCH 8
 
-            else if((k <= ka + 1) || (k >= kb - 1 && b < xmax)) {
+// As rtnorm_fill_rows, but each block of rows is planned, sorted by
+// the box its interval starts in with one counting pass, and drawn in
+// that order, so that consecutive draws touch neighbouring parts of
+// the tables instead of random ones. With the shipped tables, which
+// stay in L2, the extra passes cost more than they save; bsorted
+// measures both.
+void rtnorm_fill_rows_sorted(gsl_rng * gen, size_t n, const double *a,
+                             const double *b, const double *mu,
+                             const double *sigma, double *out) {
+    const RtnormTable *t = &rtnorm_table;
+    RtnormPlan *plan = malloc(SORT_BLOCK * sizeof(RtnormPlan));
+    unsigned char *key = malloc(SORT_BLOCK);
+    unsigned   *order = malloc(SORT_BLOCK * sizeof(unsigned));
+    size_t      count[SORT_BUCKETS + 1];
+    size_t      i0, i, j, m;
+    double      lo, hi, z, s, r;
 
-                // Two leftmost and rightmost regions
-                sim = x[k] + (x[k + 1] - x[k]) * gsl_rng_uniform(gen);
+    if(plan == NULL || key == NULL || order == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
 
-                if((sim >= a) && (sim <= b)) {
-                    // Accept this proposition, otherwise reject
-                    simy = yu[k] * gsl_rng_uniform(gen);
-                    if((simy < yl(k))
-                       || (sim * sim + 2 * log(simy) + ALPHA) < 0) {
-                        r = sim;
-                        stop = true;
-                    }
-                }
-            }
+    for(i0 = 0; i0 < n; i0 += m) {
+        m = n - i0 < SORT_BLOCK ? n - i0 : SORT_BLOCK;
 
-            else                // All the other boxes
-            {
-                u = gsl_rng_uniform(gen);
-                simy = yu[k] * u;
-                d = x[k + 1] - x[k];
-                ylk = yl(k);
-                if(simy < ylk)  // That's what happens most of the time 
-                {
-                    r = x[k] + u * d * yu[k] / ylk;
-                    stop = true;
-                } else {
-                    sim = x[k] + d * gsl_rng_uniform(gen);
-
-                    // Otherwise, check you're below the pdf curve
-                    if((sim * sim + 2 * log(simy) + ALPHA) < 0) {
-                        r = sim;
-                        stop = true;
-                    }
-                }
+        // Plan every row, and count the rows in each bucket. Rows that
+        // do not use the boxes go in the last bucket.
+        memset(count, 0, sizeof(count));
+        for(i = 0; i < m; ++i) {
+            lo = a[i0 + i];
+            hi = b[i0 + i];
+            s = sigma ? sigma[i0 + i] : 1.0;
+            z = mu ? mu[i0 + i] : 0.0;
 
+            // Scaling
+            if(z != 0 || s != 1) {
+                lo = (lo - z) / s;
+                hi = (hi - z) / s;
             }
+            rtnorm_plan_init(plan + i, lo, hi);
+            rtnorm_plan_note(plan + i, 1);
+            key[i] = plan[i].regime == RTNORM_CHOPIN ?
+                plan[i].ka * (SORT_BUCKETS - 1) / (t->N + 1) :
+                SORT_BUCKETS - 1;
+            ++count[key[i] + 1];
+        }
+        for(j = 1; j <= SORT_BUCKETS; ++j)
+            count[j] += count[j - 1];
+        for(i = 0; i < m; ++i)
+            order[count[key[i]]++] = i;
+
+        // Draw in bucket order, fetching the first boxes of upcoming
+        // rows, and store in row order.
+        for(j = 0; j < m; ++j) {
+            i = j + PREFETCH < m ? order[j + PREFETCH] : order[j];
+            if(plan[i].regime == RTNORM_CHOPIN) {
+                __builtin_prefetch(t->x + plan[i].ka);
+                __builtin_prefetch(t->yu + plan[i].ka);
+            }
+            i = order[j];
+            r = rtnorm_plan_draw(plan + i, gen);
+            s = sigma ? sigma[i0 + i] : 1.0;
+            z = mu ? mu[i0 + i] : 0.0;
+
+            // Scaling
+            if(z != 0 || s != 1)
+                r = r * s + z;
+            out[i0 + i] = r;
         }
     }
+    free(plan);
+    free(key);
+    free(order);
+}
 
-    // Scaling
-    if(mu != 0 || sigma != 1)
-        r = r * sigma + mu;
+// Version number of the tables and thresholds in use and of the
+// algorithm that samples them. See rtnorm_table_hash.
+unsigned long long rtnorm_table_version(void) {
+    return rtnorm_table_hash(&rtnorm_table);
+}
 
-    return r;
+// 64-bit FNV-1a hash of the boxes of t, of the thresholds that choose
+// the regime, and of RTNORM_REVISION. Stored samples record this
+// value, so that they can be traced to the code that produced them.
+unsigned long long rtnorm_table_hash(const RtnormTable * t) {
+    const int   rev = RTNORM_REVISION;
+    const unsigned char *p[7] = {
+        (const unsigned char *) t->x, (const unsigned char *) t->yu,
+        (const unsigned char *) t->ncell, (const unsigned char *) &rev,
+        (const unsigned char *) &t->kmin,
+        (const unsigned char *) &t->xgauss,
+        (const unsigned char *) &t->xexp
+    };
+    size_t      size[7] = {
+        (t->N + 1) * sizeof(t->x[0]), t->N * sizeof(t->yu[0]),
+        t->nncell * sizeof(t->ncell[0]), sizeof(rev), sizeof(t->kmin),
+        sizeof(t->xgauss), sizeof(t->xexp)
+    };
+    unsigned long long h = 0xcbf29ce484222325ULL;
+    size_t      i, j;
+
+    for(i = 0; i < 7; ++i) {
+        for(j = 0; j < size[i]; ++j) {
+            h ^= p[i][j];
+            h *= 0x100000001b3ULL;
+        }
+    }
+    return h;
 }
 
 // Compute y_l from y_k
 double yl(int k) {
-    double      yl0 = 0.053513975472;   // y_l of the leftmost rectangle
-    double      ylN = 0.000914116389555;    // y_l of the rightmost rectangle
-
     if(k == 0)
-        return yl0;
+        return RTNORM_YL0;      // y_l of the leftmost rectangle
 
     else if(k == N - 1)
-        return ylN;
+        return RTNORM_YLN;      // y_l of the rightmost rectangle
 
-    else if(k <= 1953)
-        return yu[k - 1];
+    else if(k <= RTNORM_KMODE)
+        return rtnorm_table.yu[k - 1];
 
     else
-        return yu[k + 1];
+        return rtnorm_table.yu[k + 1];
 }
 
 // Rejection algorithm with a truncated exponential proposal
@@ -205,3 +801,250 @@ double rtexp(gsl_rng * rng, double a, double b) {
     }while(twoasq*e <= z*z);
     return a - z/a;
 }
+
+// y_l of box k of table t; as yl, for any table
+static double table_yl(const RtnormTable * t, int k) {
+    if(k == 0)
+        return t->yl0;
+    else if(k == t->N - 1)
+        return t->ylN;
+    else if(k <= t->kmode)
+        return t->yu[k - 1];
+    else
+        return t->yu[k + 1];
+}
+
+double rtnorm_log_upper(double z) {
+    if(isinf(z))
+        return z > 0 ? -INFINITY : 0.0;
+    return gsl_sf_log_erfc(z * M_SQRT1_2) - M_LN2;
+}
+
+// Standard Gaussian density
+static double phi(double z) {
+    return exp(-0.5 * (z * z + ALPHA));
+}
+
+void rtnorm_table_squeeze(const RtnormTable * t, int k, RtnormSqueeze * q) {
+    // Where |phi'''(z)| = |z^3 - 3z| phi(z) may peak: z^2 = 3 -+ sqrt(6)
+    static const double crit[4] = {
+        -2.33441421833897724, -0.741963784302725857,
+        0.741963784302725857, 2.33441421833897724
+    };
+    double      x0 = t->x[k], x1 = t->x[k + 1], h = 0.5 * (x1 - x0);
+    double      f0 = phi(x0), fm = phi(x0 + h), f1 = phi(x1), m3 = 0.0, z;
+    int         i;
+
+    q->c0 = f0;
+    q->c2 = (f1 - 2 * fm + f0) / (2 * h * h);
+    q->c1 = (fm - f0) / h - q->c2 * h;
+
+    // The error of interpolating at x0, x0+h and x1 is at most
+    // max|phi'''| (2h)^3 / (72 sqrt(3)). Widen it by far more than the
+    // rounding error of either test, so that the squeeze never
+    // decides a point differently from the log.
+    for(i = -2; i < 4; ++i) {
+        z = i == -2 ? x0 : i == -1 ? x1 : crit[i];
+        if(x0 <= z && z <= x1)
+            m3 = fmax(m3, fabs(z * (z * z - 3.0)) * phi(z));
+    }
+    q->eps = m3 * 8 * h * h * h / (72 * sqrt(3.0))
+        + 1e-12 * fmax(f0, f1);
+}
+
+double rtnorm_log_mass(double a, double b) {
+    double      la;
+
+    if(a >= 0.0) {
+        la = rtnorm_log_upper(a);
+        return la + log(-expm1(rtnorm_log_upper(b) - la));
+    }
+    if(b <= 0.0)
+        return rtnorm_log_mass(-b, -a);
+    return log1p(-(exp(rtnorm_log_upper(-a))
+                   + exp(rtnorm_log_upper(b))));
+}
+
+// Acceptance rate of the exponential proposal on [a,b], whose log
+// mass is lp: the mass of [a,b] over that of the envelope
+// phi(a)*exp(-a*(x-a)). a may be negative, for narrow intervals near
+// the mode.
+static double exp_accept(double a, double b, double lp) {
+    double      lenv = -0.5 * (a * a + ALPHA);
+
+    if(a == 0.0)
+        lenv += log(b);
+    else
+        lenv += log(fabs(expm1(-a * (b - a)))) - log(fabs(a));
+    return exp(lp - lenv);
+}
+
+void rtnorm_table_miss(const RtnormTable * t, double *m) {
+    RtnormSqueeze q;
+    double     *band = m + t->N + 1, yl;
+    int         k;
+
+    m[0] = band[0] = 0.0;
+    for(k = 0; k < t->N; ++k) {
+        yl = table_yl(t, k);
+        rtnorm_table_squeeze(t, k, &q);
+        m[k + 1] = m[k] + 1.0 - yl / t->yu[k];
+        band[k + 1] = band[k] + fmin(2 * q.eps, t->yu[k] - yl) / t->yu[k];
+    }
+}
+
+// Each iteration of Chopin's algorithm draws a box and a uniform.
+// What it does next depends on the box:
+//   inner box: accept if below y_l, else a uniform and a log;
+//   edge box:  if in [a,b], a uniform, and a log if above y_l;
+//   tail:      a uniform and two logs, and the same again for each
+//              rejected exponential proposal.
+// Every box has area Q(xmax), so an iteration accepts with
+// probability P(a,b)/(nbox*Q(xmax)).
+void rtnorm_table_cost(const RtnormTable * t, const double *m, double a,
+                       double b, RtnormCost * c) {
+    RtnormPlan  p;
+    const double *band = m + t->N + 1;
+    double      lp, lA, u = 0.0, l = 0.0, g, r;
+    int         k, lo, hi, nbox;
+
+    rtnorm_plan_init_table(&p, t, a, b);
+    a = p.a;
+    b = p.b;
+    lp = rtnorm_log_mass(a, b);
+    memset(c, 0, sizeof(*c));
+    c->regime = p.regime;
+
+    switch (p.regime) {
+    case RTNORM_GAUSSIAN:
+        c->accept = exp(lp);
+        c->iters = c->normals = 1.0 / c->accept;
+        break;
+
+    case RTNORM_EXPONENTIAL:
+        c->accept = exp_accept(a, b, lp);
+        c->iters = 1.0 / c->accept;
+        c->uniforms = c->logs = 2.0 * c->iters;
+        break;
+
+    case RTNORM_CHOPIN:
+        nbox = p.kb - p.ka + 1;
+        lA = rtnorm_log_upper(t->xmax);
+        lo = p.ka + 2;
+        hi = (b < t->xmax) ? p.kb - 2 : p.kb - 1;
+        if(hi >= lo) {
+            u = m[hi + 1] - m[lo];
+            l = band[hi + 1] - band[lo];
+        }
+        for(k = p.ka; k <= p.kb; ++k) {
+            if(k == lo && hi >= lo) {
+                k = hi;
+                continue;
+            }
+            if(k == t->N) {
+                // The exponential proposal in the tail is accepted
+                // with probability xmax*Q(xmax)/phi(xmax); r more
+                // proposals are expected.
+                r = exp(-0.5 * (t->xmax * t->xmax + ALPHA) - lA)
+                    / t->xmax - 1.0;
+                u += 1.0 + 2.0 * r;
+                l += 2.0 + 2.0 * r;
+            } else {
+                g = (fmin(b, t->x[k + 1]) - fmax(a, t->x[k]))
+                    / (t->x[k + 1] - t->x[k]);
+                if(g > 0.0) {
+                    u += g;
+                    l += g * (band[k + 1] - band[k]);
+                }
+            }
+        }
+        c->accept = exp(lp - lA - log(nbox));
+        c->iters = 1.0 / c->accept;
+        c->uniforms = c->iters * (2.0 + u / nbox);
+        c->logs = c->iters * l / nbox;
+        break;
+    }
+}
+
+static void init_miss(void) {
+    rtnorm_table_miss(&rtnorm_table, miss);
+}
+
+static void init_squeeze(void) {
+    int         k;
+
+    for(k = 0; k < RTNORM_N; ++k)
+        rtnorm_table_squeeze(&rtnorm_table, k, squeeze + k);
+}
+
+// Copy x, yu, ncell and the squeezes, each on a 64-byte boundary, into
+// one huge page, and point the samplers at the copies. Ask the kernel
+// for a page from its huge page pool first, and if there is none, for
+// a transparent huge page on a 2 MB-aligned region. Readers see either
+// the old tables or the new, whose contents are the same, and the old
+// ones are static, so nothing is freed.
+static void init_pages(void) {
+    size_t      sx = (sizeof(x) + 63) & ~(size_t) 63;
+    size_t      syu = (sizeof(yu) + 63) & ~(size_t) 63;
+    size_t      sncell = (sizeof(ncell) + 63) & ~(size_t) 63;
+    char       *p = MAP_FAILED, *q;
+    int         kind = 0;
+
+    if(sx + syu + sncell + sizeof(squeeze) > HUGEPAGE)
+        return;
+    pthread_once(&squeeze_once, init_squeeze);
+#ifdef MAP_HUGETLB
+    p = mmap(NULL, HUGEPAGE, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    kind = 2;
+#endif
+    if(p == MAP_FAILED) {
+        // Map twice the size, and keep the aligned huge page within.
+        q = mmap(NULL, 2 * HUGEPAGE, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(q == MAP_FAILED)
+            return;
+        p = (char *) (((uintptr_t) q + HUGEPAGE - 1) & ~(HUGEPAGE - 1));
+        if(p > q)
+            munmap(q, p - q);
+        munmap(p + HUGEPAGE, q + HUGEPAGE - p);
+        kind = 0;
+#ifdef MADV_HUGEPAGE
+        if(madvise(p, HUGEPAGE, MADV_HUGEPAGE) == 0)
+            kind = 1;
+#endif
+    }
+
+    memcpy(p, x, sizeof(x));
+    memcpy(p + sx, yu, sizeof(yu));
+    memcpy(p + sx + syu, ncell, sizeof(ncell));
+    memcpy(p + sx + syu + sncell, squeeze, sizeof(squeeze));
+    mprotect(p, HUGEPAGE, PROT_READ);
+
+    __atomic_store_n(&rtnorm_table.x, (const double *) p, __ATOMIC_RELEASE);
+    __atomic_store_n(&rtnorm_table.yu, (const double *) (p + sx),
+                     __ATOMIC_RELEASE);
+    __atomic_store_n(&rtnorm_table.ncell, (const int *) (p + sx + syu),
+                     __ATOMIC_RELEASE);
+    __atomic_store_n(&live_squeeze,
+                     (const RtnormSqueeze *) (p + sx + syu + sncell),
+                     __ATOMIC_RELEASE);
+    pages = kind;
+}
+
+int rtnorm_table_hugepage(void) {
+    pthread_once(&pages_once, init_pages);
+    return pages;
+}
+
+RtnormCost rtnorm_cost(double a, double b, double mu, double sigma) {
+    RtnormCost  c;
+
+    pthread_once(&miss_once, init_miss);
+    if(mu != 0 || sigma != 1) {
+        a = (a - mu) / sigma;
+        b = (b - mu) / sigma;
+    }
+    rtnorm_table_cost(&rtnorm_table, miss, a, b, &c);
+    return c;
+}
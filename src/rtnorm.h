@@ -33,8 +33,23 @@
 #ifndef __RTNORM_H
 #define __RTNORM_H
 
+#include <stddef.h>
 #include <gsl/gsl_rng.h>
 
+// Algorithms used by rtnorm
+enum { RTNORM_CHOPIN, RTNORM_EXPONENTIAL, RTNORM_GAUSSIAN };
+
+// Expected work for one draw from an interval
+typedef struct RtnormCost {
+    int         regime;         // RTNORM_CHOPIN, _EXPONENTIAL or _GAUSSIAN
+    double      accept;         // probability that an iteration succeeds
+    double      iters;          // iterations of the rejection loop
+    double      uniforms;       // calls to gsl_rng_uniform
+    double      logs;           // calls to log, the only transcendental
+                                // function outside Gaussian draws
+    double      normals;        // Gaussian draws, by the ziggurat method
+} RtnormCost;
+
 // Compute y_l from y_k
 double yl(int k);
 
@@ -47,5 +62,72 @@ double rtexp(gsl_rng *gen, double a, double b);
 double rtnorm (gsl_rng *gen, double a, double b, const double mu,
                const double sigma);
 
+// Fill out[0..n-1] with draws from the same distribution. Equivalent
+// to n calls to rtnorm, but the interval is set up only once.
+void rtnorm_fill(gsl_rng *gen, double a, double b, const double mu,
+                 const double sigma, size_t n, double *out);
+
+// rtnorm_fill writes fills of at least this many bytes (default 64
+// MiB) with non-temporal stores, which bypass the cache, so that
+// output far larger than the last-level cache does not evict the
+// tables. Output is the same either way. Use 0 to stream every fill,
+// or SIZE_MAX for none. Smaller fills, and output that is read again
+// soon, are better off in the cache. The samplers built on
+// rtnorm_fill that draw in small blocks and read each block back keep
+// it in the cache, and rtnormgen applies the setting to its whole
+// output rather than to each block. Returns the previous setting.
+size_t      rtnorm_set_stream_bytes(size_t bytes);
+
+// Fill out[0..n-1] with n draws from the same distribution as
+// rtnorm_fill, in ascending order, without sorting: n sorted uniforms
+// are made from exponential spacings, in O(n), and mapped through the
+// inverse CDF. Each value costs a log and an inverse Gaussian CDF, or
+// beyond about 37 standard deviations two evaluations of log erfc,
+// against the O(log n) comparisons per value of a sort; bsortfill
+// compares the two. The values are a different sample from that of
+// rtnorm_fill, and use n+1 uniforms.
+void rtnorm_fill_sorted(gsl_rng *gen, double a, double b, const double mu,
+                        const double sigma, size_t n, double *out);
+
+// Fill out[0..n-1] with draws from truncated Gaussians whose
+// parameters differ from row to row: row i has bounds a[i] and b[i],
+// mean mu[i], and standard deviation sigma[i]. Pass NULL for mu or
+// sigma to use 0 or 1 for every row.
+void rtnorm_fill_rows(gsl_rng *gen, size_t n, const double *a,
+                      const double *b, const double *mu,
+                      const double *sigma, double *out);
+
+// Same as rtnorm_fill_rows, except that rows are drawn, though not
+// stored, in order of where their intervals lie, which keeps the
+// tables in cache when intervals vary at random from row to row. The
+// output has the same distribution but is a different sample: rows
+// starting in the same part of the tables are drawn in row order, and
+// before rows starting further right.
+void rtnorm_fill_rows_sorted(gsl_rng *gen, size_t n, const double *a,
+                             const double *b, const double *mu,
+                             const double *sigma, double *out);
+
+// Predict, without drawing, the work rtnorm does per draw from the
+// same distribution. The algorithm is the one rtnorm would choose,
+// from the same tables and thresholds, and the counts are expected
+// values per draw.
+RtnormCost rtnorm_cost(double a, double b, double mu, double sigma);
+
+// Version number of the sampling tables, of the regime thresholds in
+// rtnorm_config.h, and of the algorithm: a hash of the tables'
+// contents, the thresholds, and a revision number that is raised
+// whenever a fix changes the values drawn. Builds that draw different
+// values from the same random numbers have different versions.
+unsigned long long rtnorm_table_version(void);
+
+// Move the sampling tables to a copy in one 2 MB huge page, each
+// table aligned to a cache line, so that draws from intervals all
+// over the tables need one TLB entry rather than dozens. Values drawn
+// do not change. Returns 2 if the page came from the huge page pool
+// (MAP_HUGETLB), 1 if it was requested from transparent huge pages
+// (MADV_HUGEPAGE), which the kernel may grant later or not at all, 0
+// if the copy is on ordinary pages, and -1 if there is no copy. Later
+// calls return the same. Call it before sampling starts.
+int         rtnorm_table_hugepage(void);
 
 #endif //__RTNORM_H
@@ -0,0 +1,468 @@
+//  Header-only C++ interface to the truncated Gaussian sampler.
+//
+//  rtnorm::truncated_normal_distribution<RealType> meets the
+//  requirements of a RandomNumberDistribution, so it works with any
+//  uniform random bit generator: std::mt19937_64, pcg, and so on.
+//  Everything is a template, so the engine inlines into Chopin's loop
+//  rather than being called through gsl_rng. Random numbers are used
+//  in the same order as by rtnorm in rtnorm.c; only the way uniforms
+//  are made from the engine's output differs.
+//
+//      std::mt19937_64 eng(42);
+//      rtnorm::truncated_normal_distribution<> d(-1.0, 2.0);
+//      double x = d(eng);
+//      std::vector<double> v(1000);
+//      d.generate(v.begin(), v.end(), eng);
+//      rtnorm::reduce(d.param(), eng, n, [&](const double *x, size_t m) {
+//          for(size_t i = 0; i < m; ++i)
+//              sum += x[i];
+//      });
+//
+//  Requires C++17. Does not need GSL. The C function rtnorm and the
+//  namespace rtnorm cannot both be declared at global scope, so a file
+//  that uses both must include rtnorm.h inside a namespace of its own:
+//
+//      namespace capi {
+//      extern "C" {
+//      #include "rtnorm.h"
+//      }
+//      }
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __RTNORM_HPP
+#define __RTNORM_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <ostream>
+#include <random>
+#include <type_traits>
+
+namespace rtnorm {
+
+namespace detail {
+
+#include "rtnorm_data.h"
+#include "rtnorm_config.h"
+
+// Design constants, from rtnorm_data.h and rtnorm_config.h
+constexpr int N = RTNORM_N;     // Index of the right tail
+constexpr int kmode = RTNORM_KMODE;     // Last box left of the mode
+constexpr double xmin = RTNORM_XMIN;    // Left bound
+constexpr double xmax = RTNORM_XMAX;    // Right bound
+constexpr int kmin = RTNORM_CFG_KMIN;   // if kb-ka < kmin then use a rejection algorithm
+// GAUSSIAN if a < xgauss, EXPONENTIAL if a > xexp
+constexpr double xgauss = std::max(double(RTNORM_CFG_XMIN), xmin);
+constexpr double xexp = std::min(double(RTNORM_CFG_XMAX), xmax);
+constexpr double INVH = RTNORM_INVH;    // = 1/h
+constexpr int I0 = RTNORM_I0;   // = - floor(x(0)/h)
+constexpr double ALPHA = 1.837877066409345; // = log(2*pi)
+constexpr double yl0 = RTNORM_YL0;      // y_l of the leftmost rectangle
+constexpr double ylN = RTNORM_YLN;      // y_l of the rightmost rectangle
+
+enum { CHOPIN, EXPONENTIAL, GAUSSIAN };
+
+// Compute y_l from y_k
+inline double yl(int k) {
+    if(k == 0)
+        return yl0;
+    else if(k == N - 1)
+        return ylN;
+    else if(k <= kmode)
+        return yu[k - 1];
+    else
+        return yu[k + 1];
+}
+
+// Uniform double in [0,1) with 53 random bits. Engines with 64-bit
+// or 32-bit output, the common cases, take a fast path.
+template<class URBG>
+inline double uniform(URBG &g) {
+    constexpr unsigned long long range =
+        static_cast<unsigned long long>(URBG::max() - URBG::min());
+
+    if constexpr(range == ~0ULL) {
+        return ((g() - URBG::min()) >> 11) * 0x1.0p-53;
+    } else if constexpr(range == 0xffffffffULL) {
+        unsigned long long hi = (g() - URBG::min()) >> 5;
+        unsigned long long lo = (g() - URBG::min()) >> 6;
+        return (hi * 67108864.0 + lo) * 0x1.0p-53;
+    } else {
+        double      u = std::generate_canonical<double,
+            std::numeric_limits<double>::digits>(g);
+        return u < 1.0 ? u : std::nextafter(1.0, 0.0);
+    }
+}
+
+// Everything needed to sample a standardized interval. Same as
+// RtnormPlan and rtnorm_plan_init in rtnorm.c.
+struct plan {
+    int         regime;         // CHOPIN, EXPONENTIAL, or GAUSSIAN
+    int         flip;           // if true, sample [-b,-a] and negate
+    double      a, b;           // standardized bounds, after flipping
+    int         ka, kb;         // range of boxes used by CHOPIN
+    double      twoasq, expab;  // constants used by EXPONENTIAL
+
+    plan(double lo, double hi) : ka(0), kb(0), twoasq(0), expab(0) {
+        int         i;
+
+        if(!(lo < hi)) {
+            std::fprintf(stderr, "%s:%d: *** B must be greater than A ! ***\n",
+                         __FILE__, __LINE__);
+            std::exit(1);
+        }
+        flip = std::fabs(lo) > std::fabs(hi);
+        a = flip ? -hi : lo;
+        b = flip ? -lo : hi;
+
+        if(a > xexp)
+            regime = EXPONENTIAL;
+        else if(a < xgauss)
+            regime = GAUSSIAN;
+        else {
+            i = I0 + static_cast<int>(std::floor(a * INVH));
+            ka = ncell[i];
+            if(b >= xmax)
+                kb = N;
+            else {
+                i = I0 + static_cast<int>(std::floor(b * INVH));
+                kb = ncell[i];
+            }
+            if(kb < N && x[kb + 1] < b)
+                kb += 1;
+            regime = (std::abs(kb - ka) < kmin && a != 0.0) ?
+                EXPONENTIAL : CHOPIN;
+        }
+        if(regime == EXPONENTIAL) {
+            twoasq = 2 * a * a;
+            expab = std::expm1(-a * (b - a));
+        }
+    }
+
+    // Draw a standardized value. normal supplies the Gaussian
+    // proposals of the GAUSSIAN regime.
+    template<class URBG>
+    double draw(URBG &g, std::normal_distribution<double> &normal) const {
+        double      r = 0.0, z, e, u, d, sim, simy, ylk;
+        int         k;
+
+        switch (regime) {
+        case EXPONENTIAL:
+            do {
+                z = std::log(1 + uniform(g) * expab);
+                e = -std::log(uniform(g));
+            } while(twoasq * e <= z * z);
+            r = a - z / a;
+            break;
+
+        case GAUSSIAN:
+            do {
+                r = normal(g);
+            } while(!(r >= a && r <= b));
+            break;
+
+        case CHOPIN:
+            for(;;) {
+                k = static_cast<int>(std::floor(uniform(g) * (kb - ka + 1)))
+                    + ka;
+                u = uniform(g);
+
+                if(k == N) {
+                    // Right tail: draw from the whole tail, then
+                    // check b. See rtnorm_plan_step in rtnorm.c.
+                    z = -std::log(u) / x[N];
+                    e = -std::log(uniform(g));
+                    while(z * z > 2 * e) {
+                        z = -std::log(uniform(g)) / x[N];
+                        e = -std::log(uniform(g));
+                    }
+                    if(z < b - x[N]) {
+                        r = x[N] + z;
+                        break;
+                    }
+                } else if(k <= ka + 1 || (k >= kb - 1 && b < xmax)) {
+                    // Two leftmost and rightmost regions
+                    sim = x[k] + (x[k + 1] - x[k]) * u;
+                    if(sim >= a && sim <= b) {
+                        simy = yu[k] * uniform(g);
+                        if(simy < yl(k)
+                           || sim * sim + 2 * std::log(simy) + ALPHA < 0) {
+                            r = sim;
+                            break;
+                        }
+                    }
+                } else {
+                    // All the other boxes
+                    simy = yu[k] * u;
+                    d = x[k + 1] - x[k];
+                    ylk = yl(k);
+                    if(simy < ylk) {
+                        r = x[k] + u * d * yu[k] / ylk;
+                        break;
+                    }
+                    sim = x[k] + d * uniform(g);
+                    if(sim * sim + 2 * std::log(simy) + ALPHA < 0) {
+                        r = sim;
+                        break;
+                    }
+                }
+            }
+            break;
+        }
+        return flip ? -r : r;
+    }
+};
+
+}                               // namespace detail
+
+// The Gaussian with mean mu and standard deviation sigma, truncated to
+// [a,b]. By default, the untruncated standard Gaussian.
+template<class RealType = double>
+class truncated_normal_distribution {
+    static_assert(std::is_floating_point<RealType>::value,
+                  "RealType must be a floating-point type");
+
+  public:
+    typedef RealType result_type;
+
+    class param_type {
+      public:
+        typedef truncated_normal_distribution distribution_type;
+
+        explicit param_type(RealType a =
+                            -std::numeric_limits<RealType>::infinity(),
+                            RealType b =
+                            std::numeric_limits<RealType>::infinity(),
+                            RealType mu = 0, RealType sigma = 1)
+        : a_(a), b_(b), mu_(mu), sigma_(sigma) {
+        }
+
+        RealType    a() const {
+            return a_;
+        }
+        RealType    b() const {
+            return b_;
+        }
+        RealType    mean() const {
+            return mu_;
+        }
+        RealType    stddev() const {
+            return sigma_;
+        }
+
+        friend bool operator==(const param_type &p, const param_type &q) {
+            return p.a_ == q.a_ && p.b_ == q.b_ && p.mu_ == q.mu_
+                && p.sigma_ == q.sigma_;
+        }
+        friend bool operator!=(const param_type &p, const param_type &q) {
+            return !(p == q);
+        }
+
+      private:
+        RealType    a_, b_, mu_, sigma_;
+    };
+
+    truncated_normal_distribution()
+    : truncated_normal_distribution(param_type()) {
+    }
+
+    explicit truncated_normal_distribution(RealType a, RealType b =
+                                           std::numeric_limits<RealType>::
+                                           infinity(), RealType mu = 0,
+                                           RealType sigma = 1)
+    : truncated_normal_distribution(param_type(a, b, mu, sigma)) {
+    }
+
+    explicit truncated_normal_distribution(const param_type &p)
+    : p_(p), plan_(make_plan(p)) {
+    }
+
+    void        reset() {
+        normal_.reset();
+    }
+
+    param_type  param() const {
+        return p_;
+    }
+    void        param(const param_type &p) {
+        p_ = p;
+        plan_ = make_plan(p);
+    }
+
+    RealType    a() const {
+        return p_.a();
+    }
+    RealType    b() const {
+        return p_.b();
+    }
+    RealType    mean() const {
+        return p_.mean();
+    }
+    RealType    stddev() const {
+        return p_.stddev();
+    }
+    result_type min() const {
+        return p_.a();
+    }
+    result_type max() const {
+        return p_.b();
+    }
+
+    template<class URBG>
+    result_type operator()(URBG &g) {
+        return scale(plan_.draw(g, normal_), p_);
+    }
+
+    // Parameters that change from call to call are set up on each
+    // call, which costs little next to the draw itself.
+    template<class URBG>
+    result_type operator()(URBG &g, const param_type &p) {
+        return scale(make_plan(p).draw(g, normal_), p);
+    }
+
+    // Fill [first,last) with draws. The interval is set up once, and
+    // values are drawn in blocks whose scaling the compiler can
+    // vectorize.
+    template<class ForwardIt, class URBG>
+    void        generate(ForwardIt first, ForwardIt last, URBG &g) {
+        fill(first, last, g, p_, plan_);
+    }
+
+    template<class ForwardIt, class URBG>
+    void        generate(ForwardIt first, ForwardIt last, URBG &g,
+                         const param_type &p) {
+        fill(first, last, g, p, make_plan(p));
+    }
+
+    // Draw n values, passing them to f(const RealType *x, std::size_t m)
+    // a block at a time, as rtnorm_reduce in reduce.h passes them to a
+    // fold. The blocks are those generate would store, and stay in the
+    // L1 cache, so a reduction costs no memory traffic.
+    template<class URBG, class F>
+    void        reduce(URBG &g, std::size_t n, F &&f) {
+        blocks(g, p_, plan_, n, f);
+    }
+
+    template<class URBG, class F>
+    void        reduce(URBG &g, std::size_t n, F &&f, const param_type &p) {
+        blocks(g, p, make_plan(p), n, f);
+    }
+
+    friend bool operator==(const truncated_normal_distribution &d1,
+                           const truncated_normal_distribution &d2) {
+        return d1.p_ == d2.p_ && d1.normal_ == d2.normal_;
+    }
+    friend bool operator!=(const truncated_normal_distribution &d1,
+                           const truncated_normal_distribution &d2) {
+        return !(d1 == d2);
+    }
+
+    template<class CharT, class Traits>
+    friend std::basic_ostream<CharT, Traits> &
+    operator<<(std::basic_ostream<CharT, Traits> &os,
+               const truncated_normal_distribution &d) {
+        auto        flags = os.flags();
+        auto        prec = os.precision();
+        CharT       sp = os.widen(' ');
+
+        os.flags(std::ios_base::scientific | std::ios_base::left);
+        os.precision(std::numeric_limits<RealType>::max_digits10);
+        os << d.a() << sp << d.b() << sp << d.mean() << sp << d.stddev()
+            << sp << d.normal_;
+        os.flags(flags);
+        os.precision(prec);
+        return os;
+    }
+
+    template<class CharT, class Traits>
+    friend std::basic_istream<CharT, Traits> &
+    operator>>(std::basic_istream<CharT, Traits> &is,
+               truncated_normal_distribution &d) {
+        auto        flags = is.flags();
+        RealType    a, b, mu, sigma;
+
+        is.flags(std::ios_base::dec | std::ios_base::skipws);
+        if(is >> a >> b >> mu >> sigma >> d.normal_)
+            d.param(param_type(a, b, mu, sigma));
+        is.flags(flags);
+        return is;
+    }
+
+  private:
+    // Values per block in generate
+    static constexpr std::size_t BLOCK = 256;
+
+    param_type  p_;
+    detail::plan plan_;
+    std::normal_distribution<double> normal_;
+
+    static detail::plan make_plan(const param_type &p) {
+        return detail::plan((p.a() - static_cast<double>(p.mean()))
+                            / p.stddev(),
+                            (p.b() - static_cast<double>(p.mean()))
+                            / p.stddev());
+    }
+
+    // Map standardized value z back to [a,b]. Rounding to RealType may
+    // leave the interval by an ulp, so clamp.
+    static result_type scale(double z, const param_type &p) {
+        RealType    v = static_cast<RealType>(p.mean() + p.stddev() * z);
+
+        return std::min(std::max(v, p.a()), p.b());
+    }
+
+    template<class ForwardIt, class URBG>
+    void        fill(ForwardIt first, ForwardIt last, URBG &g,
+                     const param_type &p, const detail::plan &pl) {
+        auto        copy = [&first] (const RealType *v, std::size_t m) {
+            first = std::copy(v, v + m, first);
+        };
+
+        blocks(g, p, pl, std::distance(first, last), copy);
+    }
+
+    // Draw n values and pass them to f a block at a time.
+    template<class URBG, class F>
+    void        blocks(URBG &g, const param_type &p, const detail::plan &pl,
+                       std::size_t n, F &f) {
+        double      z[BLOCK];
+        RealType    v[BLOCK];
+        const double mu = p.mean(), sigma = p.stddev();
+        const RealType lo = p.a(), hi = p.b();
+        std::size_t i, m;
+
+        while(n > 0) {
+            m = n < BLOCK ? n : BLOCK;
+            for(i = 0; i < m; ++i)
+                z[i] = pl.draw(g, normal_);
+            for(i = 0; i < m; ++i) {
+                v[i] = static_cast<RealType>(mu + sigma * z[i]);
+                v[i] = v[i] < lo ? lo : v[i];
+                v[i] = v[i] > hi ? hi : v[i];
+            }
+            f(static_cast<const RealType *>(v), m);
+            n -= m;
+        }
+    }
+};
+
+// Draw n values from the distribution with parameters p, passing them
+// to f(const RealType *x, std::size_t m) a block at a time. See
+// truncated_normal_distribution::reduce.
+template<class Param, class URBG, class F>
+void reduce(const Param &p, URBG &g, std::size_t n, F &&f) {
+    typename Param::distribution_type d(p);
+
+    d.reduce(g, n, f);
+}
+
+}                               // namespace rtnorm
+
+#endif //__RTNORM_HPP
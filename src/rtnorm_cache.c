@@ -0,0 +1,224 @@
+//  Cache of plans. See rtnorm_cache.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rtnorm_cache.h"
+#include "rtnorm_impl.h"
+
+// Entries per set
+#define WAYS 4
+
+// Entries in each thread's direct-mapped front cache
+#define NFRONT 64
+
+typedef struct Entry {
+    double      a, b;           // standardized bounds; a is NaN if empty
+    int         ref;            // CLOCK reference bit
+    RtnormPlan  plan;
+} Entry;
+
+typedef struct Set {
+    Entry       e[WAYS];
+    int         hand;           // next entry the CLOCK considers
+} Set;
+
+// One thread's lookups. Only the owning thread writes its counts,
+// so hits take no atomic read-modify-write on a line other threads
+// share. The padding keeps the counts of different threads on
+// different cache lines.
+typedef struct Count {
+    unsigned long hits, misses;
+    struct Count *next;
+    char        pad[64 - 2 * sizeof(unsigned long) - sizeof(void *)];
+} Count;
+
+typedef struct Cache {
+    pthread_rwlock_t lock;
+    size_t      mask;           // number of sets, minus 1
+    Count      *count;          // every thread's counts, since enabled
+    Set        *set;
+} Cache;
+
+// Plans this thread found recently. An entry is valid only if its
+// generation matches the cache's, so enabling or disabling the cache
+// invalidates every thread's front at once.
+typedef struct Front {
+    double      a, b;
+    unsigned long gen;
+    RtnormPlan  plan;
+} Front;
+
+static Cache *cache;
+static unsigned long generation;
+static __thread Front front[NFRONT];
+static __thread Count *count;
+static __thread unsigned long count_gen;
+
+static size_t hash(double a, double b);
+static Count *counter(Cache * c);
+static void lookup(RtnormPlan * p, double a, double b);
+
+// Mix the bits of both bounds.
+static size_t hash(double a, double b) {
+    uint64_t    u, v;
+
+    memcpy(&u, &a, sizeof(u));
+    memcpy(&v, &b, sizeof(v));
+    u ^= v * 0x9e3779b97f4a7c15ULL;
+    u ^= u >> 31;
+    u *= 0xbf58476d1ce4e5b9ULL;
+    u ^= u >> 29;
+    return (size_t) u;
+}
+
+// This thread's counts in cache c, which are linked into the cache on
+// its first lookup since the cache was enabled
+static Count *counter(Cache * c) {
+    if(count_gen != generation) {
+        count = malloc(sizeof(Count));
+        if(count == NULL) {
+            fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+            exit(1);
+        }
+        count->hits = count->misses = 0;
+        pthread_rwlock_wrlock(&c->lock);
+        count->next = c->count;
+        c->count = count;
+        pthread_rwlock_unlock(&c->lock);
+        count_gen = generation;
+    }
+    return count;
+}
+
+// Installed as rtnorm_plan_cache
+static void lookup(RtnormPlan * p, double a, double b) {
+    Cache      *c = cache;
+    size_t      h = hash(a, b);
+    Front      *f = front + (h >> 58) % NFRONT;
+    Set        *s = c->set + (h & c->mask);
+    Count      *n = counter(c);
+    Entry      *e;
+    int         i;
+
+    // Threads drawing from few intervals find them here, and take no
+    // lock.
+    if(f->gen == generation && f->a == a && f->b == b) {
+        *p = f->plan;
+        __atomic_store_n(&n->hits, n->hits + 1, __ATOMIC_RELAXED);
+        return;
+    }
+    f->gen = generation;
+    f->a = a;
+    f->b = b;
+
+    pthread_rwlock_rdlock(&c->lock);
+    for(i = 0; i < WAYS; ++i) {
+        e = s->e + i;
+        if(e->a == a && e->b == b) {
+            *p = f->plan = e->plan;
+            if(!__atomic_load_n(&e->ref, __ATOMIC_RELAXED))
+                __atomic_store_n(&e->ref, 1, __ATOMIC_RELAXED);
+            pthread_rwlock_unlock(&c->lock);
+            __atomic_store_n(&n->hits, n->hits + 1, __ATOMIC_RELAXED);
+            return;
+        }
+    }
+    pthread_rwlock_unlock(&c->lock);
+
+    __atomic_store_n(&n->misses, n->misses + 1, __ATOMIC_RELAXED);
+    rtnorm_plan_init_table(p, &rtnorm_table, a, b);
+    f->plan = *p;
+
+    pthread_rwlock_wrlock(&c->lock);
+    for(i = 0; i < WAYS; ++i) {
+        if(s->e[i].a == a && s->e[i].b == b)
+            break;              // another thread got here first
+    }
+    if(i == WAYS) {
+        // Sweep the hand past recently used entries, clearing their
+        // reference bits, and replace the first entry not used since
+        // the hand last passed.
+        for(;;) {
+            e = s->e + s->hand;
+            s->hand = (s->hand + 1) % WAYS;
+            if(!e->ref)
+                break;
+            e->ref = 0;
+        }
+        e->a = a;
+        e->b = b;
+        e->plan = *p;
+        e->ref = 1;
+    }
+    pthread_rwlock_unlock(&c->lock);
+}
+
+void rtnorm_cache_enable(size_t capacity) {
+    size_t      nset = 1, i;
+    int         j;
+
+    rtnorm_cache_disable();
+    if(capacity == 0)
+        return;
+    while(nset * WAYS < capacity)
+        nset *= 2;
+
+    cache = malloc(sizeof(Cache));
+    if(cache)
+        cache->set = malloc(nset * sizeof(Set));
+    if(cache == NULL || cache->set == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    pthread_rwlock_init(&cache->lock, NULL);
+    cache->mask = nset - 1;
+    cache->count = NULL;
+    ++generation;
+    for(i = 0; i < nset; ++i) {
+        cache->set[i].hand = 0;
+        for(j = 0; j < WAYS; ++j) {
+            cache->set[i].e[j].a = NAN;
+            cache->set[i].e[j].b = NAN;
+            cache->set[i].e[j].ref = 0;
+        }
+    }
+    __atomic_store_n(&rtnorm_plan_cache, lookup, __ATOMIC_RELEASE);
+}
+
+void rtnorm_cache_disable(void) {
+    __atomic_store_n(&rtnorm_plan_cache, NULL, __ATOMIC_RELEASE);
+    ++generation;
+    if(cache == NULL)
+        return;
+    pthread_rwlock_destroy(&cache->lock);
+    while(cache->count != NULL) {
+        Count      *n = cache->count;
+        cache->count = n->next;
+        free(n);
+    }
+    free(cache->set);
+    free(cache);
+    cache = NULL;
+}
+
+void rtnorm_cache_stats(unsigned long *hits, unsigned long *misses) {
+    Count      *n;
+
+    *hits = *misses = 0;
+    if(cache == NULL)
+        return;
+    pthread_rwlock_rdlock(&cache->lock);
+    for(n = cache->count; n != NULL; n = n->next) {
+        *hits += __atomic_load_n(&n->hits, __ATOMIC_RELAXED);
+        *misses += __atomic_load_n(&n->misses, __ATOMIC_RELAXED);
+    }
+    pthread_rwlock_unlock(&cache->lock);
+}
@@ -0,0 +1,41 @@
+//  Cache of the plans rtnorm makes for each interval.
+//
+//  Before its first draw from an interval, rtnorm standardizes it,
+//  finds the boxes it spans, and chooses an algorithm. Call sites that
+//  draw one value at a time from a few thousand recurring intervals
+//  repeat this work on every call. With the cache enabled, rtnorm,
+//  rtnorm_fill and the samplers built on them look up the plan for
+//  each standardized interval instead, and compute it only on a miss.
+//  Output is unchanged. With the shipped tables a plan costs about
+//  as much as a lookup, and a miss costs more than planning, so time
+//  the workload (bcache is a start) before enabling the cache.
+//
+//  The cache is a hash table of sets of a few entries each, with a
+//  CLOCK approximation of least-recently-used replacement within each
+//  set, behind a small direct-mapped table per thread. Lookups in the
+//  shared table take a shared lock and insertions an exclusive one,
+//  so any number of threads may sample at once. Each thread counts
+//  its own hits and misses, and rtnorm_cache_stats sums them. Enable
+//  and disable the cache while no other thread is sampling.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __RTNORM_CACHE_H
+#define __RTNORM_CACHE_H
+
+#include <stddef.h>
+
+// Start caching plans, with room for at least capacity intervals. If
+// the cache is already enabled, it is emptied and resized. A capacity
+// of 0 disables it.
+void        rtnorm_cache_enable(size_t capacity);
+
+// Stop caching plans, and free the cache.
+void        rtnorm_cache_disable(void);
+
+// Lookups that found a plan and lookups that made one, since the
+// cache was last enabled
+void        rtnorm_cache_stats(unsigned long *hits, unsigned long *misses);
+
+#endif //__RTNORM_CACHE_H
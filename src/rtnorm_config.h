@@ -0,0 +1,14 @@
+// Regime thresholds of rtnorm
+//
+// A standardized interval [a,b], flipped so that |a| <= |b|, is
+// sampled by rejection from an exponential proposal if a > XMAX, by
+// rejection from the Gaussian if a < XMIN, and otherwise by Chopin's
+// algorithm, unless it spans fewer than KMIN boxes, in which case the
+// exponential proposal is used again. The thresholds change only
+// speed, never the distribution, so each machine may have its own:
+// rtnormtune measures this host and writes a replacement for this
+// file. XMIN below the left edge of the boxes, or XMAX beyond the
+// right edge, is taken as that edge.
+#define RTNORM_CFG_KMIN  RTNORM_KMIN
+#define RTNORM_CFG_XMIN  RTNORM_XMIN
+#define RTNORM_CFG_XMAX  RTNORM_XMAX
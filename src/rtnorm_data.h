@@ -1,4 +1,20 @@
 // Pregenerated tables
+
+// Design constants of the tables. Box k covers [x[k], x[k+1]], and all
+// boxes have area Q(xmax), the upper tail probability of xmax. Boxes
+// 0..RTNORM_KMODE lie left of the mode. Tables written by rtnormdesign
+// (see design.h) have the same form, and can replace this file.
+#define RTNORM_N     4001                   // Index of the right tail
+#define RTNORM_KMODE 1953                   // Last box left of the mode
+#define RTNORM_KMIN  5                      // if kb-ka < kmin then use a rejection algorithm
+#define RTNORM_XMIN  -2.00443204036         // Left bound
+#define RTNORM_XMAX  3.48672170399          // Right bound
+#define RTNORM_INVH  1631.73284006          // = 1/h, h being the minimal interval range
+#define RTNORM_I0    3271                   // = - floor(x(0)/h)
+#define RTNORM_NCELL 8961                   // Length of ncell
+#define RTNORM_YL0   0.053513975472         // y_l of the leftmost rectangle
+#define RTNORM_YLN   0.000914116389555      // y_l of the rightmost rectangle
+
 static const double x[4002]=
 {
      -2.00443204036, -1.99990455547, -1.99541747213, -1.99096998962, 
@@ -0,0 +1,168 @@
+//  Internals of rtnorm, shared with the other samplers in this
+//  directory. Nothing here is part of the public interface in
+//  rtnorm.h: the layout of these structures may change whenever the
+//  tables or the algorithm do.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __RTNORM_IMPL_H
+#define __RTNORM_IMPL_H
+
+#include <stddef.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+
+// Everything rtnorm needs to know about a standardized interval
+// before it draws the first random number. Computing this once per
+// interval rather than once per draw is what makes rtnorm_fill fast.
+typedef struct RtnormPlan {
+    int         regime;         // RTNORM_CHOPIN, _EXPONENTIAL or _GAUSSIAN
+    int         flip;           // if true, sample [-b,-a] and negate
+    double      a, b;           // standardized bounds, after flipping
+    int         ka, kb;         // range of boxes used by RTNORM_CHOPIN
+    double      twoasq, expab;  // constants used by RTNORM_EXPONENTIAL
+} RtnormPlan;
+
+// Chopin's tables and the design constants that go with them. Box k
+// covers [x[k], x[k+1]] and has height yu[k]; box N is the right
+// tail, beyond x[N] == xmax. See rtnorm_data.h.
+typedef struct RtnormTable {
+    int         N;              // index of the right tail
+    int         kmode;          // last box left of the mode
+    int         kmin;           // if kb-ka < kmin, use EXPONENTIAL
+    int         I0;             // = - floor(x(0)/h)
+    int         nncell;         // length of ncell
+    double      xmin, xmax;     // left and right bounds of the boxes
+    double      xgauss, xexp;   // if a < xgauss use GAUSSIAN, if > xexp
+                                // EXPONENTIAL; see rtnorm_config.h
+    double      INVH;           // = 1/h, h being the width of a cell
+    double      yl0, ylN;       // y_l of the leftmost and rightmost boxes
+    const double *x;            // N+1 box boundaries
+    const double *yu;           // N upper heights
+    const int  *ncell;          // box holding the left end of each cell
+} RtnormTable;
+
+// The tables in use. Its pointers change only in
+// rtnorm_table_hugepage, to copies with the same contents.
+extern RtnormTable rtnorm_table;
+
+// If not NULL, rtnorm_plan_note calls this with the standardized
+// bounds, after flipping, of the plan and the number of draws.
+extern void (*rtnorm_plan_hook)(double a, double b, size_t n);
+
+// If not NULL, rtnorm_plan_init calls this instead of planning with
+// rtnorm_table itself.
+extern void (*rtnorm_plan_cache)(RtnormPlan *p, double a, double b);
+
+void        rtnorm_plan_init(RtnormPlan *p, double a, double b);
+
+// Tell the hook that n values are about to be drawn with plan p.
+// Samplers call this once per plan, so that recording costs nothing
+// per draw.
+void        rtnorm_plan_note(const RtnormPlan *p, size_t n);
+
+// Plan as if t were the table in use. For modelling other designs,
+// or other thresholds: a plan may be drawn from if t has the boxes of
+// rtnorm_table, whatever its thresholds.
+void        rtnorm_plan_init_table(RtnormPlan *p, const RtnormTable *t,
+                                   double a, double b);
+
+double      rtnorm_plan_draw(const RtnormPlan *p, gsl_rng *gen);
+
+// As rtnorm_fill, but always through the cache, whatever the setting
+// of rtnorm_set_stream_bytes: for blocks staged in a buffer and read
+// back at once, or for callers that decide on streaming from the size
+// of their whole output rather than of one call.
+void        rtnorm_fill_cached(gsl_rng *gen, double a, double b,
+                               double mu, double sigma, size_t n,
+                               double *out);
+
+// The current setting of rtnorm_set_stream_bytes
+size_t      rtnorm_stream_threshold(void);
+
+// memcpy with non-temporal stores, which bypass the cache, followed
+// by a store fence. Plain memcpy where SSE2 is not available.
+void        rtnorm_stream_copy(void *dst, const void *src, size_t bytes);
+
+// Build what rtnorm_plan_step needs beyond the plan. rtnorm_plan_init
+// does this itself; a caller that builds plans some other way must
+// call it first.
+void        rtnorm_plan_prepare(void);
+
+// One iteration of Chopin's algorithm, in box k, given the first
+// uniform u drawn after k. Any further uniforms come from gen. On
+// acceptance, set *r to the standardized value, before flipping, and
+// return 1. Return 0 if the proposal is rejected. rtnorm_plan_draw
+// repeats this with k and u drawn from gen; a vectorized caller may
+// draw k and u itself and finish the rare lanes it cannot handle here.
+int         rtnorm_plan_step(const RtnormPlan *p, gsl_rng *gen, int k,
+                             double u, double *r);
+
+// A quadratic through the density at the ends and the middle of a
+// box, and how far the density may stray from it: in box k,
+// |phi(x) - (c0 + s*(c1 + s*c2))| <= eps, where s = x - x[k]. Points
+// further than eps above or below the quadratic are rejected or
+// accepted without computing the density.
+typedef struct RtnormSqueeze {
+    double      c0, c1, c2, eps;
+} RtnormSqueeze;
+
+// Squeeze of box k of table t
+void        rtnorm_table_squeeze(const RtnormTable *t, int k,
+                                 RtnormSqueeze *q);
+
+// Fill miss, which has 2*(t->N + 1) entries, with two sets of sums
+// over boxes j < k, for k in 0..t->N: miss[k] sums 1 - y_l/y_u, the
+// chance that an inner box misses its inner rectangle, and
+// miss[t->N + 1 + k] the chance that it falls between its squeeze
+// bounds and needs a log.
+void        rtnorm_table_miss(const RtnormTable *t, double *miss);
+
+// Expected cost of a draw from the standardized interval [a,b] with
+// table t, whose sums from rtnorm_table_miss are miss. rtnorm_cost
+// calls this with rtnorm_table; design.h, with tables yet to be built.
+void        rtnorm_table_cost(const RtnormTable *t, const double *miss,
+                              double a, double b, RtnormCost *c);
+
+// The inverse of the CDF of a standardized interval, for samplers
+// that draw by inversion rather than by rejection. Unlike a plan, it
+// consumes a fixed number of uniforms per value, which can be sorted,
+// stratified or paired.
+typedef struct RtnormInverse {
+    double      a, b;           // standardized bounds, before flipping
+    int         flip;           // if true, invert on [-b,-a] and negate
+    int         narrow;         // invert by Newton's method from a+u*w
+    int         deep;           // log Q(a) is too small for Q: use logs
+    double      w;              // b - a
+    double      pa, qb;         // P(a) and Q(b), after flipping
+    double      m;              // mass of [a,b], divided by phi(a) if
+                                // narrow
+    double      lqa;            // log Q(a), after flipping
+    double      r;              // Q(b)/Q(a), after flipping, if deep
+} RtnormInverse;
+
+void        rtnorm_inverse_init(RtnormInverse *q, double a, double b);
+
+// The quantile u of the interval of q, in [a,b], where v = 1-u. Pass
+// both, so that a caller who knows a small v more precisely than 1-u
+// keeps that precision in the upper tail, and a small u in the lower.
+// Nondecreasing in u, but for the last bit where the inverse changes
+// from P to Q.
+double      rtnorm_inverse(const RtnormInverse *q, double u, double v);
+
+// What rtnorm_table_version would return if t were the table in use,
+// its thresholds included: tables that draw different values hash
+// differently.
+unsigned long long rtnorm_table_hash(const RtnormTable *t);
+
+// log Q(z), Q being the upper tail probability of the standard
+// Gaussian: -INFINITY at +INFINITY, 0 at -INFINITY.
+double      rtnorm_log_upper(double z);
+
+// Logarithm of the standard Gaussian mass of [a,b], accurate far into
+// either tail.
+double      rtnorm_log_mass(double a, double b);
+
+#endif //__RTNORM_IMPL_H
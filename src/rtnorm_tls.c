@@ -0,0 +1,94 @@
+//  Thread-local default generator. See rtnorm_tls.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtnorm_tls.h"
+#include "chunks.h"
+#include "xoshiro.h"
+
+static unsigned long global_seed = 0;
+static long generation = 0;     // incremented when the seed changes
+static long next_index = 0;     // next automatic thread index
+static pthread_key_t key;       // frees each thread's generator
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+static __thread gsl_rng *rng;
+static __thread long thread_index = -1;
+static __thread long thread_generation = -1;
+
+static void make_key(void);
+static void free_rng(void *p);
+static gsl_rng *slow_rng(void);
+
+static void free_rng(void *p) {
+    gsl_rng_free(p);
+}
+
+static void make_key(void) {
+    if(pthread_key_create(&key, free_rng)) {
+        fprintf(stderr, "%s:%d: can't create thread key\n",
+                __FILE__, __LINE__);
+        exit(1);
+    }
+}
+
+void rtnorm_tls_seed(unsigned long seed) {
+    __atomic_store_n(&global_seed, seed, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&generation, 1, __ATOMIC_RELEASE);
+}
+
+void rtnorm_tls_thread(long index) {
+    thread_index = index;
+    thread_generation = -1;
+}
+
+// Allocate, index or reseed the calling thread's generator, as needed.
+static gsl_rng *slow_rng(void) {
+    long        gen = __atomic_load_n(&generation, __ATOMIC_ACQUIRE);
+
+    if(rng == NULL) {
+        pthread_once(&once, make_key);
+        rng = gsl_rng_alloc(rtnorm_rng_xoshiro256p);
+        if(rng == NULL) {
+            fprintf(stderr, "%s:%d: can't allocate generator\n",
+                    __FILE__, __LINE__);
+            exit(1);
+        }
+        pthread_setspecific(key, rng);
+    }
+    if(thread_index < 0)
+        thread_index = __atomic_fetch_add(&next_index, 1, __ATOMIC_RELAXED);
+    gsl_rng_set(rng, chunk_seed(__atomic_load_n(&global_seed,
+                                                __ATOMIC_RELAXED),
+                                thread_index));
+    thread_generation = gen;
+    return rng;
+}
+
+gsl_rng *rtnorm_tls_rng(void) {
+    if(thread_generation == __atomic_load_n(&generation, __ATOMIC_ACQUIRE))
+        return rng;
+    return slow_rng();
+}
+
+double rtnorm_tls(double a, double b, double mu, double sigma) {
+    return rtnorm(rtnorm_tls_rng(), a, b, mu, sigma);
+}
+
+void rtnorm_tls_fill(double a, double b, double mu, double sigma,
+                     size_t n, double *out) {
+    rtnorm_fill(rtnorm_tls_rng(), a, b, mu, sigma, n, out);
+}
+
+void rtnorm_tls_fill_rows(size_t n, const double *a, const double *b,
+                          const double *mu, const double *sigma,
+                          double *out) {
+    rtnorm_fill_rows(rtnorm_tls_rng(), n, a, b, mu, sigma, out);
+}
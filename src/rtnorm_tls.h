@@ -0,0 +1,44 @@
+//  Truncated Gaussian draws from a thread-local default generator.
+//
+//  Callers that do not care which stream they draw from need not pass
+//  a gsl_rng around. Each thread gets its own xoshiro256+ generator
+//  (see xoshiro.h), allocated on first use and freed when the thread
+//  exits, so no locking is needed. Thread i is seeded with
+//  chunk_seed(seed, i), where seed is the global seed, so a program
+//  that gives each thread a fixed index gets the same values on every
+//  run, whatever the timing of its threads.
+//
+//  A thread's index is whatever it last passed to rtnorm_tls_thread.
+//  Threads that never call it get 0, 1, 2, ... in order of first use,
+//  which is reproducible only if that order is. The global seed is 0
+//  until rtnorm_tls_seed is called. Call rtnorm_tls_seed before other
+//  threads start sampling.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __RTNORM_TLS_H
+#define __RTNORM_TLS_H
+
+#include <stddef.h>
+#include <gsl/gsl_rng.h>
+
+// Set the global seed. Every thread reseeds before its next draw.
+void        rtnorm_tls_seed(unsigned long seed);
+
+// Set the index of the calling thread, and reseed its generator.
+void        rtnorm_tls_thread(long index);
+
+// The calling thread's generator, for use with the other samplers.
+gsl_rng    *rtnorm_tls_rng(void);
+
+// Same as rtnorm, rtnorm_fill and rtnorm_fill_rows, using the calling
+// thread's generator.
+double      rtnorm_tls(double a, double b, double mu, double sigma);
+void        rtnorm_tls_fill(double a, double b, double mu, double sigma,
+                            size_t n, double *out);
+void        rtnorm_tls_fill_rows(size_t n, const double *a,
+                                 const double *b, const double *mu,
+                                 const double *sigma, double *out);
+
+#endif //__RTNORM_TLS_H
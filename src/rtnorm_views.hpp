@@ -0,0 +1,120 @@
+//  C++20 range of truncated Gaussian samples.
+//
+//  rtnorm::views::samples(urbg, a, b, mu, sigma) is an endless input
+//  range of draws. Values are generated in blocks of BLOCK with
+//  truncated_normal_distribution::generate, and handed out one at a
+//  time, so pipelines such as
+//
+//      for(double x : rtnorm::views::samples(eng, -1.0, 2.0)
+//                     | std::views::take(n)
+//                     | std::views::transform(f))
+//          acc.add(x);
+//
+//  run in constant memory. A block is drawn as soon as its first value
+//  is needed, so the engine may advance by up to BLOCK-1 values more
+//  than the pipeline consumes. Like std::ranges::istream_view, the
+//  view owns the current block, and its iterator points back to it:
+//  iterate the view where it is, rather than moving it after begin.
+//
+//  Requires C++20.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __RTNORM_VIEWS_HPP
+#define __RTNORM_VIEWS_HPP
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <type_traits>
+
+#include "rtnorm.hpp"
+
+namespace rtnorm {
+
+template<class URBG, class RealType = double>
+class sample_view : public std::ranges::view_interface<sample_view<URBG,
+                                                                  RealType>> {
+  public:
+    // Values per block: enough for the vectorized scaling in
+    // generate, small enough to stay in the L1 cache.
+    static constexpr std::size_t BLOCK = 64;
+
+    class iterator {
+      public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = RealType;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+        explicit iterator(sample_view *v) : v_(v) {
+        }
+        iterator(iterator &&) = default;
+        iterator &operator=(iterator &&) = default;
+
+        const RealType &operator*() const {
+            return v_->buf_[v_->pos_];
+        }
+        iterator &operator++() {
+            if(++v_->pos_ == BLOCK)
+                v_->refill();
+            return *this;
+        }
+        void        operator++(int) {
+            ++*this;
+        }
+
+      private:
+        sample_view *v_ = nullptr;
+    };
+
+    sample_view() = default;
+
+    sample_view(URBG &g, RealType a, RealType b, RealType mu,
+                RealType sigma)
+    : g_(std::addressof(g)), d_(a, b, mu, sigma) {
+    }
+
+    iterator    begin() {
+        refill();
+        return iterator(this);
+    }
+    std::unreachable_sentinel_t end() const {
+        return std::unreachable_sentinel;
+    }
+
+  private:
+    URBG       *g_ = nullptr;
+    truncated_normal_distribution<RealType> d_;
+    std::array<RealType, BLOCK> buf_{};
+    std::size_t pos_ = 0;
+
+    void        refill() {
+        d_.generate(buf_.begin(), buf_.end(), *g_);
+        pos_ = 0;
+    }
+};
+
+namespace views {
+
+// Endless range of draws from the Gaussian with mean mu and standard
+// deviation sigma, truncated to [a,b], using engine g. g must outlive
+// the range. samples<float>(...) yields floats.
+template<class RealType = double, class URBG>
+sample_view<URBG, RealType> samples(URBG &g,
+                                    std::type_identity_t<RealType> a,
+                                    std::type_identity_t<RealType> b,
+                                    std::type_identity_t<RealType> mu = 0,
+                                    std::type_identity_t<RealType> sigma =
+                                    1) {
+    return sample_view<URBG, RealType>(g, a, b, mu, sigma);
+}
+
+}                               // namespace views
+
+}                               // namespace rtnorm
+
+#endif //__RTNORM_VIEWS_HPP
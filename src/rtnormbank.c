@@ -0,0 +1,107 @@
+//  rtnormbank: describe and check a sample bank written by rtnormgen.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+//
+//  Depends: LibGSL
+//  OS: Unix based system
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include "rtnorm.h"
+#include "bank.h"
+
+static void usage(void);
+
+static void usage(void) {
+    fprintf(stderr, "usage: rtnormbank [options] <bankfile>\n");
+    fprintf(stderr, "  where options may include:\n");
+    fprintf(stderr, "  -c         verify the checksum of every block\n");
+    fprintf(stderr, "  -r         regenerate every block and compare\n");
+    fprintf(stderr, "  -p <i>     print value number i\n");
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    int         i, check = 0, regen = 0, status = 0;
+    long long   print = -1;
+    Bank       *bank;
+    const BankHeader *h;
+    size_t      blk, nbad = 0, nskip = 0;
+
+    while((i = getopt(argc, argv, "crp:h")) != -1) {
+        switch (i) {
+        case 'c':
+            check = 1;
+            break;
+        case 'r':
+            regen = 1;
+            break;
+        case 'p':
+            print = strtoll(optarg, NULL, 10);
+            break;
+        default:
+            usage();
+        }
+    }
+    if(optind != argc - 1)
+        usage();
+
+    bank = bank_open(argv[optind]);
+    if(bank == NULL)
+        return 1;
+    h = bank_header(bank);
+
+    printf("%-14s %g\n", "a", h->a);
+    printf("%-14s %g\n", "b", h->b);
+    printf("%-14s %g\n", "mu", h->mu);
+    printf("%-14s %g\n", "sigma", h->sigma);
+    printf("%-14s %s\n", "generator", h->generator);
+    printf("%-14s %llu\n", "seed", (unsigned long long) h->seed);
+    printf("%-14s %llu\n", "values", (unsigned long long) h->n);
+    printf("%-14s %llu x %llu\n", "blocks",
+           (unsigned long long) h->nblocks,
+           (unsigned long long) h->block_len);
+    printf("%-14s %016llx%s\n", "table version",
+           (unsigned long long) h->table_version,
+           h->table_version == rtnorm_table_version() ? "" :
+           " (differs from this library)");
+
+    if(print >= 0) {
+        if((unsigned long long) print >= h->n) {
+            fprintf(stderr, "value %lld out of range\n", print);
+            return 1;
+        }
+        printf("%-14s %.17g\n", "value", bank_value(bank, print));
+    }
+
+    for(blk = 0; blk < h->nblocks && (check || regen); ++blk) {
+        if(check && !bank_verify(bank, blk)) {
+            printf("block %zu: bad checksum\n", blk);
+            ++nbad;
+        }
+        if(regen) {
+            switch (bank_regenerate(bank, blk)) {
+            case 0:
+                printf("block %zu: differs from regenerated values\n", blk);
+                ++nbad;
+                break;
+            case -1:
+                ++nskip;
+                break;
+            }
+        }
+    }
+    if(check || regen) {
+        printf("%-14s %zu bad blocks", "checked", nbad);
+        if(nskip)
+            printf(", %zu not regenerated", nskip);
+        putchar('\n');
+        status = nbad > 0;
+    }
+
+    bank_close(bank);
+    return status;
+}
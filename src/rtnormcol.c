@@ -0,0 +1,96 @@
+//  rtnormcol: draw a truncated Gaussian value for each row of a set of
+//  binary column files. See columns.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+//
+//  Depends: LibGSL
+//  OS: Unix based system
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <gsl/gsl_rng.h>
+
+#include "chunks.h"
+#include "columns.h"
+#include "record.h"
+
+static void usage(void);
+
+static void usage(void) {
+    fprintf(stderr, "usage: rtnormcol [options] -a <file> -b <file> -o <file>\n");
+    fprintf(stderr, "  where -a and -b name columns of lower and upper bounds,\n");
+    fprintf(stderr, "  -o names the output column, and options may include:\n");
+    fprintf(stderr, "  -m <file>  column of means (default 0)\n");
+    fprintf(stderr, "  -s <file>  column of standard deviations (default 1)\n");
+    fprintf(stderr, "  -S <seed>  random number seed (default: current time)\n");
+    fprintf(stderr, "  -t <n>     number of threads (default 1)\n");
+    fprintf(stderr, "  -g <name>  GSL generator, xoshiro256+ or"
+            " xoshiro256+x8 (default taus)\n");
+    fprintf(stderr, "  -R <file>  save a histogram of the intervals, for"
+            " rtnormdesign\n");
+    fprintf(stderr, "Columns are raw little-endian doubles or .npy files.\n");
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    const char *a = NULL, *b = NULL, *mu = NULL, *sigma = NULL;
+    const char *out = NULL, *hist = NULL;
+    unsigned long seed = (unsigned long) time(NULL);
+    const gsl_rng_type *T = gsl_rng_taus;
+    int         i, nthreads = 1;
+
+    while((i = getopt(argc, argv, "a:b:m:s:o:S:t:g:R:h")) != -1) {
+        switch (i) {
+        case 'a':
+            a = optarg;
+            break;
+        case 'b':
+            b = optarg;
+            break;
+        case 'm':
+            mu = optarg;
+            break;
+        case 's':
+            sigma = optarg;
+            break;
+        case 'o':
+            out = optarg;
+            break;
+        case 'S':
+            seed = strtoul(optarg, NULL, 10);
+            break;
+        case 't':
+            nthreads = atoi(optarg);
+            break;
+        case 'g':
+            T = chunks_rng_type(optarg);
+            if(T == NULL) {
+                fprintf(stderr, "Unknown generator: %s\n", optarg);
+                usage();
+            }
+            break;
+        case 'R':
+            hist = optarg;
+            break;
+        default:
+            usage();
+        }
+    }
+    if(optind != argc || a == NULL || b == NULL || out == NULL
+       || nthreads < 1)
+        usage();
+
+    if(hist != NULL)
+        record_start();
+    rtnorm_columns(a, b, mu, sigma, out, T, seed, nthreads);
+    if(hist != NULL) {
+        record_stop();
+        if(record_save(hist) != 0)
+            return 1;
+    }
+    return 0;
+}
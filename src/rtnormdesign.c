@@ -0,0 +1,144 @@
+//  rtnormdesign: design tables for rtnorm that are cheap on a recorded
+//  workload. See design.h and record.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+//
+//  Depends: LibGSL
+//  OS: Unix based system
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include "design.h"
+
+static void usage(void);
+
+static void usage(void) {
+    fprintf(stderr, "usage: rtnormdesign [options] <histogram>\n");
+    fprintf(stderr, "  where <histogram> was saved by record_save"
+            " (see record.h),\n");
+    fprintf(stderr, "  e.g. by rtnormcol -R, and options may include:\n");
+    fprintf(stderr, "  -o <file>  write the best tables to file,"
+            " to replace rtnorm_data.h\n");
+    fprintf(stderr, "  -m <n>     at most n bytes of tables"
+            " (default 262144)\n");
+    fprintf(stderr, "  -u <w>     cost of a uniform (default 1)\n");
+    fprintf(stderr, "  -l <w>     cost of a log (default 3)\n");
+    fprintf(stderr, "  -z <w>     cost of a Gaussian draw (default 4)\n");
+    fprintf(stderr, "  -i <w>     cost of a loop iteration (default 1)\n");
+    fprintf(stderr, "  -v         print the cost of every design tried\n");
+    exit(1);
+}
+
+int main(int argc, char **argv) {
+    DesignWeights wt = {1.0, 3.0, 4.0, {1.0, 1.0, 1.0}};
+    Workload    w;
+    Design     *d, *best = NULL, *shipped;
+    const char *out = NULL;
+    size_t      maxbytes = 262144;
+    double      xmin, xmax, c, cbest = 0.0, cshipped;
+    int         opt, kmin, kbest = 0, verbose = 0;
+    FILE       *fp;
+
+    while((opt = getopt(argc, argv, "o:m:u:l:z:i:vh")) != -1) {
+        switch (opt) {
+        case 'o':
+            out = optarg;
+            break;
+        case 'm':
+            maxbytes = strtoul(optarg, NULL, 10);
+            break;
+        case 'u':
+            wt.uniform = strtod(optarg, NULL);
+            break;
+        case 'l':
+            wt.log = strtod(optarg, NULL);
+            break;
+        case 'z':
+            wt.normal = strtod(optarg, NULL);
+            break;
+        case 'i':
+            wt.iter[0] = wt.iter[1] = wt.iter[2] = strtod(optarg, NULL);
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            usage();
+        }
+    }
+    if(optind != argc - 1)
+        usage();
+
+    if(design_workload_load(&w, argv[optind]) != 0)
+        return 1;
+
+    shipped = design_shipped();
+    cshipped = design_workload_cost(shipped, &w, &wt);
+
+    // The shipped tables are a candidate too.
+    if(design_bytes(shipped) <= maxbytes) {
+        best = shipped;
+        cbest = cshipped;
+        kbest = shipped->t.kmin;
+    }
+    for(xmax = 1.5; xmax <= 4.5 + 1e-9; xmax += 0.25) {
+        for(xmin = -3.5; xmin <= -0.25 + 1e-9; xmin += 0.25) {
+            d = design_span(xmin, xmax, 2);
+            if(d == NULL)
+                continue;
+            if(design_bytes(d) > maxbytes) {
+                design_free(d);
+                continue;
+            }
+            for(kmin = 2; kmin <= 10; ++kmin) {
+                d->t.kmin = kmin;
+                c = design_workload_cost(d, &w, &wt);
+                if(verbose)
+                    printf("xmin %8.4f xmax %7.4f kmin %2d N %6d cost %8.4f\n",
+                           d->t.xmin, d->t.xmax, kmin, d->t.N, c);
+                if(best == NULL || c < cbest) {
+                    if(best != NULL && best != d && best != shipped)
+                        design_free(best);
+                    best = d;
+                    cbest = c;
+                    kbest = kmin;
+                }
+            }
+            if(d != best)
+                design_free(d);
+        }
+    }
+    if(best == NULL) {
+        fprintf(stderr, "no design fits in %zu bytes\n", maxbytes);
+        return 1;
+    }
+    best->t.kmin = kbest;
+
+    printf("%-14s %.0f in %zu bins\n", "intervals", w.total, w.n);
+    printf("%-14s xmin %.6f xmax %.6f kmin %d, %zu bytes, cost %.4f\n",
+           "shipped", shipped->t.xmin, shipped->t.xmax, shipped->t.kmin,
+           design_bytes(shipped), cshipped);
+    printf("%-14s xmin %.6f xmax %.6f kmin %d, %zu bytes, cost %.4f\n",
+           "best", best->t.xmin, best->t.xmax, best->t.kmin,
+           design_bytes(best), cbest);
+    printf("%-14s %.3f\n", "speedup", cshipped / cbest);
+
+    if(out != NULL) {
+        fp = fopen(out, "w");
+        if(fp == NULL) {
+            fprintf(stderr, "can't write %s\n", out);
+            return 1;
+        }
+        design_write(best, fp);
+        fclose(fp);
+    }
+
+    if(best != shipped)
+        design_free(best);
+    design_free(shipped);
+    design_workload_free(&w);
+    return 0;
+}
@@ -0,0 +1,844 @@
+//  Single-precision truncated Gaussian samplers. See rtnormf.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtnorm_impl.h"
+#include "rtnormf.h"
+#include "xoshiro.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define RTNORMF_X86 1
+#endif
+
+// Candidates per pass of the vector kernel
+#define BLOCK 256
+
+// Layers of the ziggurat
+#define ZLAYERS 128
+
+// Rows of rtnormf_fill_rows in flight at once
+#define LANES 16
+
+// Plans of a block of rows: standardized bounds after flipping, the
+// range of boxes, the algorithm, and whether the row was flipped. ka
+// and kb are set only for RTNORM_CHOPIN.
+typedef struct Rows {
+    double      a[BLOCK], b[BLOCK];
+    int         ka[BLOCK], kb[BLOCK];
+    unsigned char regime[BLOCK], flip[BLOCK];
+} Rows;
+
+// Evaluate candidates k[0..m-1], u[0..m-1]. Set ok[i] to 1 if
+// candidate i lies in an inner box in [lo,hi] and is accepted by the
+// fast test, in which case r[i] is its standardized value.
+typedef void BoxKernel(int lo, int hi, int m, const int *k, const float *u,
+                       float *r, unsigned char *ok);
+
+// Turn 32-bit uniforms u[0..m-1] into Gaussian candidates by the
+// ziggurat, and store those in [a,b] in r, in order, returning how
+// many. Candidates outside the rectangles of the ziggurat are finished
+// by zig_slow, with further uniforms from gen. Stores may run up to 16
+// floats past the last value returned.
+typedef int ZigKernel(gsl_rng * gen, int m, const uint32_t * u, float a,
+                      float b, float *r);
+
+// Plan rows 0..m-1, as rtnorm_plan_init would, into w. mu and sigma
+// may be NULL.
+typedef void PlanKernel(int m, const float *a, const float *b,
+                        const float *mu, const float *sigma, Rows * w);
+
+// As BoxKernel, but candidate i has its own inner boxes lo[i]..hi[i].
+typedef void RowKernel(int m, const int *lo, const int *hi, const int *k,
+                       const float *u, float *r, unsigned char *ok);
+
+static void init(void);
+static float scale(double z, float a, float b, float mu, float sigma);
+static int  cpu_has(const char *name);
+static BoxKernel box_generic;
+static int  zig_slow(gsl_rng * gen, uint32_t u, float *x);
+static ZigKernel zig_generic;
+static PlanKernel plan_generic;
+static RowKernel rows_generic;
+#ifdef RTNORMF_X86
+static BoxKernel box_avx2;
+static BoxKernel box_avx512;
+static ZigKernel zig_avx2;
+static ZigKernel zig_avx512;
+static PlanKernel plan_avx2;
+static PlanKernel plan_avx512;
+static RowKernel rows_avx2;
+static RowKernel rows_avx512;
+#endif
+
+// Float copies of the tables. In inner box k, a uniform u < thr[k]
+// lies below the lower height of the box and maps to x0[k] + u*c[k].
+// Each holds N+1 entries, allocated by init.
+static float *x0f, *cf, *thrf;
+
+// The ziggurat of Marsaglia and Tsang (2000), for wide intervals. The
+// top 7 bits of a uniform choose a layer l, and the other 25 a signed
+// position j/2^31 across it; the candidate is j*zw[l]. If |j| < zk[l]
+// it lies in the rectangle under the next layer up and is accepted at
+// once. Layer l spans zx[l] across, and heights zf[l] to zf[l+1] of
+// exp(-x*x/2); layer 0 is the base, including the tail beyond zx[1].
+static double zx[ZLAYERS + 1], zf[ZLAYERS + 1];
+static int32_t zk[ZLAYERS];
+static float zw[ZLAYERS];
+
+#ifdef RTNORMF_X86
+// compact8[bits] lists the lanes set in bits, for packing 8 floats.
+static int32_t compact8[256][8];
+#endif
+
+static const struct {
+    const char *name;
+    BoxKernel  *fn;
+    ZigKernel  *zig;
+    PlanKernel *plan;
+    RowKernel  *rows;
+} kernels[] = {
+#ifdef RTNORMF_X86
+    {"avx512", box_avx512, zig_avx512, plan_avx512, rows_avx512},
+    {"avx2", box_avx2, zig_avx2, plan_avx2, rows_avx2},
+#endif
+    {"generic", box_generic, zig_generic, plan_generic, rows_generic}
+};
+
+static const int nkernels = sizeof(kernels) / sizeof(kernels[0]);
+static int  kernel;             // index into kernels
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+// Build the float tables and choose the fastest supported kernel.
+static void init(void) {
+    const RtnormTable *t = &rtnorm_table;
+    double      ylk, thr;
+    int         k;
+
+    x0f = calloc(t->N + 1, sizeof(float));
+    cf = calloc(t->N + 1, sizeof(float));
+    thrf = calloc(t->N + 1, sizeof(float));
+    if(x0f == NULL || cf == NULL || thrf == NULL) {
+        fprintf(stderr, "%s:%d: bad calloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    for(k = 0; k < t->N; ++k) {
+        ylk = yl(k);
+        thr = ylk / t->yu[k];
+
+        // Round the threshold down, so that the float test never
+        // accepts a value the double test would send to the curve.
+        thrf[k] = thr;
+        if(thrf[k] > thr)
+            thrf[k] = nextafterf(thrf[k], 0.0f);
+        x0f[k] = t->x[k];
+        cf[k] = (t->x[k + 1] - t->x[k]) * t->yu[k] / ylk;
+    }
+    x0f[t->N] = t->x[t->N];     // right tail: never inner
+
+    // Each layer has area 9.91256303526217e-3 under exp(-x*x/2).
+    zx[1] = 3.442619855899;
+    zf[1] = exp(-0.5 * zx[1] * zx[1]);
+    zx[0] = 9.91256303526217e-3 / zf[1];
+    zf[0] = 0.0;
+    for(k = 1; k < ZLAYERS - 1; ++k) {
+        zf[k + 1] = 9.91256303526217e-3 / zx[k] + zf[k];
+        zx[k + 1] = sqrt(-2.0 * log(zf[k + 1]));
+    }
+    zx[ZLAYERS] = 0.0;
+    zf[ZLAYERS] = 1.0;
+    for(k = 0; k < ZLAYERS; ++k) {
+        zk[k] = zx[k + 1] / zx[k] * 2147483648.0;
+        zw[k] = zx[k] / 2147483648.0;
+    }
+#ifdef RTNORMF_X86
+    for(k = 0; k < 256; ++k) {
+        int         lane, n = 0;
+
+        for(lane = 0; lane < 8; ++lane)
+            if(k & (1 << lane))
+                compact8[k][n++] = lane;
+    }
+#endif
+
+    for(k = 0; !cpu_has(kernels[k].name); ++k) ;
+    kernel = k;
+
+    // rtnorm_plan_step needs these, and the plan kernels do not build
+    // them.
+    rtnorm_plan_prepare();
+}
+
+// Does this CPU support the named kernel?
+static int cpu_has(const char *name) {
+#ifdef RTNORMF_X86
+    if(strcmp(name, "avx512") == 0)
+        return __builtin_cpu_supports("avx512f");
+    if(strcmp(name, "avx2") == 0)
+        return __builtin_cpu_supports("avx2");
+#endif
+    return strcmp(name, "generic") == 0;
+}
+
+static void box_generic(int lo, int hi, int m, const int *k, const float *u,
+                        float *r, unsigned char *ok) {
+    int         i;
+
+    for(i = 0; i < m; ++i) {
+        ok[i] = k[i] >= lo && k[i] <= hi && u[i] < thrf[k[i]];
+        r[i] = x0f[k[i]] + u[i] * cf[k[i]];
+    }
+}
+
+#ifdef RTNORMF_X86
+// Indices never exceed N, so the gathers need no mask.
+__attribute__((target("avx2")))
+static void box_avx2(int lo, int hi, int m, const int *k, const float *u,
+                     float *r, unsigned char *ok) {
+    const __m256i vlo = _mm256_set1_epi32(lo - 1);
+    const __m256i vhi = _mm256_set1_epi32(hi + 1);
+    int         i, j, bits;
+
+    for(i = 0; i + 8 <= m; i += 8) {
+        __m256i     kk = _mm256_loadu_si256((const __m256i *) (k + i));
+        __m256      uu = _mm256_loadu_ps(u + i);
+        __m256i     in = _mm256_and_si256(_mm256_cmpgt_epi32(kk, vlo),
+                                          _mm256_cmpgt_epi32(vhi, kk));
+        __m256      thr = _mm256_i32gather_ps(thrf, kk, 4);
+        __m256      x0 = _mm256_i32gather_ps(x0f, kk, 4);
+        __m256      c = _mm256_i32gather_ps(cf, kk, 4);
+
+        bits = _mm256_movemask_ps(_mm256_and_ps(_mm256_castsi256_ps(in),
+                                                _mm256_cmp_ps(uu, thr,
+                                                              _CMP_LT_OQ)));
+        _mm256_storeu_ps(r + i, _mm256_add_ps(x0, _mm256_mul_ps(uu, c)));
+        for(j = 0; j < 8; ++j)
+            ok[i + j] = (bits >> j) & 1;
+    }
+    box_generic(lo, hi, m - i, k + i, u + i, r + i, ok + i);
+}
+
+__attribute__((target("avx512f")))
+static void box_avx512(int lo, int hi, int m, const int *k, const float *u,
+                       float *r, unsigned char *ok) {
+    const __m512i vlo = _mm512_set1_epi32(lo);
+    const __m512i vhi = _mm512_set1_epi32(hi);
+    int         i;
+
+    for(i = 0; i + 16 <= m; i += 16) {
+        __m512i     kk = _mm512_loadu_si512(k + i);
+        __m512      uu = _mm512_loadu_ps(u + i);
+        __mmask16   in = _mm512_cmpge_epi32_mask(kk, vlo)
+            & _mm512_cmple_epi32_mask(kk, vhi);
+        __m512      thr = _mm512_i32gather_ps(kk, thrf, 4);
+        __m512      x0 = _mm512_i32gather_ps(kk, x0f, 4);
+        __m512      c = _mm512_i32gather_ps(kk, cf, 4);
+        __mmask16   acc = _mm512_mask_cmp_ps_mask(in, uu, thr, _CMP_LT_OQ);
+
+        _mm512_storeu_ps(r + i, _mm512_add_ps(x0, _mm512_mul_ps(uu, c)));
+        _mm_storeu_si128((__m128i *) (ok + i),
+                         _mm512_cvtepi32_epi8(_mm512_maskz_set1_epi32(acc,
+                                                                      1)));
+    }
+    box_generic(lo, hi, m - i, k + i, u + i, r + i, ok + i);
+}
+#endif
+
+// Finish ziggurat candidate u, which failed the fast test: sample the
+// tail, if it came from the base layer, or test it against the curve.
+// Return 1 and set *x if it is accepted, 0 if not.
+static int zig_slow(gsl_rng * gen, uint32_t u, float *x) {
+    int         l = u >> 25;
+    int32_t     j = (int32_t) ((u << 7) | 64);
+    double      z = j * (zx[l] / 2147483648.0), e;
+
+    if(fabs(z) < zx[l + 1]) {
+        // Missed the fast test only because zk was rounded down
+        *x = z;
+        return 1;
+    }
+    if(l == 0) {
+        do {
+            z = -log(gsl_rng_uniform_pos(gen)) / zx[1];
+            e = -log(gsl_rng_uniform_pos(gen));
+        } while(2 * e < z * z);
+        *x = j < 0 ? -(zx[1] + z) : zx[1] + z;
+        return 1;
+    }
+    if(zf[l] + gsl_rng_uniform(gen) * (zf[l + 1] - zf[l])
+       < exp(-0.5 * z * z)) {
+        *x = z;
+        return 1;
+    }
+    return 0;
+}
+
+static int zig_generic(gsl_rng * gen, int m, const uint32_t * u, float a,
+                       float b, float *r) {
+    int         i, l, n = 0;
+    int32_t     j;
+    float       x;
+
+    for(i = 0; i < m; ++i) {
+        l = u[i] >> 25;
+        j = (int32_t) ((u[i] << 7) | 64);
+        if((j < 0 ? -j : j) < zk[l])
+            x = (float) j * zw[l];
+        else if(!zig_slow(gen, u[i], &x))
+            continue;
+        if(a <= x && x <= b)
+            r[n++] = x;
+    }
+    return n;
+}
+
+#ifdef RTNORMF_X86
+// A vector whose lanes all pass the fast test is masked to [a,b] and
+// packed; any other goes lane by lane, to keep candidates in order.
+__attribute__((target("avx2")))
+static int zig_avx2(gsl_rng * gen, int m, const uint32_t * u, float a,
+                    float b, float *r) {
+    const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+    const __m256i half = _mm256_set1_epi32(64);
+    int         i, n = 0, bits;
+
+    for(i = 0; i + 8 <= m; i += 8) {
+        __m256i     uu = _mm256_loadu_si256((const __m256i *) (u + i));
+        __m256i     l = _mm256_srli_epi32(uu, 25);
+        __m256i     j = _mm256_or_si256(_mm256_slli_epi32(uu, 7), half);
+        __m256i     k = _mm256_i32gather_epi32(zk, l, 4);
+        __m256      x = _mm256_mul_ps(_mm256_cvtepi32_ps(j),
+                                      _mm256_i32gather_ps(zw, l, 4));
+
+        bits = _mm256_movemask_ps(_mm256_castsi256_ps
+                                  (_mm256_cmpgt_epi32
+                                   (k, _mm256_abs_epi32(j))));
+        if(bits != 0xff) {
+            n += zig_generic(gen, 8, u + i, a, b, r + n);
+            continue;
+        }
+        bits = _mm256_movemask_ps(_mm256_and_ps
+                                  (_mm256_cmp_ps(x, va, _CMP_GE_OQ),
+                                   _mm256_cmp_ps(x, vb, _CMP_LE_OQ)));
+        _mm256_storeu_ps(r + n, _mm256_permutevar8x32_ps
+                         (x, _mm256_loadu_si256((const __m256i *)
+                                                compact8[bits])));
+        n += __builtin_popcount(bits);
+    }
+    return n + zig_generic(gen, m - i, u + i, a, b, r + n);
+}
+
+__attribute__((target("avx512f")))
+static int zig_avx512(gsl_rng * gen, int m, const uint32_t * u, float a,
+                      float b, float *r) {
+    const __m512 va = _mm512_set1_ps(a), vb = _mm512_set1_ps(b);
+    const __m512i half = _mm512_set1_epi32(64);
+    int         i, n = 0;
+
+    for(i = 0; i + 16 <= m; i += 16) {
+        __m512i     uu = _mm512_loadu_si512(u + i);
+        __m512i     l = _mm512_srli_epi32(uu, 25);
+        __m512i     j = _mm512_or_si512(_mm512_slli_epi32(uu, 7), half);
+        __m512i     k = _mm512_i32gather_epi32(l, zk, 4);
+        __m512      x = _mm512_mul_ps(_mm512_cvtepi32_ps(j),
+                                      _mm512_i32gather_ps(l, zw, 4));
+        __mmask16   in;
+
+        if(_mm512_cmplt_epi32_mask(_mm512_abs_epi32(j), k) != 0xffff) {
+            n += zig_generic(gen, 16, u + i, a, b, r + n);
+            continue;
+        }
+        in = _mm512_cmp_ps_mask(x, va, _CMP_GE_OQ)
+            & _mm512_cmp_ps_mask(x, vb, _CMP_LE_OQ);
+        _mm512_mask_compressstoreu_ps(r + n, in, x);
+        n += __builtin_popcount(in);
+    }
+    return n + zig_generic(gen, m - i, u + i, a, b, r + n);
+}
+#endif
+
+// Plan row i of w, whose standardized bounds are a and b.
+static void plan_row(Rows * w, int i, double a, double b) {
+    RtnormPlan  p;
+
+    rtnorm_plan_init_table(&p, &rtnorm_table, a, b);
+    w->a[i] = p.a;
+    w->b[i] = p.b;
+    w->regime[i] = p.regime;
+    w->flip[i] = p.flip;
+    if(p.regime == RTNORM_CHOPIN) {
+        w->ka[i] = p.ka;
+        w->kb[i] = p.kb;
+    }
+}
+
+// Plan rows i..m-1 one at a time.
+static void plan_rows(int i, int m, const float *a, const float *b,
+                      const float *mu, const float *sigma, Rows * w) {
+    double      z, s;
+
+    for(; i < m; ++i) {
+        z = mu ? mu[i] : 0.0;
+        s = sigma ? sigma[i] : 1.0;
+        plan_row(w, i, (a[i] - z) / s, (b[i] - z) / s);
+    }
+}
+
+static void plan_generic(int m, const float *a, const float *b,
+                         const float *mu, const float *sigma, Rows * w) {
+    plan_rows(0, m, a, b, mu, sigma, w);
+}
+
+static void rows_generic(int m, const int *lo, const int *hi, const int *k,
+                         const float *u, float *r, unsigned char *ok) {
+    int         i;
+
+    for(i = 0; i < m; ++i) {
+        ok[i] = k[i] >= lo[i] && k[i] <= hi[i] && u[i] < thrf[k[i]];
+        r[i] = x0f[k[i]] + u[i] * cf[k[i]];
+    }
+}
+
+#ifdef RTNORMF_X86
+// The plan kernels follow rtnorm_plan_init_table step by step, in the
+// same double arithmetic, gathering ncell and x for the rows that use
+// the boxes. A vector holding a row with a >= b goes to plan_rows,
+// which reports the error.
+__attribute__((target("avx2")))
+static void plan_avx2(int m, const float *a, const float *b,
+                      const float *mu, const float *sigma, Rows * w) {
+    const RtnormTable *t = &rtnorm_table;
+    const __m256d invh = _mm256_set1_pd(t->INVH);
+    const __m256d xg = _mm256_set1_pd(t->xgauss), xe = _mm256_set1_pd(t->xexp);
+    const __m256d xm = _mm256_set1_pd(t->xmax), zero = _mm256_setzero_pd();
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    const __m128i i0 = _mm_set1_epi32(t->I0), nn = _mm_set1_epi32(t->N);
+    const __m128i kmin = _mm_set1_epi32(t->kmin), one = _mm_set1_epi32(1);
+    const __m256i even = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+    int         i, j, fl, gs, ex, sh;
+
+    for(i = 0; i + 4 <= m; i += 4) {
+        __m256d     lo = _mm256_cvtps_pd(_mm_loadu_ps(a + i));
+        __m256d     hi = _mm256_cvtps_pd(_mm_loadu_ps(b + i));
+        __m256d     f, na, nb, chop, xk;
+        __m128i     c32, ia, ib, ka, kb, lt, inc;
+
+        if(mu) {
+            __m256d     z = _mm256_cvtps_pd(_mm_loadu_ps(mu + i));
+            lo = _mm256_sub_pd(lo, z);
+            hi = _mm256_sub_pd(hi, z);
+        }
+        if(sigma) {
+            __m256d     s = _mm256_cvtps_pd(_mm_loadu_ps(sigma + i));
+            lo = _mm256_div_pd(lo, s);
+            hi = _mm256_div_pd(hi, s);
+        }
+        if(_mm256_movemask_pd(_mm256_cmp_pd(lo, hi, _CMP_GE_OQ))) {
+            plan_rows(i, i + 4, a, b, mu, sigma, w);
+            continue;
+        }
+
+        // Flip so that |a| <= |b|.
+        f = _mm256_cmp_pd(_mm256_andnot_pd(sign, lo),
+                          _mm256_andnot_pd(sign, hi), _CMP_GT_OQ);
+        na = _mm256_blendv_pd(lo, _mm256_xor_pd(hi, sign), f);
+        nb = _mm256_blendv_pd(hi, _mm256_xor_pd(lo, sign), f);
+
+        // Boxes of the rows between the thresholds, as 32-bit masks
+        chop = _mm256_and_pd(_mm256_cmp_pd(na, xg, _CMP_GE_OQ),
+                             _mm256_cmp_pd(na, xe, _CMP_LE_OQ));
+        c32 = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32
+                                     (_mm256_castpd_si256(chop), even));
+        ia = _mm_add_epi32(i0, _mm256_cvttpd_epi32
+                           (_mm256_floor_pd(_mm256_mul_pd(na, invh))));
+        ka = _mm_mask_i32gather_epi32(_mm_setzero_si128(), t->ncell, ia,
+                                      c32, 4);
+        ib = _mm_add_epi32(i0, _mm256_cvttpd_epi32
+                           (_mm256_floor_pd(_mm256_mul_pd(nb, invh))));
+        kb = _mm_mask_i32gather_epi32(nn, t->ncell, ib, _mm_andnot_si128
+                                      (_mm256_castsi256_si128
+                                       (_mm256_permutevar8x32_epi32
+                                        (_mm256_castpd_si256
+                                         (_mm256_cmp_pd(nb, xm, _CMP_GE_OQ)),
+                                         even)), c32), 4);
+
+        // b may lie in the box after the one holding its cell.
+        lt = _mm_and_si128(c32, _mm_cmplt_epi32(kb, nn));
+        xk = _mm256_mask_i32gather_pd(zero, t->x, _mm_add_epi32(kb, one),
+                                      _mm256_castsi256_pd
+                                      (_mm256_cvtepi32_epi64(lt)), 8);
+        inc = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32
+                                     (_mm256_castpd_si256(_mm256_cmp_pd
+                                                          (xk, nb,
+                                                           _CMP_LT_OQ)),
+                                      even));
+        kb = _mm_sub_epi32(kb, _mm_and_si128(lt, inc));
+
+        _mm256_storeu_pd(w->a + i, na);
+        _mm256_storeu_pd(w->b + i, nb);
+        _mm_storeu_si128((__m128i *) (w->ka + i), ka);
+        _mm_storeu_si128((__m128i *) (w->kb + i), kb);
+        fl = _mm256_movemask_pd(f);
+        gs = _mm256_movemask_pd(_mm256_cmp_pd(na, xg, _CMP_LT_OQ));
+        ex = _mm256_movemask_pd(_mm256_cmp_pd(na, xe, _CMP_GT_OQ));
+        sh = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32
+                                              (kmin, _mm_abs_epi32
+                                               (_mm_sub_epi32(kb, ka)))))
+            & _mm256_movemask_pd(_mm256_cmp_pd(na, zero, _CMP_NEQ_OQ));
+        for(j = 0; j < 4; ++j) {
+            w->flip[i + j] = (fl >> j) & 1;
+            w->regime[i + j] = (ex >> j) & 1 ? RTNORM_EXPONENTIAL
+                : (gs >> j) & 1 ? RTNORM_GAUSSIAN
+                : (sh >> j) & 1 ? RTNORM_EXPONENTIAL : RTNORM_CHOPIN;
+        }
+    }
+    plan_rows(i, m, a, b, mu, sigma, w);
+}
+
+__attribute__((target("avx512f")))
+static void plan_avx512(int m, const float *a, const float *b,
+                        const float *mu, const float *sigma, Rows * w) {
+    const RtnormTable *t = &rtnorm_table;
+    const __m512d invh = _mm512_set1_pd(t->INVH);
+    const __m512d xg = _mm512_set1_pd(t->xgauss), xe = _mm512_set1_pd(t->xexp);
+    const __m512d xm = _mm512_set1_pd(t->xmax), zero = _mm512_setzero_pd();
+    const __m512i sign = _mm512_set1_epi64(INT64_MIN);
+    const __m256i i0 = _mm256_set1_epi32(t->I0), nn = _mm256_set1_epi32(t->N);
+    const __m256i kmin = _mm256_set1_epi32(t->kmin);
+    int         i, j;
+
+    for(i = 0; i + 8 <= m; i += 8) {
+        __m512d     lo = _mm512_cvtps_pd(_mm256_loadu_ps(a + i));
+        __m512d     hi = _mm512_cvtps_pd(_mm256_loadu_ps(b + i));
+        __m512d     na, nb, xk;
+        __m256i     ia, ib, ka, kb;
+        __mmask8    f, chop, lt, gs, ex, sh;
+
+        if(mu) {
+            __m512d     z = _mm512_cvtps_pd(_mm256_loadu_ps(mu + i));
+            lo = _mm512_sub_pd(lo, z);
+            hi = _mm512_sub_pd(hi, z);
+        }
+        if(sigma) {
+            __m512d     s = _mm512_cvtps_pd(_mm256_loadu_ps(sigma + i));
+            lo = _mm512_div_pd(lo, s);
+            hi = _mm512_div_pd(hi, s);
+        }
+        if(_mm512_cmp_pd_mask(lo, hi, _CMP_GE_OQ)) {
+            plan_rows(i, i + 8, a, b, mu, sigma, w);
+            continue;
+        }
+
+        // Flip so that |a| <= |b|.
+        f = _mm512_cmp_pd_mask(_mm512_abs_pd(lo), _mm512_abs_pd(hi),
+                               _CMP_GT_OQ);
+        na = _mm512_mask_blend_pd(f, lo, _mm512_castsi512_pd
+                                  (_mm512_xor_si512(_mm512_castpd_si512(hi),
+                                                    sign)));
+        nb = _mm512_mask_blend_pd(f, hi, _mm512_castsi512_pd
+                                  (_mm512_xor_si512(_mm512_castpd_si512(lo),
+                                                    sign)));
+
+        // The gathers of ncell take 16 indices; only the low 8 are used.
+        chop = _mm512_cmp_pd_mask(na, xg, _CMP_GE_OQ)
+            & _mm512_cmp_pd_mask(na, xe, _CMP_LE_OQ);
+        ia = _mm256_add_epi32(i0, _mm512_cvttpd_epi32
+                              (_mm512_roundscale_pd(_mm512_mul_pd(na, invh),
+                                                    _MM_FROUND_TO_NEG_INF)));
+        ka = _mm512_castsi512_si256(_mm512_mask_i32gather_epi32
+                                    (_mm512_setzero_si512(), chop,
+                                     _mm512_castsi256_si512(ia), t->ncell,
+                                     4));
+        ib = _mm256_add_epi32(i0, _mm512_cvttpd_epi32
+                              (_mm512_roundscale_pd(_mm512_mul_pd(nb, invh),
+                                                    _MM_FROUND_TO_NEG_INF)));
+        kb = _mm512_castsi512_si256(_mm512_mask_i32gather_epi32
+                                    (_mm512_castsi256_si512(nn),
+                                     chop & ~_mm512_cmp_pd_mask(nb, xm,
+                                                                _CMP_GE_OQ),
+                                     _mm512_castsi256_si512(ib), t->ncell,
+                                     4));
+
+        // b may lie in the box after the one holding its cell.
+        lt = chop & _mm256_movemask_ps(_mm256_castsi256_ps
+                                       (_mm256_cmpgt_epi32(nn, kb)));
+        xk = _mm512_mask_i32gather_pd(zero, lt, _mm256_add_epi32
+                                      (kb, _mm256_set1_epi32(1)), t->x, 8);
+        lt &= _mm512_cmp_pd_mask(xk, nb, _CMP_LT_OQ);
+        kb = _mm512_castsi512_si256(_mm512_mask_add_epi32
+                                    (_mm512_castsi256_si512(kb), lt,
+                                     _mm512_castsi256_si512(kb),
+                                     _mm512_set1_epi32(1)));
+
+        _mm512_storeu_pd(w->a + i, na);
+        _mm512_storeu_pd(w->b + i, nb);
+        _mm256_storeu_si256((__m256i *) (w->ka + i), ka);
+        _mm256_storeu_si256((__m256i *) (w->kb + i), kb);
+        gs = _mm512_cmp_pd_mask(na, xg, _CMP_LT_OQ);
+        ex = _mm512_cmp_pd_mask(na, xe, _CMP_GT_OQ);
+        sh = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32
+                                                    (kmin, _mm256_abs_epi32
+                                                     (_mm256_sub_epi32
+                                                      (kb, ka)))))
+            & _mm512_cmp_pd_mask(na, zero, _CMP_NEQ_OQ);
+        for(j = 0; j < 8; ++j) {
+            w->flip[i + j] = (f >> j) & 1;
+            w->regime[i + j] = (ex >> j) & 1 ? RTNORM_EXPONENTIAL
+                : (gs >> j) & 1 ? RTNORM_GAUSSIAN
+                : (sh >> j) & 1 ? RTNORM_EXPONENTIAL : RTNORM_CHOPIN;
+        }
+    }
+    plan_rows(i, m, a, b, mu, sigma, w);
+}
+
+__attribute__((target("avx2")))
+static void rows_avx2(int m, const int *lo, const int *hi, const int *k,
+                      const float *u, float *r, unsigned char *ok) {
+    const __m256i one = _mm256_set1_epi32(1);
+    int         i, j, bits;
+
+    for(i = 0; i + 8 <= m; i += 8) {
+        __m256i     kk = _mm256_loadu_si256((const __m256i *) (k + i));
+        __m256i     vlo = _mm256_loadu_si256((const __m256i *) (lo + i));
+        __m256i     vhi = _mm256_loadu_si256((const __m256i *) (hi + i));
+        __m256      uu = _mm256_loadu_ps(u + i);
+        __m256i     in = _mm256_and_si256(_mm256_cmpgt_epi32
+                                          (kk, _mm256_sub_epi32(vlo, one)),
+                                          _mm256_cmpgt_epi32
+                                          (_mm256_add_epi32(vhi, one), kk));
+        __m256      thr = _mm256_i32gather_ps(thrf, kk, 4);
+        __m256      x0 = _mm256_i32gather_ps(x0f, kk, 4);
+        __m256      c = _mm256_i32gather_ps(cf, kk, 4);
+
+        bits = _mm256_movemask_ps(_mm256_and_ps(_mm256_castsi256_ps(in),
+                                                _mm256_cmp_ps(uu, thr,
+                                                              _CMP_LT_OQ)));
+        _mm256_storeu_ps(r + i, _mm256_add_ps(x0, _mm256_mul_ps(uu, c)));
+        for(j = 0; j < 8; ++j)
+            ok[i + j] = (bits >> j) & 1;
+    }
+    rows_generic(m - i, lo + i, hi + i, k + i, u + i, r + i, ok + i);
+}
+
+__attribute__((target("avx512f")))
+static void rows_avx512(int m, const int *lo, const int *hi, const int *k,
+                        const float *u, float *r, unsigned char *ok) {
+    int         i;
+
+    for(i = 0; i + 16 <= m; i += 16) {
+        __m512i     kk = _mm512_loadu_si512(k + i);
+        __m512      uu = _mm512_loadu_ps(u + i);
+        __mmask16   in = _mm512_cmpge_epi32_mask(kk, _mm512_loadu_si512(lo + i))
+            & _mm512_cmple_epi32_mask(kk, _mm512_loadu_si512(hi + i));
+        __m512      thr = _mm512_i32gather_ps(kk, thrf, 4);
+        __m512      x0 = _mm512_i32gather_ps(kk, x0f, 4);
+        __m512      c = _mm512_i32gather_ps(kk, cf, 4);
+        __mmask16   acc = _mm512_mask_cmp_ps_mask(in, uu, thr, _CMP_LT_OQ);
+
+        _mm512_storeu_ps(r + i, _mm512_add_ps(x0, _mm512_mul_ps(uu, c)));
+        _mm_storeu_si128((__m128i *) (ok + i),
+                         _mm512_cvtepi32_epi8(_mm512_maskz_set1_epi32(acc,
+                                                                      1)));
+    }
+    rows_generic(m - i, lo + i, hi + i, k + i, u + i, r + i, ok + i);
+}
+#endif
+
+// Map standardized value z back to [a,b]. Rounding to float may leave
+// the interval by an ulp, so clamp.
+static float scale(double z, float a, float b, float mu, float sigma) {
+    float       v = mu + sigma * z;
+
+    v = v < a ? a : v;
+    return v > b ? b : v;
+}
+
+const char *rtnormf_simd(void) {
+    pthread_once(&once, init);
+    return kernels[kernel].name;
+}
+
+int rtnormf_set_simd(const char *name) {
+    int         k;
+
+    pthread_once(&once, init);
+    for(k = 0; k < nkernels; ++k) {
+        if(strcmp(name, kernels[k].name) == 0 && cpu_has(name)) {
+            kernel = k;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+float rtnormf(gsl_rng * gen, float a, float b, float mu, float sigma) {
+    float       r;
+
+    rtnormf_fill(gen, a, b, mu, sigma, 1, &r);
+    return r;
+}
+
+void rtnormf_fill(gsl_rng * gen, float a, float b, float mu, float sigma,
+                  size_t n, float *out) {
+    const RtnormTable *t = &rtnorm_table;
+    RtnormPlan  p;
+    int         k[BLOCK], lo, hi, nk, m, j;
+    float       u[BLOCK], r[BLOCK + 16], za, zb;
+    uint32_t    zu[BLOCK];
+    unsigned char ok[BLOCK];
+    double      z, du[2 * BLOCK];
+    size_t      i = 0;
+
+    pthread_once(&once, init);
+    rtnorm_plan_init(&p, (a - (double) mu) / sigma,
+                     (b - (double) mu) / sigma);
+    rtnorm_plan_note(&p, n);
+
+    if(p.regime == RTNORM_GAUSSIAN) {
+        // Round the bounds inward, so that a float lies in [za,zb]
+        // exactly when it lies in [p.a,p.b].
+        za = p.a;
+        if(za < p.a)
+            za = nextafterf(za, INFINITY);
+        zb = p.b;
+        if(zb > p.b)
+            zb = nextafterf(zb, -INFINITY);
+        while(i < n) {
+            m = n - i < BLOCK ? n - i : BLOCK;
+            rtnorm_rng_uniform_fill(gen, m, du);
+            for(j = 0; j < m; ++j)
+                zu[j] = du[j] * 4294967296.0;
+            m = kernels[kernel].zig(gen, m, zu, za, zb, r);
+            for(j = 0; j < m && i < n; ++j)
+                out[i++] = scale(p.flip ? -r[j] : r[j], a, b, mu, sigma);
+        }
+        return;
+    }
+
+    if(p.regime != RTNORM_CHOPIN) {
+        for(i = 0; i < n; ++i)
+            out[i] = scale(rtnorm_plan_draw(&p, gen), a, b, mu, sigma);
+        return;
+    }
+
+    nk = p.kb - p.ka + 1;
+    lo = p.ka + 2;
+    hi = p.b < t->xmax ? p.kb - 2 : t->N - 1;
+    while(i < n) {
+        // Draw a block of candidates, no more than the values still
+        // needed, and let the kernel settle most of them.
+        m = n - i < BLOCK ? n - i : BLOCK;
+        rtnorm_rng_uniform_fill(gen, 2 * m, du);
+        for(j = 0; j < m; ++j) {
+            k[j] = floor(du[2 * j] * nk) + p.ka;
+            u[j] = du[2 * j + 1];
+            if(u[j] >= 1.0f)    // rounded up from below 1
+                u[j] = nextafterf(1.0f, 0.0f);
+        }
+        kernels[kernel].fn(lo, hi, m, k, u, r, ok);
+
+        for(j = 0; j < m; ++j) {
+            if(ok[j])
+                z = r[j];
+            else if(!rtnorm_plan_step(&p, gen, k[j], u[j], &z))
+                continue;       // rejected
+            out[i++] = scale(p.flip ? -z : z, a, b, mu, sigma);
+        }
+    }
+}
+
+// A plan for row j of w, good for rtnorm_plan_step and rtnorm_plan_note.
+static void row_plan(const Rows * w, int j, RtnormPlan * p) {
+    p->regime = w->regime[j];
+    p->flip = w->flip[j];
+    p->a = w->a[j];
+    p->b = w->b[j];
+    p->ka = w->ka[j];
+    p->kb = w->kb[j];
+}
+
+void rtnormf_fill_rows(gsl_rng * gen, size_t n, const float *a,
+                       const float *b, const float *mu, const float *sigma,
+                       float *out) {
+    const RtnormTable *t = &rtnorm_table;
+    Rows        w;
+    RtnormPlan  p;
+    int         lane[LANES], lo[LANES], hi[LANES], k[LANES];
+    int         m, nl, next, q, keep, j;
+    float       u[LANES], r[LANES];
+    unsigned char ok[LANES];
+    double      z, du[2 * LANES];
+    size_t      i0, i;
+
+    pthread_once(&once, init);
+    for(i0 = 0; i0 < n; i0 += m) {
+        m = n - i0 < BLOCK ? n - i0 : BLOCK;
+        kernels[kernel].plan(m, a + i0, b + i0, mu ? mu + i0 : NULL,
+                             sigma ? sigma + i0 : NULL, &w);
+
+        // Keep up to LANES rows of the block in flight, each with a
+        // candidate per round. A row leaves when its candidate is
+        // accepted, and the next row of the block takes its lane.
+        next = nl = 0;
+        for(;;) {
+            while(nl < LANES && next < m) {
+                j = next++;
+                row_plan(&w, j, &p);
+                if(p.regime == RTNORM_CHOPIN) {
+                    rtnorm_plan_note(&p, 1);
+                    lane[nl++] = j;
+                    continue;
+                }
+
+                // The tails are drawn at once, as rtnormf_fill would.
+                rtnorm_plan_init(&p, w.a[j], w.b[j]);
+                rtnorm_plan_note(&p, 1);
+                z = rtnorm_plan_draw(&p, gen);
+                i = i0 + j;
+                out[i] = scale(w.flip[j] ? -z : z, a[i], b[i],
+                               mu ? mu[i] : 0.0f, sigma ? sigma[i] : 1.0f);
+            }
+            if(nl == 0)
+                break;
+
+            rtnorm_rng_uniform_fill(gen, 2 * nl, du);
+            for(q = 0; q < nl; ++q) {
+                j = lane[q];
+                k[q] = floor(du[2 * q] * (w.kb[j] - w.ka[j] + 1)) + w.ka[j];
+                u[q] = du[2 * q + 1];
+                if(u[q] >= 1.0f)        // rounded up from below 1
+                    u[q] = nextafterf(1.0f, 0.0f);
+                lo[q] = w.ka[j] + 2;
+                hi[q] = w.b[j] < t->xmax ? w.kb[j] - 2 : t->N - 1;
+            }
+            kernels[kernel].rows(nl, lo, hi, k, u, r, ok);
+
+            for(q = keep = 0; q < nl; ++q) {
+                j = lane[q];
+                if(ok[q])
+                    z = r[q];
+                else {
+                    row_plan(&w, j, &p);
+                    if(!rtnorm_plan_step(&p, gen, k[q], u[q], &z)) {
+                        lane[keep++] = j;       // rejected: try again
+                        continue;
+                    }
+                }
+                i = i0 + j;
+                out[i] = scale(w.flip[j] ? -z : z, a[i], b[i],
+                               mu ? mu[i] : 0.0f, sigma ? sigma[i] : 1.0f);
+            }
+            nl = keep;
+        }
+    }
+}
@@ -0,0 +1,74 @@
+//  Single-precision pseudorandom numbers from a truncated Gaussian
+//  distribution.
+//
+//  rtnormf_fill runs the inner boxes of Chopin's algorithm, which
+//  produce nearly all values, in single precision: each pass draws a
+//  block of candidate boxes and uniforms, and a vector kernel tests
+//  and transforms 8 (AVX2) or 16 (AVX-512) of them at a time, using
+//  float copies of the tables. The kernel is chosen at run time from
+//  what the CPU supports. Candidates the kernel cannot accept -- edge
+//  boxes, the right tail, and the thin strip above the lower height
+//  of a box -- are finished by the double-precision code of rtnorm, as
+//  are intervals in the right tail. Wide intervals, which rtnorm
+//  samples by drawing whole Gaussians until one lands in [a,b], get a
+//  vector ziggurat instead: a kernel turns a block of uniforms into
+//  Gaussian candidates, masks those outside [a,b], and packs the rest
+//  in order, leaving the 1% of candidates outside the rectangles of
+//  the ziggurat to scalar code.
+//
+//  Accuracy. Output is a float, rounded from a value computed in
+//  double, and always lies in [a,b]. Within the tables, a value is
+//  x[k] + u*c[k] in float, so its relative error is a few units of
+//  2^-24, and the uniform u carries 24 bits: positions within a box
+//  are resolved to about 2^-24 of its width. Outside the tables, in
+//  the tails, values come from rtnorm and lose only the final
+//  rounding. What float cannot represent is the spread of a far tail:
+//  beyond a standardized bound a, the distribution has scale about
+//  1/a, while floats near a*sigma+mu are spaced about 2^-24 apart
+//  relative to it. Past a few hundred standard deviations the output
+//  takes only a handful of distinct values, and past about 4000
+//  (a*a > 2^24) nearly every value is the float nearest a. Likewise,
+//  when |mu| is much larger than sigma, the float spacing near mu
+//  coarsens the output; use rtnorm when either matters.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __RTNORMF_H
+#define __RTNORMF_H
+
+#include <stddef.h>
+#include <gsl/gsl_rng.h>
+
+// One draw from the Gaussian with mean mu and standard deviation
+// sigma, truncated to [a,b]. Same as rtnormf_fill with n = 1.
+float       rtnormf(gsl_rng *gen, float a, float b, float mu, float sigma);
+
+// Fill out[0..n-1] with draws from the same distribution. Random
+// numbers are consumed in blocks, so the output differs from that of
+// n calls to rtnormf. Blocks of uniforms come from
+// rtnorm_rng_uniform_fill, which is fastest with xoshiro256+x8 (see
+// xoshiro.h).
+void        rtnormf_fill(gsl_rng *gen, float a, float b, float mu,
+                         float sigma, size_t n, float *out);
+
+// Fill out[i], for i in 0..n-1, with a draw from the Gaussian with
+// mean mu[i] and standard deviation sigma[i], truncated to
+// [a[i],b[i]]. mu or sigma may be NULL for all 0 or all 1. Rows are
+// planned in blocks by a vector kernel, and up to 16 rows that use
+// Chopin's boxes are drawn side by side, each lane with its own boxes;
+// rows in the tails are drawn one at a time.
+void        rtnormf_fill_rows(gsl_rng *gen, size_t n, const float *a,
+                              const float *b, const float *mu,
+                              const float *sigma, float *out);
+
+// Name of the vector kernel in use: "avx512", "avx2" or "generic".
+const char *rtnormf_simd(void);
+
+// Use the named kernel. Return 1 on success, 0 if the CPU lacks it.
+// Kernels may differ in the last bit of a float, because the compiler
+// may fuse a multiply and an add in some of them. Not safe while
+// other threads sample.
+int         rtnormf_set_simd(const char *name);
+
+#endif //__RTNORMF_H
@@ -0,0 +1,239 @@
+//  rtnormgen: write pseudorandom numbers from a truncated Gaussian
+//  distribution to a binary file.
+//
+//  Values are generated in parallel, in chunks of RTNORM_CHUNK, and
+//  written as raw little-endian doubles or floats, as a NumPy .npy
+//  file, or as a sample bank (see bank.h). Output to a named file goes
+//  through a shared memory map, so that threads write their chunks in
+//  place. Output to stdout goes
+//  through a large buffer, which is filled in parallel and then
+//  written with a single call to write. In either case, the output
+//  depends only on the seed and not on the number of threads.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+//
+//  Depends: LibGSL
+//  OS: Unix based system
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtnorm_impl.h"
+#include "chunks.h"
+#include "binio.h"
+#include "bank.h"
+
+// Values generated per call to rtnorm_fill_cached
+#define BLOCK 1024
+
+// Chunks per thread in each buffer written to stdout
+#define CHUNKS_PER_THREAD 4
+
+enum { F64, F32, NPY64, NPY32, BANK };
+
+// Parameters shared by the threads
+typedef struct Gen {
+    double      a, b, mu, sigma;
+    size_t      n;              // total number of values
+    size_t      elsize;         // bytes per value: 8 or 4
+    int         stream;         // write with non-temporal stores
+    long        c0;             // first chunk held in dst
+    char       *dst;            // where chunk c0 begins
+} Gen;
+
+static void usage(void);
+static void fill_chunk(gsl_rng * rng, long chunk, void *arg);
+
+static void usage(void) {
+    fprintf(stderr, "usage: rtnormgen [options] -a <lo> -b <hi> -n <count>\n");
+    fprintf(stderr, "  where options may include:\n");
+    fprintf(stderr, "  -m <x>     mean of the untruncated Gaussian (default 0)\n");
+    fprintf(stderr, "  -s <x>     its standard deviation (default 1)\n");
+    fprintf(stderr, "  -S <seed>  random number seed (default: current time)\n");
+    fprintf(stderr, "  -t <n>     number of threads (default 1)\n");
+    fprintf(stderr, "  -f <fmt>   f64, f32, npy, npy32 or bank (default f64)\n");
+    fprintf(stderr, "  -g <name>  GSL generator, xoshiro256+ or"
+            " xoshiro256+x8 (default taus)\n");
+    fprintf(stderr, "  -o <file>  output file (default stdout)\n");
+    exit(1);
+}
+
+// Generate chunk number "chunk" into its place in g->dst. If g->stream
+// is set, each block is drawn and converted in L1 and then copied out
+// with non-temporal stores, so that output far larger than the cache
+// does not evict the tables.
+static void fill_chunk(gsl_rng * rng, long chunk, void *arg) {
+    const Gen  *g = arg;
+    size_t      i = (size_t) chunk * RTNORM_CHUNK;
+    size_t      end = i + RTNORM_CHUNK;
+    char       *dst = g->dst + (size_t) (chunk - g->c0) * RTNORM_CHUNK
+        * g->elsize;
+    double      buf[BLOCK];
+    float       fbuf[BLOCK];
+    size_t      j, m;
+
+    if(end > g->n)
+        end = g->n;
+
+    for(; i < end; i += m) {
+        m = end - i;
+        if(m > BLOCK)
+            m = BLOCK;
+        if(g->elsize == sizeof(double)) {
+            double     *d = g->stream ? buf : (double *) dst;
+            rtnorm_fill_cached(rng, g->a, g->b, g->mu, g->sigma, m, d);
+            binio_le64(d, m);
+            if(g->stream)
+                rtnorm_stream_copy(dst, d, m * sizeof(double));
+        } else {
+            float      *f = g->stream ? fbuf : (float *) dst;
+            rtnorm_fill_cached(rng, g->a, g->b, g->mu, g->sigma, m, buf);
+            for(j = 0; j < m; ++j)
+                f[j] = buf[j];
+            binio_le32(f, m);
+            if(g->stream)
+                rtnorm_stream_copy(dst, f, m * sizeof(float));
+        }
+        dst += m * g->elsize;
+    }
+}
+
+int main(int argc, char **argv) {
+    Gen         g = {.mu = 0.0, .sigma = 1.0 };
+    int         gota = 0, gotb = 0, gotn = 0, fmt = F64, nthreads = 1;
+    unsigned long seed = (unsigned long) time(NULL);
+    const char *outname = NULL;
+    const gsl_rng_type *T = gsl_rng_taus;
+    char        hdr[NPY_HEADER_SIZE];
+    size_t      hdrsize = 0;
+    long        nchunks, c, w;
+    int         i;
+
+    while((i = getopt(argc, argv, "a:b:m:s:n:S:t:f:g:o:h")) != -1) {
+        switch (i) {
+        case 'a':
+            g.a = strtod(optarg, NULL);
+            gota = 1;
+            break;
+        case 'b':
+            g.b = strtod(optarg, NULL);
+            gotb = 1;
+            break;
+        case 'm':
+            g.mu = strtod(optarg, NULL);
+            break;
+        case 's':
+            g.sigma = strtod(optarg, NULL);
+            break;
+        case 'n':
+            g.n = strtoull(optarg, NULL, 10);
+            gotn = 1;
+            break;
+        case 'S':
+            seed = strtoul(optarg, NULL, 10);
+            break;
+        case 't':
+            nthreads = atoi(optarg);
+            break;
+        case 'f':
+            if(strcmp(optarg, "f64") == 0)
+                fmt = F64;
+            else if(strcmp(optarg, "f32") == 0)
+                fmt = F32;
+            else if(strcmp(optarg, "npy") == 0)
+                fmt = NPY64;
+            else if(strcmp(optarg, "npy32") == 0)
+                fmt = NPY32;
+            else if(strcmp(optarg, "bank") == 0)
+                fmt = BANK;
+            else {
+                fprintf(stderr, "Unknown format: %s\n", optarg);
+                usage();
+            }
+            break;
+        case 'g':
+            T = chunks_rng_type(optarg);
+            if(T == NULL) {
+                fprintf(stderr, "Unknown generator: %s\n", optarg);
+                usage();
+            }
+            break;
+        case 'o':
+            outname = optarg;
+            break;
+        default:
+            usage();
+        }
+    }
+    if(optind != argc || !gota || !gotb || !gotn)
+        usage();
+    if(!(g.a < g.b) || !(g.sigma > 0) || nthreads < 1) {
+        fprintf(stderr, "Need a < b, sigma > 0, and at least 1 thread\n");
+        usage();
+    }
+
+    if(fmt == BANK) {
+        if(outname == NULL) {
+            fprintf(stderr, "Format bank requires -o\n");
+            usage();
+        }
+        bank_write(outname, g.a, g.b, g.mu, g.sigma, T, seed, g.n,
+                   nthreads);
+        return 0;
+    }
+
+    g.elsize = (fmt == F64 || fmt == NPY64) ? sizeof(double) : sizeof(float);
+
+    // Whether to stream depends on the whole output, not on the blocks
+    // it is drawn in, which are far below any useful threshold.
+    g.stream = g.n * g.elsize >= rtnorm_stream_threshold();
+
+    if(fmt == NPY64 || fmt == NPY32)
+        hdrsize = npy_header(hdr, fmt == NPY64 ? "<f8" : "<f4", g.n);
+    nchunks = (g.n + RTNORM_CHUNK - 1) / RTNORM_CHUNK;
+
+    if(outname != NULL) {
+        // Threads write directly into the mapped file.
+        size_t      size = hdrsize + g.n * g.elsize;
+        char       *map = binio_map_out(outname, size);
+
+        memcpy(map, hdr, hdrsize);
+        g.c0 = 0;
+        g.dst = map + hdrsize;
+        chunks_run(T, seed, 0, nchunks, nthreads, fill_chunk, &g);
+        binio_unmap(map, size);
+    } else {
+        // Threads fill a window of chunks, which is then written.
+        long        window = (long) nthreads * CHUNKS_PER_THREAD;
+        char       *buf = malloc(window * RTNORM_CHUNK * g.elsize);
+
+        if(buf == NULL) {
+            fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+            exit(1);
+        }
+        binio_write(STDOUT_FILENO, hdr, hdrsize);
+        g.dst = buf;
+        for(c = 0; c < nchunks; c += w) {
+            size_t      end;
+
+            w = nchunks - c < window ? nchunks - c : window;
+            end = (size_t) (c + w) * RTNORM_CHUNK;
+            if(end > g.n)
+                end = g.n;
+            g.c0 = c;
+            chunks_run(T, seed, c, w, nthreads, fill_chunk, &g);
+            binio_write(STDOUT_FILENO, buf,
+                        (end - (size_t) c * RTNORM_CHUNK) * g.elsize);
+        }
+        free(buf);
+    }
+
+    return 0;
+}
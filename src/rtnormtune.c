@@ -0,0 +1,398 @@
+//  rtnormtune: choose the regime thresholds of rtnorm for this host.
+//
+//  The thresholds in rtnorm_config.h decide which algorithm samples
+//  each interval. Where one algorithm overtakes another depends on
+//  what a uniform, a log and a Gaussian draw cost on a given machine.
+//  rtnormtune times these, predicts the cost of a workload under each
+//  set of thresholds with the model in design.h, and picks the
+//  cheapest. It then checks the tuned sampler, by Kolmogorov-Smirnov
+//  tests on the intervals that change algorithm, and times it against
+//  the current thresholds. It writes a new rtnorm_config.h only if the
+//  checks pass, and keeps the current thresholds unless the tuned
+//  ones are faster.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+//
+//  Depends: LibGSL
+//  OS: Unix based system
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_sf_erf.h>
+
+#include "rtnorm.h"
+#include "chunks.h"
+#include "design.h"
+
+// Critical value of the Kolmogorov-Smirnov statistic, scaled by
+// sqrt(n), at significance level 0.001
+#define KS_CRIT 1.949
+
+// Most intervals checked by KS tests
+#define MAXCHECK 12
+
+// Timed loops add their values here, so that they are not optimized
+// away.
+static volatile double sink;
+
+static void usage(void);
+static double now(void);
+static void measure(gsl_rng * rng, DesignWeights * wt, int verbose);
+static void synthetic(Workload * w);
+static double Q(double x);
+static double cdf(double x, double a, double b);
+static int  cmpdbl(const void *x, const void *y);
+static double ks(const RtnormTable * t, gsl_rng * rng, double a, double b,
+                 double *v, size_t n);
+static double timing(const RtnormTable * t, gsl_rng * rng,
+                     const Workload * w, size_t n);
+static void write_config(FILE * fp, const RtnormTable * t);
+
+static void usage(void) {
+    fprintf(stderr, "usage: rtnormtune [options]\n");
+    fprintf(stderr, "  where options may include:\n");
+    fprintf(stderr, "  -o <file>  write thresholds to file,"
+            " to replace rtnorm_config.h\n");
+    fprintf(stderr, "  -w <file>  tune for a histogram saved by"
+            " record_save (default:\n");
+    fprintf(stderr, "             a grid of intervals)\n");
+    fprintf(stderr, "  -g <name>  GSL generator, xoshiro256+ or"
+            " xoshiro256+x8 (default taus)\n");
+    fprintf(stderr, "  -n <n>     draws per check, and tenths of draws"
+            " timed (default\n");
+    fprintf(stderr, "             200000)\n");
+    fprintf(stderr, "  -v         verbose\n");
+    exit(1);
+}
+
+// Seconds on a monotonic clock
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+// Time a uniform, a log and a Gaussian draw, in ns. The rest of an
+// iteration in each regime is what planned draws from an interval
+// sampled that way cost beyond the calls counted by design_cost; it
+// costs more in Chopin's algorithm, which reads the tables, than in
+// the others.
+static void measure(gsl_rng * rng, DesignWeights * wt, int verbose) {
+    const long  n = 4000000;
+    double      t0, s = 0.0, u[1024];
+    RtnormCost  c;
+    Design     *d = design_shipped();
+    RtnormPlan  p;
+    long        i;
+    int         j;
+    struct {
+        double      a, b;
+    } iv[3] = {{-1.0, 1.0}, {4.0, 6.0}, {-3.0, 3.0}};
+
+    t0 = now();
+    for(i = 0; i < n; ++i)
+        s += gsl_rng_uniform(rng);
+    wt->uniform = 1e9 * (now() - t0) / n;
+
+    for(i = 0; i < 1024; ++i)
+        u[i] = gsl_rng_uniform_pos(rng);
+    t0 = now();
+    for(i = 0; i < n; ++i)
+        s += log(u[i & 1023] + s * 1e-300);
+    wt->log = 1e9 * (now() - t0) / n;
+
+    t0 = now();
+    for(i = 0; i < n; ++i)
+        s += gsl_ran_gaussian_ziggurat(rng, 1.0);
+    wt->normal = 1e9 * (now() - t0) / n;
+
+    for(j = 0; j < 3; ++j) {
+        design_cost(d, iv[j].a, iv[j].b, &c);
+        rtnorm_plan_init_table(&p, &d->t, iv[j].a, iv[j].b);
+        t0 = now();
+        for(i = 0; i < n; ++i)
+            s += rtnorm_plan_draw(&p, rng);
+        wt->iter[c.regime] = (1e9 * (now() - t0) / n
+                              - c.uniforms * wt->uniform - c.logs * wt->log
+                              - c.normals * wt->normal) / c.iters;
+        if(wt->iter[c.regime] < 0.0)
+            wt->iter[c.regime] = 0.0;
+    }
+    design_free(d);
+
+    sink += s;
+    if(verbose)
+        printf("%-14s uniform %.2f log %.2f normal %.2f iteration %.2f"
+               " %.2f %.2f ns\n", "costs", wt->uniform, wt->log,
+               wt->normal, wt->iter[RTNORM_CHOPIN],
+               wt->iter[RTNORM_EXPONENTIAL], wt->iter[RTNORM_GAUSSIAN]);
+}
+
+// Intervals starting every 1/8 over [-4,5], of widths from 0.001 to
+// infinity, all weighted alike
+static void synthetic(Workload * w) {
+    static const double width[] = { 0.001, 0.01, 0.1, 1.0, INFINITY };
+    const int   nw = sizeof(width) / sizeof(width[0]), na = 73;
+    int         i, j;
+
+    w->n = na * nw;
+    w->a = malloc(w->n * sizeof(double));
+    w->b = malloc(w->n * sizeof(double));
+    w->count = malloc(w->n * sizeof(double));
+    if(w->a == NULL || w->b == NULL || w->count == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    for(i = 0; i < na; ++i) {
+        for(j = 0; j < nw; ++j) {
+            w->a[i * nw + j] = -4.0 + i / 8.0;
+            w->b[i * nw + j] = w->a[i * nw + j] + width[j];
+            w->count[i * nw + j] = 1.0;
+        }
+    }
+    w->total = w->n;
+}
+
+// Upper tail probability of the standard Gaussian
+static double Q(double x) {
+    return 0.5 * gsl_sf_erfc(x * M_SQRT1_2);
+}
+
+// Distribution function at x of the standard Gaussian truncated to
+// [a,b], computed from the nearer tail
+static double cdf(double x, double a, double b) {
+    if(a >= 0.0)
+        return (Q(a) - Q(x)) / (Q(a) - Q(b));
+    return (Q(-x) - Q(-a)) / (Q(-b) - Q(-a));
+}
+
+static int cmpdbl(const void *x, const void *y) {
+    double      u = *(const double *) x, v = *(const double *) y;
+
+    return (u > v) - (u < v);
+}
+
+// Scaled KS statistic of n draws from [a,b] with thresholds t
+static double ks(const RtnormTable * t, gsl_rng * rng, double a, double b,
+                 double *v, size_t n) {
+    RtnormPlan  p;
+    double      d = 0.0, f;
+    size_t      i;
+
+    rtnorm_plan_init_table(&p, t, a, b);
+    for(i = 0; i < n; ++i)
+        v[i] = rtnorm_plan_draw(&p, rng);
+    qsort(v, n, sizeof(double), cmpdbl);
+    for(i = 0; i < n; ++i) {
+        if(!(a <= v[i] && v[i] <= b))
+            return INFINITY;
+        f = cdf(v[i], a, b);
+        d = fmax(d, fmax(f - (double) i / n, (double) (i + 1) / n - f));
+    }
+    return d * sqrt((double) n);
+}
+
+// Seconds to draw about n values from workload w with thresholds t
+static double timing(const RtnormTable * t, gsl_rng * rng,
+                     const Workload * w, size_t n) {
+    RtnormPlan  p;
+    double      t0, s = 0.0;
+    size_t      i, j, m;
+
+    t0 = now();
+    for(i = 0; i < w->n; ++i) {
+        m = (size_t) (n * w->count[i] / w->total + 0.5);
+        rtnorm_plan_init_table(&p, t, w->a[i], w->b[i]);
+        for(j = 0; j < m; ++j)
+            s += rtnorm_plan_draw(&p, rng);
+    }
+    sink += s;
+    return now() - t0;
+}
+
+static void write_config(FILE * fp, const RtnormTable * t) {
+    fprintf(fp, "// Regime thresholds of rtnorm\n"
+            "//\n"
+            "// Written by rtnormtune. Built with these thresholds,"
+            " rtnorm_table_version\n"
+            "// is %016llx; samples drawn with other thresholds"
+            " carry other\n"
+            "// versions. See the rtnorm_config.h in the source"
+            " distribution.\n", rtnorm_table_hash(t));
+    fprintf(fp, "#define RTNORM_CFG_KMIN  %d\n", t->kmin);
+    fprintf(fp, "#define RTNORM_CFG_XMIN  %.17g\n", t->xgauss);
+    fprintf(fp, "#define RTNORM_CFG_XMAX  %.17g\n", t->xexp);
+}
+
+int main(int argc, char **argv) {
+    const gsl_rng_type *T = gsl_rng_taus;
+    const char *out = NULL, *hist = NULL;
+    DesignWeights wt;
+    Workload    w;
+    Design     *d;
+    RtnormTable cur = rtnorm_table, *best;
+    gsl_rng    *rng;
+    FILE       *fp;
+    size_t      n = 200000, i, j, ncheck = 0, check[MAXCHECK];
+    double      c, cbest, ccur, x, tcur, tbest, stat;
+    int         opt, k, round, verbose = 0, status = 0;
+    double     *v;
+
+    while((opt = getopt(argc, argv, "o:w:g:n:vh")) != -1) {
+        switch (opt) {
+        case 'o':
+            out = optarg;
+            break;
+        case 'w':
+            hist = optarg;
+            break;
+        case 'g':
+            T = chunks_rng_type(optarg);
+            if(T == NULL) {
+                fprintf(stderr, "Unknown generator: %s\n", optarg);
+                usage();
+            }
+            break;
+        case 'n':
+            n = strtoul(optarg, NULL, 10);
+            break;
+        case 'v':
+            verbose = 1;
+            break;
+        default:
+            usage();
+        }
+    }
+    if(optind != argc || n < 1000)
+        usage();
+
+    if(hist != NULL) {
+        if(design_workload_load(&w, hist) != 0)
+            return 1;
+    } else
+        synthetic(&w);
+
+    rng = gsl_rng_alloc(T);
+    v = malloc(n * sizeof(double));
+    if(rng == NULL || v == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    gsl_rng_set(rng, 1);
+    measure(rng, &wt, verbose);
+
+    // Coordinate descent: each threshold in turn, holding the others.
+    // xexp may only fall below the end of the boxes and xgauss only
+    // rise above their start.
+    d = design_shipped();
+    best = &d->t;
+    ccur = cbest = design_workload_cost(d, &w, &wt);
+    for(round = 0; round < 3; ++round) {
+        for(x = 0.25; x <= cur.xmax; x = fmin(x + 0.0625, cur.xmax)) {
+            double      old = best->xexp;
+
+            best->xexp = x;
+            c = design_workload_cost(d, &w, &wt);
+            if(c < cbest)
+                cbest = c;
+            else
+                best->xexp = old;
+            if(x == cur.xmax)
+                break;
+        }
+        for(x = cur.xmin; x <= 0.0; x = fmin(x + 0.0625, 0.0)) {
+            double      old = best->xgauss;
+
+            best->xgauss = x;
+            c = design_workload_cost(d, &w, &wt);
+            if(c < cbest)
+                cbest = c;
+            else
+                best->xgauss = old;
+            if(x == 0.0)
+                break;
+        }
+        for(k = 0; k <= 32; ++k) {
+            int         old = best->kmin;
+
+            best->kmin = k;
+            c = design_workload_cost(d, &w, &wt);
+            if(c < cbest)
+                cbest = c;
+            else
+                best->kmin = old;
+        }
+    }
+    printf("%-14s kmin %2d xmin %9.5f xmax %8.5f, predicted %.2f ns\n",
+           "current", cur.kmin, cur.xgauss, cur.xexp, ccur);
+    printf("%-14s kmin %2d xmin %9.5f xmax %8.5f, predicted %.2f ns\n",
+           "tuned", best->kmin, best->xgauss, best->xexp, cbest);
+
+    // Check the heaviest intervals whose algorithm changes.
+    for(i = 0; i < w.n; ++i) {
+        RtnormPlan  p, q;
+
+        rtnorm_plan_init_table(&p, &cur, w.a[i], w.b[i]);
+        rtnorm_plan_init_table(&q, best, w.a[i], w.b[i]);
+        if(p.regime == q.regime)
+            continue;
+        if(ncheck < MAXCHECK)
+            ++ncheck;
+        else if(w.count[i] <= w.count[check[MAXCHECK - 1]])
+            continue;
+        for(j = ncheck - 1; j > 0 && w.count[check[j - 1]] < w.count[i]; --j)
+            check[j] = check[j - 1];
+        check[j] = i;
+    }
+    for(j = 0; j < ncheck; ++j) {
+        i = check[j];
+        stat = ks(best, rng, w.a[i], w.b[i], v, n);
+        if(verbose || stat >= KS_CRIT)
+            printf("%-14s [%g, %g]: KS %.3f%s\n", "check", w.a[i], w.b[i],
+                   stat, stat < KS_CRIT ? "" : " FAILED");
+        if(stat >= KS_CRIT)
+            status = 1;
+    }
+    printf("%-14s %zu intervals change algorithm%s\n", "checked", ncheck,
+           status ? ", and some FAILED" : "");
+
+    // Best of three, to damp out interruptions
+    tcur = tbest = INFINITY;
+    for(k = 0; k < 3; ++k) {
+        tcur = fmin(tcur, timing(&cur, rng, &w, 10 * n));
+        tbest = fmin(tbest, timing(best, rng, &w, 10 * n));
+    }
+    printf("%-14s predicted %.3f, measured %.3f\n", "speedup",
+           ccur / cbest, tcur / tbest);
+
+    // The model may be wrong on this host; trust the clock.
+    if(tbest >= tcur) {
+        printf("%-14s tuned thresholds are no faster; keeping current\n",
+               "result");
+        best = &cur;
+    }
+
+    if(status == 0 && out != NULL) {
+        fp = fopen(out, "w");
+        if(fp == NULL) {
+            fprintf(stderr, "can't write %s\n", out);
+            return 1;
+        }
+        write_config(fp, best);
+        fclose(fp);
+    } else if(status == 0 && verbose)
+        write_config(stdout, best);
+
+    design_free(d);
+    gsl_rng_free(rng);
+    free(v);
+    design_workload_free(&w);
+    return status;
+}
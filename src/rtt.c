@@ -0,0 +1,216 @@
+//  Pseudorandom numbers from a truncated Student t distribution.
+//  See rtt.h.
+//
+//  Let x = a*sqrt(v) and y = b*sqrt(v), and let Q be the upper tail
+//  probability of the standard Gaussian. After reflecting so that
+//  |a| <= |b|, q(v) = P(x < Z < y) is bounded by
+//
+//    PLAIN:  q <= 1,
+//    TAIL:   q <= Q(x) <= exp(-x*x/2)/2,               if a >= 0,
+//    NARROW: q <= (y-x) * phi(max(x,0)),
+//
+//  where phi is the standard Gaussian density. Multiplying each bound
+//  by the Gamma(nu/2, rate nu/2) density gives another gamma density,
+//  with shape s and rate r, times a constant M. A proposal v from
+//  Gamma(s, r) is accepted with probability q(v)/bound(v), and the
+//  overall acceptance rate is P(a < T < b)/M. We use the envelope with
+//  the smallest M.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+#include <gsl/gsl_sf_erf.h>
+#include <gsl/gsl_cdf.h>
+
+#include "rtnorm.h"
+#include "rtnorm_impl.h"
+#include "rtt.h"
+
+// Rows per call to rtnorm_fill_rows
+#define BLOCK 256
+
+enum { PLAIN, TAIL, NARROW, WHOLE };
+
+typedef struct TPlan {
+    double      a, b;           // standardized bounds, after reflection
+    int         flip;           // if true, negate the result
+    int         env;            // PLAIN, TAIL, NARROW, or WHOLE
+    double      shape, rate;    // gamma proposal for V
+    double      logM;           // log of envelope constant
+} TPlan;
+
+static double log_q(double x, double y);
+static void tplan_init(TPlan * p, double a, double b, double nu);
+static double draw_v(const TPlan * p, gsl_rng * gen);
+
+// log P(x < Z < y), for x < y and |x| <= |y|.
+static double log_q(double x, double y) {
+    double      lx;
+
+    if(x >= 0.0) {
+        lx = rtnorm_log_upper(x);
+        return lx + log(-expm1(rtnorm_log_upper(y) - lx));
+    }
+    // Interval straddles 0; erf is accurate for narrow intervals.
+    return log(0.5 * (gsl_sf_erf(-x * M_SQRT1_2) + gsl_sf_erf(y * M_SQRT1_2)));
+}
+
+static void tplan_init(TPlan * p, double a, double b, double nu) {
+    double      logM, h, a2;
+
+    if(!(a < b) || !(nu >= RTT_NU_MIN)) {
+        fprintf(stderr, "%s:%d: need a < b and nu >= %g\n",
+                __FILE__, __LINE__, RTT_NU_MIN);
+        exit(1);
+    }
+    p->flip = fabs(a) > fabs(b);
+    if(p->flip) {
+        double      tmp = a;
+        a = -b;
+        b = -tmp;
+    }
+    p->a = a;
+    p->b = b;
+
+    h = 0.5 * nu;
+    p->env = PLAIN;
+    p->shape = h;
+    p->rate = h;
+    p->logM = 0.0;
+
+    // No truncation: every proposal is accepted.
+    if(isinf(a) && isinf(b)) {
+        p->env = WHOLE;
+        return;
+    }
+
+    // a2 = max(a,0)^2 appears in both the TAIL and NARROW bounds.
+    a2 = a > 0.0 ? a * a : 0.0;
+
+    if(a >= 0.0) {
+        logM = -M_LN2 + h * log(nu / (nu + a2));
+        if(logM < p->logM) {
+            p->env = TAIL;
+            p->shape = h;
+            p->rate = 0.5 * (nu + a2);
+            p->logM = logM;
+        }
+    }
+    if(isfinite(b - a)) {
+        logM = log(b - a) - 0.5 * log(2 * M_PI)
+            + h * log(h) - lgamma(h) + lgamma(h + 0.5)
+            - (h + 0.5) * log(0.5 * (nu + a2));
+        if(logM < p->logM) {
+            p->env = NARROW;
+            p->shape = h + 0.5;
+            p->rate = 0.5 * (nu + a2);
+            p->logM = logM;
+        }
+    }
+}
+
+// Draw V from its distribution given a < T < b.
+static double draw_v(const TPlan * p, gsl_rng * gen) {
+    double      v, s, x, y, logr;
+
+    for(;;) {
+        v = gsl_ran_gamma(gen, p->shape, 1.0 / p->rate);
+        // For small shapes the gamma draw can underflow to 0, which
+        // would make both bounds 0, or NaN for infinite ones. Above
+        // RTT_NU_MIN this happens with probability below 1e-15, so
+        // redrawing leaves the distribution as it is.
+        if(v == 0.0)
+            continue;
+        if(p->env == WHOLE)
+            return v;
+        s = sqrt(v);
+        x = p->a * s;
+        y = p->b * s;
+
+        // log of q(v)/bound(v)
+        switch (p->env) {
+        case PLAIN:
+            logr = log_q(x, y);
+            break;
+        case TAIL:
+            logr = log_q(x, y) + M_LN2 + 0.5 * x * x;
+            break;
+        default:
+            logr = log_q(x, y) - log(y - x) + 0.5 * log(2 * M_PI);
+            if(x > 0.0)
+                logr += 0.5 * x * x;
+            break;
+        }
+        if(logr >= 0.0 || log(gsl_rng_uniform_pos(gen)) < logr)
+            return v;
+    }
+}
+
+void rtt_fill(gsl_rng * gen, double a, double b, double nu, double mu,
+              double sigma, size_t n, double *out) {
+    TPlan       p;
+    double      lo[BLOCK], hi[BLOCK], inv[BLOCK], s, v;
+    size_t      i, j, m;
+
+    tplan_init(&p, (a - mu) / sigma, (b - mu) / sigma, nu);
+    if(p.flip)
+        sigma = -sigma;
+
+    for(i = 0; i < n; i += m) {
+        m = n - i < BLOCK ? n - i : BLOCK;
+        for(j = 0; j < m; ++j) {
+            v = draw_v(&p, gen);
+            s = sqrt(v);
+            lo[j] = p.a * s;
+            hi[j] = p.b * s;
+            inv[j] = 1.0 / s;
+        }
+        rtnorm_fill_rows(gen, m, lo, hi, NULL, NULL, out + i);
+        for(j = 0; j < m; ++j)
+            out[i + j] = mu + sigma * out[i + j] * inv[j];
+    }
+}
+
+void rtt_fill_rows(gsl_rng * gen, size_t n, const double *a,
+                   const double *b, const double *nu, const double *mu,
+                   const double *sigma, double *out) {
+    TPlan       p;
+    double      lo[BLOCK], hi[BLOCK], scale[BLOCK], s, v, mi, si;
+    size_t      i, j, m;
+
+    for(i = 0; i < n; i += m) {
+        m = n - i < BLOCK ? n - i : BLOCK;
+        for(j = 0; j < m; ++j) {
+            mi = mu ? mu[i + j] : 0.0;
+            si = sigma ? sigma[i + j] : 1.0;
+            tplan_init(&p, (a[i + j] - mi) / si, (b[i + j] - mi) / si,
+                       nu[i + j]);
+            v = draw_v(&p, gen);
+            s = sqrt(v);
+            lo[j] = p.a * s;
+            hi[j] = p.b * s;
+            scale[j] = (p.flip ? -si : si) / s;
+        }
+        rtnorm_fill_rows(gen, m, lo, hi, NULL, NULL, out + i);
+        for(j = 0; j < m; ++j)
+            out[i + j] = (mu ? mu[i + j] : 0.0) + scale[j] * out[i + j];
+    }
+}
+
+// P(a < T < b) / M
+double rtt_accept(double a, double b, double nu) {
+    TPlan       p;
+    double      prob;
+
+    tplan_init(&p, a, b, nu);
+    if(p.a >= 0.0)
+        prob = gsl_cdf_tdist_Q(p.a, nu) - gsl_cdf_tdist_Q(p.b, nu);
+    else
+        prob = gsl_cdf_tdist_P(p.b, nu) - gsl_cdf_tdist_P(p.a, nu);
+    return prob / exp(p.logM);
+}
@@ -0,0 +1,108 @@
+//  Samplers for transformations of the truncated Gaussian.
+//  See rtxform.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtnorm_impl.h"
+#include "fastexp.h"
+#include "rtxform.h"
+
+// Values per block. Large enough to amortize the setup in
+// rtnorm_fill_cached, small enough that a block stays in the L1
+// cache, where it is transformed or scattered.
+#define BLOCK 512
+
+void rtlnorm_fill(gsl_rng * gen, double a, double b, double mu,
+                  double sigma, size_t n, double *out) {
+    double      la, lb, y;
+    size_t      i, j, m;
+
+    if(!(a >= 0.0 && a < b)) {
+        fprintf(stderr, "%s:%d: need 0 <= a < b\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    la = log(a);
+    lb = log(b);
+
+    for(i = 0; i < n; i += m) {
+        m = n - i < BLOCK ? n - i : BLOCK;
+        rtnorm_fill_cached(gen, la, lb, mu, sigma, m, out + i);
+
+        // exp rounds, so clamp to keep the result within bounds.
+        for(j = i; j < i + m; ++j) {
+            y = fast_exp(out[j]);
+            y = y < a ? a : y;
+            out[j] = y > b ? b : y;
+        }
+    }
+}
+
+// Y lands in [a,b] or in [-b,-a]. The probability of each is computed
+// once. Within each block, the side of each value is chosen first;
+// then the values for each side are drawn with a single call to
+// rtnorm_fill_cached and scattered into place.
+void rtfnorm_fill(gsl_rng * gen, double a, double b, double mu,
+                  double sigma, size_t n, double *out) {
+    double      pos[BLOCK], neg[BLOCK], lpos, lneg, ppos;
+    unsigned char side[BLOCK];
+    size_t      i, j, m, npos, nneg;
+
+    if(!(a >= 0.0 && a < b)) {
+        fprintf(stderr, "%s:%d: need 0 <= a < b\n", __FILE__, __LINE__);
+        exit(1);
+    }
+
+    // With mu = 0 both sides are alike, and |Y| is simply Y on [a,b].
+    if(mu == 0.0) {
+        rtnorm_fill(gen, a, b, 0.0, sigma, n, out);
+        return;
+    }
+
+    lpos = rtnorm_log_mass((a - mu) / sigma, (b - mu) / sigma);
+    lneg = rtnorm_log_mass((-b - mu) / sigma, (-a - mu) / sigma);
+    if(isinf(lpos) && isinf(lneg))
+        ppos = 0.5;
+    else
+        ppos = 1.0 / (1.0 + exp(lneg - lpos));
+
+    for(i = 0; i < n; i += m) {
+        m = n - i < BLOCK ? n - i : BLOCK;
+        npos = 0;
+        for(j = 0; j < m; ++j) {
+            side[j] = gsl_rng_uniform(gen) < ppos;
+            npos += side[j];
+        }
+        nneg = m - npos;
+        if(npos)
+            rtnorm_fill_cached(gen, a, b, mu, sigma, npos, pos);
+        if(nneg)
+            rtnorm_fill_cached(gen, -b, -a, mu, sigma, nneg, neg);
+        npos = nneg = 0;
+        for(j = 0; j < m; ++j)
+            out[i + j] = side[j] ? pos[npos++] : -neg[nneg++];
+    }
+}
+
+// c + d*Y is Gaussian with mean c + d*mu and standard deviation
+// |d|*sigma, truncated to the image of [a,b].
+void rtnorm_fill_affine(gsl_rng * gen, double a, double b, double mu,
+                        double sigma, double c, double d, size_t n,
+                        double *out) {
+    if(d > 0.0)
+        rtnorm_fill(gen, c + d * a, c + d * b, c + d * mu, d * sigma, n,
+                    out);
+    else if(d < 0.0)
+        rtnorm_fill(gen, c + d * b, c + d * a, c + d * mu, -d * sigma, n,
+                    out);
+    else {
+        fprintf(stderr, "%s:%d: d must not be zero\n", __FILE__, __LINE__);
+        exit(1);
+    }
+}
@@ -0,0 +1,36 @@
+//  Samplers for transformations of the truncated Gaussian.
+//
+//  Each sampler transforms its bounds once, draws a block of
+//  truncated Gaussian values with rtnorm_fill, and applies the output
+//  transformation to the block while it is still in cache, so the
+//  output array is written only once.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __RTXFORM_H
+#define __RTXFORM_H
+
+#include <stddef.h>
+#include <gsl/gsl_rng.h>
+
+// Truncated log-normal: X = exp(Y), where Y is Gaussian with mean mu
+// and standard deviation sigma, truncated so that a <= X <= b. Requires
+// 0 <= a < b; b may be infinite.
+void rtlnorm_fill(gsl_rng *gen, double a, double b, double mu,
+                  double sigma, size_t n, double *out);
+
+// Truncated folded Gaussian: X = |Y|, where Y is Gaussian with mean mu
+// and standard deviation sigma, truncated so that a <= X <= b. Requires
+// 0 <= a < b. With mu = 0, this is the truncated half-normal.
+void rtfnorm_fill(gsl_rng *gen, double a, double b, double mu,
+                  double sigma, size_t n, double *out);
+
+// Affine transformation of the truncated Gaussian: X = c + d*Y, where
+// Y is drawn as by rtnorm_fill(gen, a, b, mu, sigma, ...). d may be
+// negative but not zero.
+void rtnorm_fill_affine(gsl_rng *gen, double a, double b, double mu,
+                        double sigma, double c, double d, size_t n,
+                        double *out);
+
+#endif //__RTXFORM_H
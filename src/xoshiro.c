@@ -0,0 +1,336 @@
+//  xoshiro256+ as GSL generator types, one stream or eight. See
+//  xoshiro.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <gsl/gsl_rng.h>
+
+#include "xoshiro.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define XOSHIRO_X86 1
+#endif
+
+// Streams of xoshiro256+x8, and steps of each per refill of its buffer
+#define LANES 8
+#define ROUNDS 32
+
+typedef struct Xoshiro {
+    uint64_t    s[4];
+} Xoshiro;
+
+// Eight streams, word j of stream l in s[j][l], so that a vector
+// register holds word j of every stream. buf holds ROUNDS outputs of
+// every stream, round by round; buf[next..] are yet to be used.
+typedef struct XoshiroX8 {
+    uint64_t    s[4][LANES];
+    uint64_t    buf[ROUNDS * LANES];
+    int         next;
+} XoshiroX8;
+
+// Run rounds steps of every stream of x. Store round r, stream l in
+// u[r*LANES + l], or, if u is NULL, its double in d[r*LANES + l].
+typedef void BatchFn(XoshiroX8 * x, size_t rounds, uint64_t * u,
+                     double *d);
+
+static inline uint64_t rotl(uint64_t x, int k);
+static inline uint64_t next(Xoshiro * x);
+static void jump(Xoshiro * x);
+static void xoshiro_set(void *vstate, unsigned long seed);
+static unsigned long xoshiro_get(void *vstate);
+static double xoshiro_get_double(void *vstate);
+static void init(void);
+static BatchFn batch_generic;
+#ifdef XOSHIRO_X86
+static BatchFn batch_avx2;
+static BatchFn batch_avx512;
+#endif
+static void refill(XoshiroX8 * x);
+static void x8_set(void *vstate, unsigned long seed);
+static unsigned long x8_get(void *vstate);
+static double x8_get_double(void *vstate);
+
+static BatchFn *batch = batch_generic;
+static pthread_once_t once = PTHREAD_ONCE_INIT;
+
+static inline uint64_t rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t next(Xoshiro * x) {
+    uint64_t   *s = x->s;
+    uint64_t    result = s[0] + s[3];
+    uint64_t    t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+// Fill the state from splitmix64, which never yields the forbidden
+// all-zero state from any seed.
+static void xoshiro_set(void *vstate, unsigned long seed) {
+    Xoshiro    *x = vstate;
+    uint64_t    z, w = seed;
+    int         i;
+
+    for(i = 0; i < 4; ++i) {
+        w += 0x9e3779b97f4a7c15ULL;
+        z = w;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        x->s[i] = z ^ (z >> 31);
+    }
+}
+
+// The low bits of xoshiro256+ are weak, so both outputs use the high
+// bits.
+static unsigned long xoshiro_get(void *vstate) {
+    return (unsigned long) (next(vstate) >> 32);
+}
+
+static double xoshiro_get_double(void *vstate) {
+    return (next(vstate) >> 11) * 0x1.0p-53;
+}
+
+static const gsl_rng_type xoshiro256p_type = {
+    "xoshiro256+",              // name
+    0xffffffffUL,               // RAND_MAX
+    0,                          // RAND_MIN
+    sizeof(Xoshiro),
+    &xoshiro_set,
+    &xoshiro_get,
+    &xoshiro_get_double
+};
+
+const gsl_rng_type *rtnorm_rng_xoshiro256p = &xoshiro256p_type;
+
+// Advance x by 2^128 steps, the jump of Blackman and Vigna.
+static void jump(Xoshiro * x) {
+    static const uint64_t poly[4] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+        0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+    };
+    uint64_t    t[4] = { 0, 0, 0, 0 };
+    int         i, b, j;
+
+    for(i = 0; i < 4; ++i) {
+        for(b = 0; b < 64; ++b) {
+            if(poly[i] & (1ULL << b))
+                for(j = 0; j < 4; ++j)
+                    t[j] ^= x->s[j];
+            next(x);
+        }
+    }
+    memcpy(x->s, t, sizeof(t));
+}
+
+// Choose the widest batch the CPU supports.
+static void init(void) {
+#ifdef XOSHIRO_X86
+    if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq"))
+        batch = batch_avx512;
+    else if(__builtin_cpu_supports("avx2"))
+        batch = batch_avx2;
+#endif
+}
+
+static void batch_generic(XoshiroX8 * x, size_t rounds, uint64_t * u,
+                          double *d) {
+    uint64_t    r, t;
+    size_t      i;
+    int         l;
+
+    for(i = 0; i < rounds; ++i) {
+        for(l = 0; l < LANES; ++l) {
+            r = x->s[0][l] + x->s[3][l];
+            if(u)
+                u[i * LANES + l] = r;
+            else
+                d[i * LANES + l] = (r >> 11) * 0x1.0p-53;
+            t = x->s[1][l] << 17;
+            x->s[2][l] ^= x->s[0][l];
+            x->s[3][l] ^= x->s[1][l];
+            x->s[1][l] ^= x->s[2][l];
+            x->s[0][l] ^= x->s[3][l];
+            x->s[2][l] ^= t;
+            x->s[3][l] = rotl(x->s[3][l], 45);
+        }
+    }
+}
+
+#ifdef XOSHIRO_X86
+// The integer arithmetic is exact, so every batch gives the same
+// numbers. AVX2 has no conversion from 64-bit integers, so split the
+// 53 bits at bit 32 and add the halves exactly in double.
+__attribute__((target("avx2")))
+static void batch_avx2(XoshiroX8 * x, size_t rounds, uint64_t * u,
+                       double *d) {
+    const __m256i lo32 = _mm256_set1_epi64x(0xffffffffLL);
+    const __m256i elo = _mm256_set1_epi64x(0x4330000000000000LL);
+    const __m256i ehi = _mm256_set1_epi64x(0x4530000000000000LL);
+    const __m256d bias = _mm256_set1_pd(0x1.0p84 + 0x1.0p52);
+    const __m256d scale = _mm256_set1_pd(0x1.0p-53);
+    __m256i     s0[2], s1[2], s2[2], s3[2], r, t;
+    __m256d     hi, lo;
+    size_t      i;
+    int         h;
+
+    for(h = 0; h < 2; ++h) {
+        s0[h] = _mm256_loadu_si256((const __m256i *) (x->s[0] + 4 * h));
+        s1[h] = _mm256_loadu_si256((const __m256i *) (x->s[1] + 4 * h));
+        s2[h] = _mm256_loadu_si256((const __m256i *) (x->s[2] + 4 * h));
+        s3[h] = _mm256_loadu_si256((const __m256i *) (x->s[3] + 4 * h));
+    }
+    for(i = 0; i < rounds; ++i) {
+        for(h = 0; h < 2; ++h) {
+            r = _mm256_add_epi64(s0[h], s3[h]);
+            if(u)
+                _mm256_storeu_si256((__m256i *) (u + i * LANES + 4 * h), r);
+            else {
+                r = _mm256_srli_epi64(r, 11);
+                hi = _mm256_castsi256_pd(_mm256_or_si256
+                                         (_mm256_srli_epi64(r, 32), ehi));
+                lo = _mm256_castsi256_pd(_mm256_or_si256
+                                         (_mm256_and_si256(r, lo32), elo));
+                _mm256_storeu_pd(d + i * LANES + 4 * h,
+                                 _mm256_mul_pd(_mm256_add_pd
+                                               (_mm256_sub_pd(hi, bias), lo),
+                                               scale));
+            }
+            t = _mm256_slli_epi64(s1[h], 17);
+            s2[h] = _mm256_xor_si256(s2[h], s0[h]);
+            s3[h] = _mm256_xor_si256(s3[h], s1[h]);
+            s1[h] = _mm256_xor_si256(s1[h], s2[h]);
+            s0[h] = _mm256_xor_si256(s0[h], s3[h]);
+            s2[h] = _mm256_xor_si256(s2[h], t);
+            s3[h] = _mm256_or_si256(_mm256_slli_epi64(s3[h], 45),
+                                    _mm256_srli_epi64(s3[h], 19));
+        }
+    }
+    for(h = 0; h < 2; ++h) {
+        _mm256_storeu_si256((__m256i *) (x->s[0] + 4 * h), s0[h]);
+        _mm256_storeu_si256((__m256i *) (x->s[1] + 4 * h), s1[h]);
+        _mm256_storeu_si256((__m256i *) (x->s[2] + 4 * h), s2[h]);
+        _mm256_storeu_si256((__m256i *) (x->s[3] + 4 * h), s3[h]);
+    }
+}
+
+// One register holds a word of all eight streams. Converting 64-bit
+// integers to doubles needs avx512dq.
+__attribute__((target("avx512f,avx512dq")))
+static void batch_avx512(XoshiroX8 * x, size_t rounds, uint64_t * u,
+                         double *d) {
+    const __m512d scale = _mm512_set1_pd(0x1.0p-53);
+    __m512i     s0 = _mm512_loadu_si512(x->s[0]);
+    __m512i     s1 = _mm512_loadu_si512(x->s[1]);
+    __m512i     s2 = _mm512_loadu_si512(x->s[2]);
+    __m512i     s3 = _mm512_loadu_si512(x->s[3]);
+    __m512i     r, t;
+    size_t      i;
+
+    for(i = 0; i < rounds; ++i) {
+        r = _mm512_add_epi64(s0, s3);
+        if(u)
+            _mm512_storeu_si512(u + i * LANES, r);
+        else
+            _mm512_storeu_pd(d + i * LANES, _mm512_mul_pd
+                             (_mm512_cvtepi64_pd(_mm512_srli_epi64(r, 11)),
+                              scale));
+        t = _mm512_slli_epi64(s1, 17);
+        s2 = _mm512_xor_si512(s2, s0);
+        s3 = _mm512_xor_si512(s3, s1);
+        s1 = _mm512_xor_si512(s1, s2);
+        s0 = _mm512_xor_si512(s0, s3);
+        s2 = _mm512_xor_si512(s2, t);
+        s3 = _mm512_rol_epi64(s3, 45);
+    }
+    _mm512_storeu_si512(x->s[0], s0);
+    _mm512_storeu_si512(x->s[1], s1);
+    _mm512_storeu_si512(x->s[2], s2);
+    _mm512_storeu_si512(x->s[3], s3);
+}
+#endif
+
+static void refill(XoshiroX8 * x) {
+    batch(x, ROUNDS, x->buf, NULL);
+    x->next = 0;
+}
+
+// Stream 0 starts where xoshiro256+ with the same seed does, and each
+// further stream 2^128 steps after the one before, so no two overlap.
+static void x8_set(void *vstate, unsigned long seed) {
+    XoshiroX8  *x = vstate;
+    Xoshiro     one;
+    int         j, l;
+
+    pthread_once(&once, init);
+    xoshiro_set(&one, seed);
+    for(l = 0; l < LANES; ++l) {
+        for(j = 0; j < 4; ++j)
+            x->s[j][l] = one.s[j];
+        jump(&one);
+    }
+    x->next = ROUNDS * LANES;
+}
+
+static unsigned long x8_get(void *vstate) {
+    XoshiroX8  *x = vstate;
+
+    if(x->next == ROUNDS * LANES)
+        refill(x);
+    return (unsigned long) (x->buf[x->next++] >> 32);
+}
+
+static double x8_get_double(void *vstate) {
+    XoshiroX8  *x = vstate;
+
+    if(x->next == ROUNDS * LANES)
+        refill(x);
+    return (x->buf[x->next++] >> 11) * 0x1.0p-53;
+}
+
+static const gsl_rng_type xoshiro256px8_type = {
+    "xoshiro256+x8",            // name
+    0xffffffffUL,               // RAND_MAX
+    0,                          // RAND_MIN
+    sizeof(XoshiroX8),
+    &x8_set,
+    &x8_get,
+    &x8_get_double
+};
+
+const gsl_rng_type *rtnorm_rng_xoshiro256px8 = &xoshiro256px8_type;
+
+void rtnorm_rng_uniform_fill(gsl_rng * gen, size_t n, double *u) {
+    XoshiroX8  *x;
+    size_t      i = 0, rounds;
+
+    if(gen->type != &xoshiro256px8_type) {
+        for(; i < n; ++i)
+            u[i] = gsl_rng_uniform(gen);
+        return;
+    }
+
+    // Use up the buffer, then write whole rounds straight to u, and
+    // take the rest from a fresh buffer.
+    x = gen->state;
+    for(; i < n && x->next < ROUNDS * LANES; ++i)
+        u[i] = (x->buf[x->next++] >> 11) * 0x1.0p-53;
+    rounds = (n - i) / LANES;
+    if(rounds > 0) {
+        batch(x, rounds, NULL, u + i);
+        i += rounds * LANES;
+    }
+    for(; i < n; ++i)
+        u[i] = x8_get_double(x);
+}
@@ -0,0 +1,35 @@
+//  The xoshiro256+ generator of Blackman and Vigna (2018), packaged as
+//  a GSL generator type. It is several times faster than taus, has a
+//  period of 2^256 - 1, and fills all 53 bits of each double, where
+//  GSL's 32-bit generators fill 32. Use it like any GSL type:
+//
+//      gsl_rng *rng = gsl_rng_alloc(rtnorm_rng_xoshiro256p);
+//
+//  The state is seeded by running splitmix64 from the seed. Its name,
+//  for chunks_rng_type and the -g option of the programs, is
+//  "xoshiro256+".
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __XOSHIRO_H
+#define __XOSHIRO_H
+
+#include <stddef.h>
+#include <gsl/gsl_rng.h>
+
+extern const gsl_rng_type *rtnorm_rng_xoshiro256p;
+
+// Eight xoshiro256+ streams side by side, stepped together in vector
+// registers (AVX2 or AVX-512, chosen at run time) a buffer at a time.
+// Output k comes from stream k % 8. Stream 0 is the xoshiro256+ stream
+// with the same seed, and stream l is stream 0 advanced 2^(128 l)
+// steps, so the streams never overlap. Its name is "xoshiro256+x8".
+extern const gsl_rng_type *rtnorm_rng_xoshiro256px8;
+
+// Fill u[0..n-1] with gsl_rng_uniform(gen), in order. With
+// xoshiro256+x8, whole rounds of the eight streams are converted to
+// doubles in registers and stored, without a call per number.
+void        rtnorm_rng_uniform_fill(gsl_rng *gen, size_t n, double *u);
+
+#endif //__XOSHIRO_H
@@ -0,0 +1,89 @@
+//  Benchmark: scalar rtnorm calls cycling through a set of recurring
+//  intervals, with and without the plan cache (see rtnorm_cache.h).
+//  Build with the full optimization flags in the Makefile before
+//  taking these numbers seriously.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtnorm_cache.h"
+
+#define N 2000000
+
+static double now(void);
+static double run(gsl_rng * rng, int k, const double *a, const double *b,
+                  double *sum);
+
+// Seconds on a monotonic clock
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+// Seconds for N draws cycling through intervals [a[i], b[i]], i < k
+static double run(gsl_rng * rng, int k, const double *a, const double *b,
+                  double *sum) {
+    double      t0 = now();
+    int         i, j;
+
+    for(i = j = 0; i < N; ++i) {
+        *sum += rtnorm(rng, a[j], b[j], 0.0, 1.0);
+        if(++j == k)
+            j = 0;
+    }
+    return now() - t0;
+}
+
+int main(void) {
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    double     *a, *b, t0, t1, sum = 0.0;
+    unsigned long hits, misses;
+    int         i, c, k;
+    struct {
+        const char *name;
+        double      lo, width;
+    } cl[] = {
+        {"central", -2.0, 1.0},
+        {"narrow", -2.0, 0.01},
+        {"tail", 3.0, 1.0},
+    };
+
+    a = malloc(4096 * sizeof(double));
+    b = malloc(4096 * sizeof(double));
+    if(rng == NULL || a == NULL || b == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    gsl_rng_set(rng, 1);
+    printf("%-10s %6s %10s %10s %8s\n", "intervals", "count", "plain ns",
+           "cached ns", "hits");
+    for(c = 0; c < (int) (sizeof(cl) / sizeof(cl[0])); ++c) {
+        for(k = 16; k <= 4096; k *= 16) {
+            for(i = 0; i < k; ++i) {
+                a[i] = cl[c].lo + 4.0 * i / k;
+                b[i] = a[i] + cl[c].width;
+            }
+            t0 = run(rng, k, a, b, &sum);
+            rtnorm_cache_enable(1024);
+            t1 = run(rng, k, a, b, &sum);
+            rtnorm_cache_stats(&hits, &misses);
+            rtnorm_cache_disable();
+            printf("%-10s %6d %10.2f %10.2f %7.1f%%\n", cl[c].name, k,
+                   1e9 * t0 / N, 1e9 * t1 / N,
+                   100.0 * hits / (hits + misses));
+        }
+    }
+    printf("(sum %g)\n", sum);
+    free(a);
+    free(b);
+    gsl_rng_free(rng);
+    return 0;
+}
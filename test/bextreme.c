@@ -0,0 +1,77 @@
+//  Benchmark: the largest of n truncated Gaussian draws, by taking
+//  the maximum of rtnorm_fill's output and by rtnorm_max, which
+//  inverts the CDF of the maximum once. Build with the full
+//  optimization flags in the Makefile before taking these numbers
+//  seriously.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtinv.h"
+
+#define WORK 10000000           // draws from rtnorm_fill per row
+#define REPS 200000             // calls to rtnorm_max per row
+
+static double now(void);
+
+// Seconds on a monotonic clock
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+int main(void) {
+    size_t      nmax = 1000000, n, i, r, reps;
+    double     *v = malloc(nmax * sizeof(double)), t0, t1, t2, m, s = 0.0;
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    int         j;
+    struct {
+        double      a, b;
+    } c[] = {
+        {-INFINITY, INFINITY},
+        {-1.0, 2.0},
+        {3.0, 5.0},
+        {40.0, INFINITY},
+    };
+
+    if(v == NULL || rng == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    gsl_rng_set(rng, 1);
+
+    printf("%-16s %9s %14s %14s %10s\n", "us/maximum", "n", "fill+max",
+           "rtnorm_max", "speedup");
+    for(j = 0; j < (int) (sizeof(c) / sizeof(c[0])); ++j) {
+        for(n = 10; n <= nmax; n *= 100) {
+            reps = WORK / n;
+            t0 = now();
+            for(r = 0; r < reps; ++r) {
+                rtnorm_fill(rng, c[j].a, c[j].b, 0.0, 1.0, n, v);
+                for(m = v[0], i = 1; i < n; ++i)
+                    m = v[i] > m ? v[i] : m;
+                s += m;
+            }
+            t1 = now();
+            for(r = 0; r < REPS; ++r)
+                s += rtnorm_max(rng, (double) n, c[j].a, c[j].b, 0.0, 1.0);
+            t2 = now();
+            printf("[%5g,%5g]    %9zu %14.3f %14.3f %10.3g\n", c[j].a,
+                   c[j].b, n, 1e6 * (t1 - t0) / reps,
+                   1e6 * (t2 - t1) / REPS,
+                   ((t1 - t0) / reps) / ((t2 - t1) / REPS));
+        }
+    }
+    printf("(sum %g)\n", s);
+    free(v);
+    gsl_rng_free(rng);
+    return 0;
+}
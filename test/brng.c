@@ -0,0 +1,72 @@
+//  Benchmark: uniforms one call at a time from taus, xoshiro256+ and
+//  xoshiro256+x8, and in bulk from xoshiro256+x8, then rtnormf_fill,
+//  which takes its uniforms in bulk, with each generator. Build with
+//  the full optimization flags in the Makefile before taking these
+//  numbers seriously.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnormf.h"
+#include "xoshiro.h"
+
+#define N 8000000
+
+static double now(void);
+
+// Seconds on a monotonic clock
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+int main(void) {
+    double     *v = malloc(N * sizeof(double)), t0, s = 0.0;
+    float      *vf = malloc(N * sizeof(float));
+    const gsl_rng_type *type[3];
+    gsl_rng    *rng;
+    int         j;
+    size_t      i;
+
+    if(v == NULL || vf == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    type[0] = gsl_rng_taus;
+    type[1] = rtnorm_rng_xoshiro256p;
+    type[2] = rtnorm_rng_xoshiro256px8;
+
+    printf("%-14s %10s %10s %10s\n", "ns/draw", "uniform", "fill",
+           "rtnormf");
+    for(j = 0; j < 3; ++j) {
+        rng = gsl_rng_alloc(type[j]);
+        if(rng == NULL) {
+            fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+            exit(1);
+        }
+        gsl_rng_set(rng, 1);
+        printf("%-14s", gsl_rng_name(rng));
+        t0 = now();
+        for(i = 0; i < N; ++i)
+            s += gsl_rng_uniform(rng);
+        printf(" %10.2f", 1e9 * (now() - t0) / N);
+        t0 = now();
+        rtnorm_rng_uniform_fill(rng, N, v);
+        printf(" %10.2f", 1e9 * (now() - t0) / N);
+        t0 = now();
+        rtnormf_fill(rng, -1.0f, 1.0f, 0.0f, 1.0f, N, vf);
+        printf(" %10.2f\n", 1e9 * (now() - t0) / N);
+        s += v[N / 2] + vf[N / 2];
+        gsl_rng_free(rng);
+    }
+    printf("(sum %g)\n", s);
+    free(v);
+    free(vf);
+    return 0;
+}
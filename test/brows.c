@@ -0,0 +1,95 @@
+//  Benchmark: a different interval on every row. Compares
+//  rtnorm_fill_rows, which plans and draws one row at a time, with
+//  rtnormf_fill_rows under each kernel, which plans a block of rows in
+//  vector registers and draws up to 16 rows side by side. Build with
+//  the full optimization flags in the Makefile before taking these
+//  numbers seriously.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtnormf.h"
+
+#define N 2000000
+
+static double now(void);
+
+// Seconds on a monotonic clock
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+int main(void) {
+    double     *a = malloc(N * sizeof(double)), *b = malloc(N * sizeof(double));
+    double     *v = malloc(N * sizeof(double)), t0, s = 0.0, lo;
+    float      *af = malloc(N * sizeof(float)), *bf = malloc(N * sizeof(float));
+    float      *vf = malloc(N * sizeof(float));
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    const char *name[] = { "generic", "avx2", "avx512" };
+    const char *best;
+    const char *label[] = { "boxes", "mixed" };
+    int         j, kn;
+    size_t      i;
+
+    if(a == NULL || b == NULL || v == NULL || af == NULL || bf == NULL
+       || vf == NULL || rng == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    gsl_rng_set(rng, 1);
+    best = rtnormf_simd();
+
+    printf("%-14s %10s", "ns/draw", "rtnorm");
+    for(kn = 0; kn < 3; ++kn)
+        printf(" %10s", name[kn]);
+    printf("\n");
+    for(j = 0; j < 2; ++j) {
+        // Intervals within the boxes, then one in four in the tails
+        for(i = 0; i < N; ++i) {
+            lo = 4.0 * gsl_rng_uniform(rng) - 1.5;
+            a[i] = lo;
+            b[i] = lo + 0.1 + 2.0 * gsl_rng_uniform(rng);
+            if(j == 1 && i % 4 == 3) {
+                a[i] = i % 8 == 3 ? 3.0 + 2.0 * gsl_rng_uniform(rng)
+                    : -4.0 - gsl_rng_uniform(rng);
+                b[i] = i % 8 == 3 ? INFINITY : 3.0;
+            }
+            af[i] = a[i];
+            bf[i] = b[i];
+        }
+        printf("%-14s", label[j]);
+        t0 = now();
+        rtnorm_fill_rows(rng, N, a, b, NULL, NULL, v);
+        printf(" %10.2f", 1e9 * (now() - t0) / N);
+        for(kn = 0; kn < 3; ++kn) {
+            if(!rtnormf_set_simd(name[kn])) {
+                printf(" %10s", "-");
+                continue;
+            }
+            t0 = now();
+            rtnormf_fill_rows(rng, N, af, bf, NULL, NULL, vf);
+            printf(" %10.2f", 1e9 * (now() - t0) / N);
+        }
+        printf("\n");
+        s += v[N / 2] + vf[N / 2];
+    }
+    rtnormf_set_simd(best);
+    printf("(sum %g)\n", s);
+    free(a);
+    free(b);
+    free(v);
+    free(af);
+    free(bf);
+    free(vf);
+    gsl_rng_free(rng);
+    return 0;
+}
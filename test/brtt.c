@@ -0,0 +1,68 @@
+//  Benchmark: throughput of rtt_fill, compared with rtnorm_fill on the
+//  same intervals. Build with the full optimization flags in the
+//  Makefile before taking these numbers seriously.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtt.h"
+
+#define N 2000000
+
+static double now(void);
+
+// Seconds on a monotonic clock
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+int main(void) {
+    double     *v = malloc(N * sizeof(double));
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    double      t0, tt, tn;
+    char        label[64];
+    int         j;
+    struct {
+        double      a, b, nu;
+    } c[] = {
+        {-1.0, 1.0, 3.0},
+        {0.0, INFINITY, 4.0},
+        {3.0, INFINITY, 5.0},
+        {10.0, 12.0, 30.0},
+        {0.5, 0.51, 3.0},
+        {-INFINITY, INFINITY, 10.0},
+    };
+
+    if(v == NULL || rng == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    gsl_rng_set(rng, 1);
+    printf("%-22s %10s %10s %10s\n", "interval", "t ns/draw",
+           "N ns/draw", "accept");
+    for(j = 0; j < (int) (sizeof(c) / sizeof(c[0])); ++j) {
+        t0 = now();
+        rtt_fill(rng, c[j].a, c[j].b, c[j].nu, 0.0, 1.0, N, v);
+        tt = now() - t0;
+        t0 = now();
+        rtnorm_fill(rng, c[j].a, c[j].b, 0.0, 1.0, N, v);
+        tn = now() - t0;
+        snprintf(label, sizeof(label), "[%g,%g] nu=%g", c[j].a, c[j].b,
+                 c[j].nu);
+        printf("%-22s %10.1f %10.1f %10.3f\n", label, 1e9 * tt / N,
+               1e9 * tn / N,
+               rtt_accept(c[j].a, c[j].b, c[j].nu));
+    }
+    gsl_rng_free(rng);
+    free(v);
+    return 0;
+}
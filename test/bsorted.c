@@ -0,0 +1,117 @@
+//  Benchmark: rtnorm_fill_rows_sorted against rtnorm_fill_rows on rows
+//  whose intervals vary at random, with the L1 data cache misses of
+//  each where the kernel lets us count them (Linux perf events). Build
+//  with the full optimization flags in the Makefile before taking
+//  these numbers seriously.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <gsl/gsl_rng.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "rtnorm.h"
+
+#define N 2000000
+
+static double now(void);
+static int miss_open(void);
+static double miss_read(int fd);
+
+// Seconds on a monotonic clock
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+// A counter of L1 data cache read misses by this thread, or -1
+static int miss_open(void) {
+#ifdef __linux__
+    struct perf_event_attr pe;
+
+    memset(&pe, 0, sizeof(pe));
+    pe.size = sizeof(pe);
+    pe.type = PERF_TYPE_HW_CACHE;
+    pe.config = PERF_COUNT_HW_CACHE_L1D
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    pe.exclude_kernel = 1;
+    pe.exclude_hv = 1;
+    return syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+// Misses counted by fd so far, or NAN
+static double miss_read(int fd) {
+    long long   count;
+
+    if(fd < 0 || read(fd, &count, sizeof(count)) != sizeof(count))
+        return NAN;
+    return (double) count;
+}
+
+int main(void) {
+    double     *a = malloc(N * sizeof(double));
+    double     *b = malloc(N * sizeof(double));
+    double     *v = malloc(N * sizeof(double));
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    double      t0, t[2], m0, m[2], w;
+    int         fd = miss_open(), j, k;
+    size_t      i;
+    double      width[] = {0.01, 0.1, 1.0};
+
+    if(a == NULL || b == NULL || v == NULL || rng == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    gsl_rng_set(rng, 1);
+    printf("%-12s %10s %10s %12s %12s\n", "width", "rows ns", "sorted ns",
+           "rows miss", "sorted miss");
+    for(j = 0; j < (int) (sizeof(width) / sizeof(width[0])); ++j) {
+        w = width[j];
+        for(i = 0; i < N; ++i) {
+            a[i] = -2.5 + 5.0 * gsl_rng_uniform(rng);
+            b[i] = a[i] + w;
+        }
+        // Best of three runs of each
+        for(k = 0; k < 6; ++k) {
+            m0 = miss_read(fd);
+            t0 = now();
+            if(k % 2 == 0)
+                rtnorm_fill_rows(rng, N, a, b, NULL, NULL, v);
+            else
+                rtnorm_fill_rows_sorted(rng, N, a, b, NULL, NULL, v);
+            t0 = now() - t0;
+            m0 = miss_read(fd) - m0;
+            if(k < 2 || t0 < t[k % 2])
+                t[k % 2] = t0;
+            if(k < 2 || m0 < m[k % 2])
+                m[k % 2] = m0;
+        }
+        printf("[a, a+%-5g] %10.2f %10.2f %12.3f %12.3f\n", w,
+               1e9 * t[0] / N, 1e9 * t[1] / N, m[0] / N, m[1] / N);
+    }
+    if(fd < 0)
+        printf("(cache misses per draw are nan: no perf events here)\n");
+    else
+        close(fd);
+    free(a);
+    free(b);
+    free(v);
+    gsl_rng_free(rng);
+    return 0;
+}
@@ -0,0 +1,83 @@
+//  Benchmark: sorted samples. Compares rtnorm_fill followed by qsort
+//  with rtnorm_fill_sorted, which draws sorted uniforms and inverts
+//  the CDF, for intervals near the mode and in the tails, and for
+//  sample sizes from L1 to main memory. Build with the full
+//  optimization flags in the Makefile before taking these numbers
+//  seriously.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+
+#define NMAX 4000000
+
+static double now(void);
+static int  cmp(const void *x, const void *y);
+
+// Seconds on a monotonic clock
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+static int cmp(const void *x, const void *y) {
+    double      a = *(const double *) x, b = *(const double *) y;
+
+    return (a > b) - (a < b);
+}
+
+int main(void) {
+    double     *v = malloc(NMAX * sizeof(double)), t0, t1, t2, s = 0.0;
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    size_t      n, reps, r;
+    int         j;
+    struct {
+        double      a, b;
+    } c[] = {
+        {-INFINITY, INFINITY},
+        {-1.0, 2.0},
+        {3.0, 5.0},
+        {40.0, INFINITY},
+    };
+
+    if(v == NULL || rng == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    gsl_rng_set(rng, 1);
+
+    printf("%-16s %9s %12s %12s %8s\n", "ns/value", "n", "fill+qsort",
+           "fill_sorted", "speedup");
+    for(j = 0; j < (int) (sizeof(c) / sizeof(c[0])); ++j) {
+        for(n = 1000; n <= NMAX; n *= 10) {
+            reps = NMAX / n;
+            t0 = now();
+            for(r = 0; r < reps; ++r) {
+                rtnorm_fill(rng, c[j].a, c[j].b, 0.0, 1.0, n, v);
+                qsort(v, n, sizeof(double), cmp);
+                s += v[n / 2];
+            }
+            t1 = now();
+            for(r = 0; r < reps; ++r) {
+                rtnorm_fill_sorted(rng, c[j].a, c[j].b, 0.0, 1.0, n, v);
+                s += v[n / 2];
+            }
+            t2 = now();
+            printf("[%5g,%5g]    %9zu %12.2f %12.2f %8.2f\n", c[j].a,
+                   c[j].b, n, 1e9 * (t1 - t0) / (reps * n),
+                   1e9 * (t2 - t1) / (reps * n), (t1 - t0) / (t2 - t1));
+        }
+    }
+    printf("(sum %g)\n", s);
+    free(v);
+    gsl_rng_free(rng);
+    return 0;
+}
@@ -0,0 +1,124 @@
+//  Benchmark: a fill larger than most last-level caches, with ordinary
+//  stores and with the non-temporal stores of rtnorm_set_stream_bytes,
+//  followed by a probe of draws from random intervals that reads the
+//  tables from wherever the fill left them. Reports both times, and
+//  the probe's last-level cache misses where the kernel lets us count
+//  them (Linux perf events). Build with the full optimization flags in
+//  the Makefile before taking these numbers seriously.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <gsl/gsl_rng.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "rtnorm.h"
+
+#define N (64L << 20)           // 512 MiB of output
+#define NPROBE 200000
+
+static double now(void);
+static int miss_open(void);
+static double miss_read(int fd);
+
+// Seconds on a monotonic clock
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+// A counter of last-level cache read misses by this thread, or -1
+static int miss_open(void) {
+#ifdef __linux__
+    struct perf_event_attr pe;
+
+    memset(&pe, 0, sizeof(pe));
+    pe.size = sizeof(pe);
+    pe.type = PERF_TYPE_HW_CACHE;
+    pe.config = PERF_COUNT_HW_CACHE_LL
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    pe.exclude_kernel = 1;
+    pe.exclude_hv = 1;
+    return syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+// Misses counted by fd so far, or NAN
+static double miss_read(int fd) {
+    long long   count;
+
+    if(fd < 0 || read(fd, &count, sizeof(count)) != sizeof(count))
+        return NAN;
+    return (double) count;
+}
+
+int main(void) {
+    double     *v = malloc(N * sizeof(double));
+    double     *a = malloc(NPROBE * sizeof(double));
+    double     *b = malloc(NPROBE * sizeof(double));
+    double     *p = malloc(NPROBE * sizeof(double));
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    const char *label[] = { "cached", "streamed" };
+    double      t0, tfill, tprobe, m0, s = 0.0;
+    int         fd = miss_open(), j;
+    size_t      i, old;
+
+    if(v == NULL || a == NULL || b == NULL || p == NULL || rng == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    gsl_rng_set(rng, 1);
+    for(i = 0; i < NPROBE; ++i) {
+        a[i] = 4.0 * gsl_rng_uniform(rng) - 2.0;
+        b[i] = a[i] + 0.05 + gsl_rng_uniform(rng);
+    }
+    memset(v, 0, N * sizeof(double));   // fault the pages in
+    if(fd >= 0)
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+
+    printf("%-10s %12s %12s %14s\n", "stores", "fill ns", "probe ns",
+           "probe misses");
+    old = rtnorm_set_stream_bytes(SIZE_MAX);
+    for(j = 0; j < 2; ++j) {
+        rtnorm_set_stream_bytes(j ? 0 : SIZE_MAX);
+
+        // Warm the tables, fill, then see what is left of them.
+        rtnorm_fill_rows(rng, NPROBE, a, b, NULL, NULL, p);
+        t0 = now();
+        rtnorm_fill(rng, -1.0, 2.0, 0.0, 1.0, N, v);
+        tfill = now() - t0;
+        m0 = miss_read(fd);
+        t0 = now();
+        rtnorm_fill_rows(rng, NPROBE, a, b, NULL, NULL, p);
+        tprobe = now() - t0;
+        printf("%-10s %12.2f %12.2f %14.0f\n", label[j], 1e9 * tfill / N,
+               1e9 * tprobe / NPROBE, miss_read(fd) - m0);
+        s += v[N / 2] + p[NPROBE / 2];
+    }
+    rtnorm_set_stream_bytes(old);
+    printf("(sum %g)\n", s);
+    if(fd >= 0)
+        close(fd);
+    free(v);
+    free(a);
+    free(b);
+    free(p);
+    gsl_rng_free(rng);
+    return 0;
+}
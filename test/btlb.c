@@ -0,0 +1,138 @@
+//  Benchmark: draws from random intervals all over the tables, with
+//  the static tables and then with the copy rtnorm_table_hugepage makes
+//  in a huge page. Reports times, the data TLB misses of each where the
+//  kernel lets us count them (Linux perf events), and the process's
+//  anonymous huge pages, which show whether the kernel granted one.
+//  Build with the full optimization flags in the Makefile before
+//  taking these numbers seriously.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <gsl/gsl_rng.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "rtnorm.h"
+
+#define N 2000000
+
+static double now(void);
+static int miss_open(void);
+static double miss_read(int fd);
+static long huge_kb(void);
+
+// Seconds on a monotonic clock
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+// A counter of data TLB read misses by this thread, or -1
+static int miss_open(void) {
+#ifdef __linux__
+    struct perf_event_attr pe;
+
+    memset(&pe, 0, sizeof(pe));
+    pe.size = sizeof(pe);
+    pe.type = PERF_TYPE_HW_CACHE;
+    pe.config = PERF_COUNT_HW_CACHE_DTLB
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    pe.exclude_kernel = 1;
+    pe.exclude_hv = 1;
+    return syscall(__NR_perf_event_open, &pe, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+// Misses counted by fd so far, or NAN
+static double miss_read(int fd) {
+    long long   count;
+
+    if(fd < 0 || read(fd, &count, sizeof(count)) != sizeof(count))
+        return NAN;
+    return (double) count;
+}
+
+// Kilobytes of anonymous memory in huge pages, or -1 if unknown
+static long huge_kb(void) {
+    FILE       *fp = fopen("/proc/self/smaps_rollup", "r");
+    char        line[256];
+    long        kb = -1;
+
+    if(fp == NULL)
+        return -1;
+    while(fgets(line, sizeof(line), fp))
+        if(sscanf(line, "AnonHugePages: %ld", &kb) == 1)
+            break;
+    fclose(fp);
+    return kb;
+}
+
+int main(void) {
+    double     *a = malloc(N * sizeof(double));
+    double     *b = malloc(N * sizeof(double));
+    double     *v = malloc(N * sizeof(double));
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    const char *label[] = { "static", "huge page" };
+    double      t0, t = 0.0, m0, m = 0.0, s = 0.0;
+    int         fd = miss_open(), j, k, kind = -1;
+    size_t      i;
+
+    if(a == NULL || b == NULL || v == NULL || rng == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    gsl_rng_set(rng, 1);
+    for(i = 0; i < N; ++i) {
+        a[i] = 4.5 * gsl_rng_uniform(rng) - 2.0;
+        b[i] = a[i] + 0.05 + 2.0 * gsl_rng_uniform(rng);
+    }
+    if(fd >= 0)
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+
+    printf("%-10s %10s %14s %14s\n", "tables", "ns/draw", "dTLB misses",
+           "huge pages kB");
+    for(j = 0; j < 2; ++j) {
+        if(j == 1)
+            kind = rtnorm_table_hugepage();
+
+        // Best of three
+        for(k = 0; k < 3; ++k) {
+            m0 = miss_read(fd);
+            t0 = now();
+            rtnorm_fill_rows(rng, N, a, b, NULL, NULL, v);
+            t0 = now() - t0;
+            m0 = miss_read(fd) - m0;
+            if(k == 0 || t0 < t)
+                t = t0;
+            if(k == 0 || m0 < m)
+                m = m0;
+            s += v[N / 2];
+        }
+        printf("%-10s %10.2f %14.0f %14ld\n", label[j], 1e9 * t / N, m,
+               huge_kb());
+    }
+    printf("rtnorm_table_hugepage returned %d\n", kind);
+    printf("(sum %g)\n", s);
+    if(fd >= 0)
+        close(fd);
+    free(a);
+    free(b);
+    free(v);
+    gsl_rng_free(rng);
+    return 0;
+}
@@ -0,0 +1,93 @@
+//  Benchmark: a loop of scalar rtnorm calls, compared with the C++
+//  distribution, its bulk generate, and the lazy range of samples.
+//  Each consumer sums its values, so nothing is optimized away. Build
+//  with the full optimization flags in the Makefile before taking
+//  these numbers seriously.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <ranges>
+#include <vector>
+#include <gsl/gsl_rng.h>
+
+// The C function rtnorm and namespace rtnorm cannot share the global
+// scope; see rtnorm.hpp.
+namespace capi {
+extern "C" {
+#include "rtnorm.h"
+}
+}
+#include "rtnorm_views.hpp"
+
+#define N 2000000
+
+// Seconds on a monotonic clock
+static double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                         .time_since_epoch()).count();
+}
+
+int main() {
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    std::mt19937_64 g(1);
+    std::vector<double> v(N);
+    double      t0, t[4], s[4];
+    char        label[64];
+    struct {
+        double      a, b;
+    } c[] = {
+        {-1.0, 1.0},
+        {0.0, INFINITY},
+        {-INFINITY, INFINITY},
+        {0.5, 0.51},
+        {4.0, 6.0},
+    };
+
+    gsl_rng_set(rng, 1);
+    std::printf("%-16s %10s %10s %10s %10s\n", "ns/draw", "rtnorm",
+                "d(g)", "generate", "view");
+    for(auto &cj : c) {
+        rtnorm::truncated_normal_distribution<> d(cj.a, cj.b);
+
+        s[0] = s[1] = s[2] = s[3] = 0.0;
+
+        t0 = now();
+        for(int i = 0; i < N; ++i)
+            s[0] += capi::rtnorm(rng, cj.a, cj.b, 0.0, 1.0);
+        t[0] = now() - t0;
+
+        t0 = now();
+        for(int i = 0; i < N; ++i)
+            s[1] += d(g);
+        t[1] = now() - t0;
+
+        t0 = now();
+        d.generate(v.begin(), v.end(), g);
+        for(double x : v)
+            s[2] += x;
+        t[2] = now() - t0;
+
+        t0 = now();
+        for(double x : rtnorm::views::samples(g, cj.a, cj.b)
+            | std::views::take(N))
+            s[3] += x;
+        t[3] = now() - t0;
+
+        std::snprintf(label, sizeof(label), "[%g,%g]", cj.a, cj.b);
+        std::printf("%-16s %10.1f %10.1f %10.1f %10.1f\n", label,
+                    1e9 * t[0] / N, 1e9 * t[1] / N, 1e9 * t[2] / N,
+                    1e9 * t[3] / N);
+
+        // Means should agree; printing them keeps the sums alive.
+        if(std::fabs(s[0] - s[3]) > 0.01 * N)
+            std::printf("%16s means %g %g %g %g\n", "", s[0] / N, s[1] / N,
+                        s[2] / N, s[3] / N);
+    }
+    gsl_rng_free(rng);
+    return 0;
+}
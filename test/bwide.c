@@ -0,0 +1,92 @@
+//  Benchmark: wide intervals, which rtnorm samples by drawing whole
+//  Gaussians until one lands in [a,b]. Compares rtnorm_fill, which
+//  calls GSL's scalar ziggurat, with the vector ziggurat of each
+//  rtnormf kernel, and with plain loops of GSL Gaussians and of the
+//  uniforms the vector ziggurat consumes. Build with the full
+//  optimization flags in the Makefile before taking these numbers
+//  seriously.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_randist.h>
+
+#include "rtnorm.h"
+#include "rtnormf.h"
+
+#define N 4000000
+
+static double now(void);
+
+// Seconds on a monotonic clock
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+int main(void) {
+    double     *v = malloc(N * sizeof(double)), t0, s = 0.0;
+    float      *vf = malloc(N * sizeof(float));
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    const char *name[] = { "generic", "avx2", "avx512" };
+    const char *best;
+    int         j, kn;
+    size_t      i;
+    struct {
+        double      a, b;
+    } c[] = {
+        {-INFINITY, INFINITY},
+        {-3.0, 3.0},
+        {-2.1, 2.3},
+    };
+
+    if(v == NULL || vf == NULL || rng == NULL) {
+        fprintf(stderr, "%s:%d: bad malloc\n", __FILE__, __LINE__);
+        exit(1);
+    }
+    gsl_rng_set(rng, 1);
+    best = rtnormf_simd();
+
+    t0 = now();
+    for(i = 0; i < N; ++i)
+        s += gsl_rng_uniform(rng);
+    printf("%-22s %8.2f ns/draw\n", "uniforms", 1e9 * (now() - t0) / N);
+    t0 = now();
+    for(i = 0; i < N; ++i)
+        s += gsl_ran_gaussian_ziggurat(rng, 1.0);
+    printf("%-22s %8.2f ns/draw\n", "gsl ziggurat", 1e9 * (now() - t0) / N);
+
+    printf("\n%-14s %10s", "ns/draw", "rtnorm");
+    for(kn = 0; kn < 3; ++kn)
+        printf(" %10s", name[kn]);
+    printf("\n");
+    for(j = 0; j < (int) (sizeof(c) / sizeof(c[0])); ++j) {
+        printf("[%4g,%4g]    ", c[j].a, c[j].b);
+        t0 = now();
+        rtnorm_fill(rng, c[j].a, c[j].b, 0.0, 1.0, N, v);
+        printf(" %10.2f", 1e9 * (now() - t0) / N);
+        for(kn = 0; kn < 3; ++kn) {
+            if(!rtnormf_set_simd(name[kn])) {
+                printf(" %10s", "-");
+                continue;
+            }
+            t0 = now();
+            rtnormf_fill(rng, c[j].a, c[j].b, 0.0f, 1.0f, N, vf);
+            printf(" %10.2f", 1e9 * (now() - t0) / N);
+        }
+        printf("\n");
+        s += v[N / 2] + vf[N / 2];
+    }
+    rtnormf_set_simd(best);
+    printf("(sum %g)\n", s);
+    free(v);
+    free(vf);
+    gsl_rng_free(rng);
+    return 0;
+}
@@ -0,0 +1,41 @@
+//  Helpers shared by the unit tests. See stats.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#include <math.h>
+#include <stdlib.h>
+#include <gsl/gsl_sf_erf.h>
+
+#include "stats.h"
+
+static int  compare(const void *x, const void *y);
+
+static int compare(const void *x, const void *y) {
+    double      u = *(const double *) x, w = *(const double *) y;
+    return (u > w) - (u < w);
+}
+
+double stats_log_upper(double z) {
+    if(isinf(z))
+        return z > 0 ? -INFINITY : 0.0;
+    return gsl_sf_log_erfc(z * M_SQRT1_2) - M_LN2;
+}
+
+double stats_ks_uniform(double *u, size_t n) {
+    qsort(u, n, sizeof(double), compare);
+    return stats_ks_sorted(u, n);
+}
+
+double stats_ks_sorted(const double *u, size_t n) {
+    double      d = 0.0;
+    size_t      i;
+
+    for(i = 0; i < n; ++i) {
+        if(u[i] - (double) i / n > d)
+            d = u[i] - (double) i / n;
+        if((double) (i + 1) / n - u[i] > d)
+            d = (double) (i + 1) / n - u[i];
+    }
+    return d * sqrt((double) n);
+}
@@ -0,0 +1,25 @@
+//  Helpers shared by the unit tests: the log of the Gaussian upper
+//  tail, and the Kolmogorov-Smirnov statistic against U(0,1). A test
+//  of a sample against a distribution function F passes the values
+//  of F at the sample, which are uniform if the sample follows F.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#ifndef __STATS_H
+#define __STATS_H
+
+#include <stddef.h>
+
+// log Q(z), Q being the upper tail probability of the standard
+// Gaussian: -INFINITY at +INFINITY, 0 at -INFINITY.
+double      stats_log_upper(double z);
+
+// Kolmogorov-Smirnov statistic of u[0..n-1] against U(0,1), scaled by
+// sqrt(n). Sorts u.
+double      stats_ks_uniform(double *u, size_t n);
+
+// As stats_ks_uniform, for u already in nondecreasing order
+double      stats_ks_sorted(const double *u, size_t n);
+
+#endif //__STATS_H
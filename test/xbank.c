@@ -0,0 +1,144 @@
+//  Unit tests for bank.c.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtnorm_impl.h"
+#include "chunks.h"
+#include "bank.h"
+
+int main(int argc, char **argv) {
+    int         verbose = 0, fd;
+    off_t       off;
+    const char *fname = "xbank.tmp";
+    size_t      i, j, len, n = 2 * RTNORM_CHUNK + 1000;
+    Bank       *bank;
+    const BankHeader *h;
+    const double *v;
+    double     *w = malloc(RTNORM_CHUNK * sizeof(double));
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(strncmp(argv[1], "-v", 2) != 0) {
+            fprintf(stderr, "usage: xbank [-v]\n");
+            exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        fprintf(stderr, "usage: xbank [-v]\n");
+        exit(EXIT_FAILURE);
+    }
+    assert(w && rng);
+
+    assert(bank_checksum("abc", 3) != bank_checksum("abd", 3));
+    assert(bank_checksum(w, 0) == bank_checksum(w, 0));
+    assert(rtnorm_table_version() == rtnorm_table_version());
+
+    bank_write(fname, -1.0, 3.0, 1.0, 2.0, gsl_rng_taus, 17, n, 2);
+    bank = bank_open(fname);
+    assert(bank != NULL);
+    h = bank_header(bank);
+    assert(h->n == n);
+    assert(h->nblocks == 3);
+    assert(h->block_len == RTNORM_CHUNK);
+    assert(h->seed == 17);
+    assert(strcmp(h->generator, "taus") == 0);
+    assert(h->a == -1.0 && h->b == 3.0 && h->mu == 1.0 && h->sigma == 2.0);
+    assert(h->data_offset % 4096 == 0 && h->block_stride % 4096 == 0);
+    assert(h->table_version == rtnorm_table_version());
+    if(verbose)
+        printf("data_offset=%llu block_stride=%llu\n",
+               (unsigned long long) h->data_offset,
+               (unsigned long long) h->block_stride);
+
+    // Blocks are reproducible from the header alone.
+    for(i = 0; i < h->nblocks; ++i) {
+        v = bank_block(bank, i, &len);
+        assert(len == (i < 2 ? RTNORM_CHUNK : 1000));
+        assert(((size_t) v) % 4096 == 0);
+        gsl_rng_set(rng, chunk_seed(17, i));
+        rtnorm_fill(rng, -1.0, 3.0, 1.0, 2.0, len, w);
+        assert(memcmp(v, w, len * sizeof(double)) == 0);
+        for(j = 0; j < len; ++j)
+            assert(-1.0 <= v[j] && v[j] <= 3.0);
+        assert(bank_verify(bank, i));
+        assert(bank_regenerate(bank, i) == 1);
+    }
+
+    // Streaming stores leave the values unchanged, whatever the
+    // alignment of the output.
+    {
+        double     *s = malloc((RTNORM_CHUNK + 1) * sizeof(double));
+        size_t      old = rtnorm_set_stream_bytes(0);
+
+        assert(s);
+        for(j = 0; j < 2; ++j) {
+            len = RTNORM_CHUNK - j;
+            gsl_rng_set(rng, 3);
+            rtnorm_fill(rng, -1.0, 3.0, 1.0, 2.0, len, s + j);
+            rtnorm_set_stream_bytes(SIZE_MAX);
+            gsl_rng_set(rng, 3);
+            rtnorm_fill(rng, -1.0, 3.0, 1.0, 2.0, len, w);
+            rtnorm_set_stream_bytes(0);
+            assert(memcmp(s + j, w, len * sizeof(double)) == 0);
+            gsl_rng_set(rng, 3);
+            rtnorm_fill_cached(rng, -1.0, 3.0, 1.0, 2.0, len, w);
+            assert(memcmp(s + j, w, len * sizeof(double)) == 0);
+        }
+
+        // rtnorm_stream_copy copies any length to any offset.
+        for(j = 0; j < 16; ++j) {
+            memset(s, 0, 64 * sizeof(double));
+            rtnorm_stream_copy((char *) s + j, w, 400 - j);
+            assert(memcmp((char *) s + j, w, 400 - j) == 0);
+            assert(((char *) s)[400] == 0);
+        }
+        assert(rtnorm_set_stream_bytes(old) == 0);
+        free(s);
+    }
+
+    v = bank_block(bank, 1, &len);
+    assert(bank_value(bank, RTNORM_CHUNK + 5) == v[5]);
+    off = h->data_offset + h->block_stride + 8;
+    bank_close(bank);
+
+    // Corrupt one value of block 1.
+    fd = open(fname, O_RDWR);
+    assert(fd >= 0);
+    assert(pwrite(fd, "x", 1, off) == 1);
+    close(fd);
+    bank = bank_open(fname);
+    assert(bank != NULL);
+    assert(bank_verify(bank, 0));
+    assert(!bank_verify(bank, 1));
+    assert(bank_regenerate(bank, 1) == 0);
+    bank_close(bank);
+
+    // A corrupt header is rejected.
+    fd = open(fname, O_RDWR);
+    assert(pwrite(fd, "\x7f", 1, offsetof(BankHeader, seed)) == 1);
+    close(fd);
+    assert(bank_open(fname) == NULL);
+
+    unlink(fname);
+    gsl_rng_free(rng);
+    free(w);
+    printf("%-26s %s\n", "xbank", "OK");
+    return 0;
+}
@@ -0,0 +1,67 @@
+//  Unit tests for binio.c.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "binio.h"
+
+int main(int argc, char **argv) {
+    int         verbose = 0;
+    char        hdr[NPY_HEADER_SIZE];
+    char        fname[] = "xbinio.tmp";
+    size_t      size, i, n = 1000;
+    double     *d;
+    float       f[3] = { 1.0f, -2.0f, 0.5f };
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(strncmp(argv[1], "-v", 2) != 0) {
+            fprintf(stderr, "usage: xbinio [-v]\n");
+            exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        fprintf(stderr, "usage: xbinio [-v]\n");
+        exit(EXIT_FAILURE);
+    }
+
+    assert(npy_header(hdr, "<f8", 123456789) == NPY_HEADER_SIZE);
+    assert(NPY_HEADER_SIZE % 64 == 0);
+    assert(memcmp(hdr, "\x93NUMPY\x01\x00", 8) == 0);
+    assert(hdr[8] + 256 * hdr[9] == NPY_HEADER_SIZE - 10);
+    assert(hdr[NPY_HEADER_SIZE - 1] == '\n');
+    assert(memchr(hdr + 10, '\0', NPY_HEADER_SIZE - 10) == NULL);
+    assert(strstr(hdr + 10, "'shape': (123456789,)") != NULL);
+    if(verbose)
+        printf("%.*s", NPY_HEADER_SIZE - 10, hdr + 10);
+
+    // Byte order conversion is an involution.
+    binio_le32(f, 3);
+    binio_le32(f, 3);
+    assert(f[0] == 1.0f && f[1] == -2.0f && f[2] == 0.5f);
+
+    // Round trip through a mapped file.
+    d = binio_map_out(fname, n * sizeof(double));
+    for(i = 0; i < n; ++i)
+        d[i] = i + 0.25;
+    binio_unmap(d, n * sizeof(double));
+    d = binio_map_in(fname, &size);
+    assert(size == n * sizeof(double));
+    for(i = 0; i < n; ++i)
+        assert(d[i] == i + 0.25);
+    binio_unmap(d, size);
+    unlink(fname);
+
+    printf("%-26s %s\n", "xbinio", "OK");
+    return 0;
+}
@@ -0,0 +1,158 @@
+//  Unit tests for rtnorm_cache.c.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtnorm_cache.h"
+
+#define NTHREADS 4
+#define NI 50                   // intervals
+#define M 20000                 // draws per thread
+
+typedef struct Arg {
+    unsigned long seed;
+    double      out[M];
+} Arg;
+
+static double lo[NI], hi[NI], mu[NI];
+static size_t row[M];
+
+static void draw(unsigned long seed, double *out);
+static void *worker(void *varg);
+
+// M draws from the intervals in the order given by row
+static void draw(unsigned long seed, double *out) {
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    size_t      i;
+
+    assert(rng);
+    gsl_rng_set(rng, seed);
+    for(i = 0; i < M; ++i)
+        out[i] = rtnorm(rng, lo[row[i]], hi[row[i]], mu[row[i]], 2.0);
+    gsl_rng_free(rng);
+}
+
+static void *worker(void *varg) {
+    Arg        *arg = varg;
+
+    draw(arg->seed, arg->out);
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    int         verbose = 0, i;
+    double      ref[M], v[M];
+    double      a[4] = {-1.0, 0.0, 3.0, 0.5};
+    double      b[4] = {1.0, INFINITY, 4.0, 0.51};
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    pthread_t   thread[NTHREADS];
+    Arg        *arg = malloc(NTHREADS * sizeof(Arg));
+    unsigned long hits, misses;
+    size_t      j;
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(strncmp(argv[1], "-v", 2) != 0) {
+            fprintf(stderr, "usage: xcache [-v]\n");
+            exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        fprintf(stderr, "usage: xcache [-v]\n");
+        exit(EXIT_FAILURE);
+    }
+    assert(rng && arg);
+
+    // Intervals in every regime, drawn from in a random order
+    for(i = 0; i < NI; ++i) {
+        lo[i] = -6.0 + 0.25 * i;
+        hi[i] = lo[i] + (i % 3 == 0 ? INFINITY : 0.1 + 0.05 * i);
+        mu[i] = 0.1 * (i % 7);
+    }
+    gsl_rng_set(rng, 7);
+    for(j = 0; j < M; ++j)
+        row[j] = gsl_rng_uniform_int(rng, NI);
+
+    draw(1, ref);
+
+    // Caching changes no output, whether plans hit or miss.
+    rtnorm_cache_enable(1000);
+    draw(1, v);
+    assert(memcmp(ref, v, sizeof(v)) == 0);
+    rtnorm_cache_stats(&hits, &misses);
+    if(verbose)
+        printf("capacity 1000: %lu hits, %lu misses\n", hits, misses);
+    assert(hits + misses == M);
+    assert(misses >= NI && misses < M / 10);
+
+    rtnorm_cache_enable(8);
+    draw(1, v);
+    assert(memcmp(ref, v, sizeof(v)) == 0);
+    rtnorm_cache_stats(&hits, &misses);
+    if(verbose)
+        printf("capacity 8: %lu hits, %lu misses\n", hits, misses);
+    assert(hits + misses == M);
+    assert(misses > NI);
+
+    // Four intervals always hit after their first miss, but a thousand
+    // in rotation are evicted before their next use.
+    rtnorm_cache_enable(4);
+    for(j = 0; j < 400; ++j)
+        rtnorm_fill(rng, a[j % 4], b[j % 4], 0.0, 1.0, 3, v);
+    rtnorm_cache_stats(&hits, &misses);
+    assert(hits == 396 && misses == 4);
+    rtnorm_cache_enable(4);
+    for(j = 0; j < 10000; ++j)
+        rtnorm(rng, 0.001 * (j % 1000), 5.0, 0.0, 1.0);
+    rtnorm_cache_stats(&hits, &misses);
+    if(verbose)
+        printf("rotation: %lu hits, %lu misses\n", hits, misses);
+    assert(hits + misses == 10000 && misses > 9000);
+
+    // Standardized intervals share plans.
+    rtnorm_cache_enable(16);
+    rtnorm(rng, -1.0, 1.0, 0.0, 1.0);
+    rtnorm(rng, 1.0, 5.0, 3.0, 2.0);
+    rtnorm_cache_stats(&hits, &misses);
+    assert(hits == 1 && misses == 1);
+
+    // Threads sharing a cache too small for their intervals draw what
+    // they would without it.
+    rtnorm_cache_enable(16);
+    for(i = 0; i < NTHREADS; ++i) {
+        arg[i].seed = i + 1;
+        assert(pthread_create(thread + i, NULL, worker, arg + i) == 0);
+    }
+    for(i = 0; i < NTHREADS; ++i)
+        pthread_join(thread[i], NULL);
+    rtnorm_cache_stats(&hits, &misses);
+    if(verbose)
+        printf("%d threads: %lu hits, %lu misses\n", NTHREADS, hits, misses);
+    assert(hits + misses == NTHREADS * M);
+    rtnorm_cache_disable();
+    for(i = 0; i < NTHREADS; ++i) {
+        draw(i + 1, ref);
+        assert(memcmp(ref, arg[i].out, sizeof(ref)) == 0);
+    }
+
+    rtnorm_cache_stats(&hits, &misses);
+    assert(hits == 0 && misses == 0);
+
+    gsl_rng_free(rng);
+    free(arg);
+    printf("%-26s %s\n", "xcache", "OK");
+    return 0;
+}
@@ -0,0 +1,106 @@
+//  Unit tests for chunks.c and rtnorm_fill.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "chunks.h"
+
+#define NCHUNKS 7
+
+typedef struct Arg {
+    double     *out;
+    int         count[NCHUNKS];
+} Arg;
+
+static void fill(gsl_rng * rng, long chunk, void *varg);
+
+static void fill(gsl_rng * rng, long chunk, void *varg) {
+    Arg        *arg = varg;
+
+    rtnorm_fill(rng, -1.0, 2.0, 0.5, 2.0, RTNORM_CHUNK,
+                arg->out + chunk * RTNORM_CHUNK);
+    arg->count[chunk] += 1;
+}
+
+int main(int argc, char **argv) {
+    int         verbose = 0;
+    size_t      i, n = NCHUNKS * RTNORM_CHUNK;
+    double     *v1 = malloc(n * sizeof(double));
+    double     *v4 = malloc(n * sizeof(double));
+    Arg         arg;
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(strncmp(argv[1], "-v", 2) != 0) {
+            fprintf(stderr, "usage: xchunks [-v]\n");
+            exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        fprintf(stderr, "usage: xchunks [-v]\n");
+        exit(EXIT_FAILURE);
+    }
+    assert(v1 && v4 && rng);
+
+    // rtnorm_fill reproduces a sequence of calls to rtnorm.
+    double      a[] = { -1.0, -3.0, 4.0, -9.0, 0.5, -0.5 };
+    double      b[] = { 2.0, -2.5, 6.0, 8.0, 0.502, 0.5 };
+    for(int j = 0; j < (int) (sizeof(a) / sizeof(a[0])); ++j) {
+        gsl_rng_set(rng, 123 + j);
+        for(i = 0; i < 1000; ++i)
+            v1[i] = rtnorm(rng, a[j], b[j], 1.0, 1.5);
+        gsl_rng_set(rng, 123 + j);
+        rtnorm_fill(rng, a[j], b[j], 1.0, 1.5, 1000, v4);
+        assert(memcmp(v1, v4, 1000 * sizeof(double)) == 0);
+        for(i = 0; i < 1000; ++i)
+            assert(a[j] <= v1[i] && v1[i] <= b[j]);
+    }
+
+    // Seeds of neighboring chunks and streams differ.
+    assert(chunk_seed(1, 0) != chunk_seed(1, 1));
+    assert(chunk_seed(1, 0) != chunk_seed(2, 0));
+
+    // Output does not depend on the number of threads, and each
+    // chunk is generated exactly once.
+    memset(&arg, 0, sizeof(arg));
+    arg.out = v1;
+    chunks_run(gsl_rng_taus, 42, 0, NCHUNKS, 1, fill, &arg);
+    for(i = 0; i < NCHUNKS; ++i)
+        assert(arg.count[i] == 1);
+
+    memset(&arg, 0, sizeof(arg));
+    arg.out = v4;
+    chunks_run(gsl_rng_taus, 42, 0, 3, 4, fill, &arg);
+    chunks_run(gsl_rng_taus, 42, 3, NCHUNKS - 3, 4, fill, &arg);
+    for(i = 0; i < NCHUNKS; ++i)
+        assert(arg.count[i] == 1);
+    assert(memcmp(v1, v4, n * sizeof(double)) == 0);
+
+    // A different seed gives different output.
+    chunks_run(gsl_rng_taus, 43, 0, NCHUNKS, 2, fill, &arg);
+    assert(memcmp(v1, v4, n * sizeof(double)) != 0);
+
+    assert(chunks_rng_type("taus") == gsl_rng_taus);
+    assert(chunks_rng_type("no such generator") == NULL);
+
+    if(verbose)
+        printf("first values: %lf %lf\n", v1[0], v1[1]);
+
+    gsl_rng_free(rng);
+    free(v1);
+    free(v4);
+    printf("%-26s %s\n", "xchunks", "OK");
+    return 0;
+}
@@ -0,0 +1,183 @@
+//  Unit tests for columns.c, rtnorm_fill_rows and
+//  rtnorm_fill_rows_sorted.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "chunks.h"
+#include "binio.h"
+#include "columns.h"
+
+// Write n doubles to file fname, optionally as a .npy array.
+static void write_column(const char *fname, const double *v, size_t n,
+                         int npy);
+
+static void write_column(const char *fname, const double *v, size_t n,
+                         int npy) {
+    size_t      off = npy ? NPY_HEADER_SIZE : 0;
+    char       *map = binio_map_out(fname, off + n * sizeof(double));
+
+    if(npy)
+        npy_header(map, "<f8", n);
+    memcpy(map + off, v, n * sizeof(double));
+    binio_unmap(map, off + n * sizeof(double));
+}
+
+int main(int argc, char **argv) {
+    int         verbose = 0;
+    size_t      i, k, n = 3 * RTNORM_CHUNK + 17, size, off;
+    double     *a = malloc(n * sizeof(double));
+    double     *b = malloc(n * sizeof(double));
+    double     *mu = malloc(n * sizeof(double));
+    double     *sigma = malloc(n * sizeof(double));
+    double     *v = malloc(n * sizeof(double));
+    double      a2[1000], b2[1000], mu2[1000], sigma2[1000];
+    double     *out, *out2;
+    char        descr[8];
+    size_t      nout;
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(strncmp(argv[1], "-v", 2) != 0) {
+            fprintf(stderr, "usage: xcolumns [-v]\n");
+            exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        fprintf(stderr, "usage: xcolumns [-v]\n");
+        exit(EXIT_FAILURE);
+    }
+    assert(a && b && mu && sigma && v && rng);
+
+    for(i = 0; i < n; ++i) {
+        mu[i] = (i % 7) - 3.0;
+        sigma[i] = 0.5 + (i % 5);
+        a[i] = mu[i] + sigma[i] * ((int) (i % 11) - 5.25);
+        b[i] = a[i] + sigma[i] * (0.001 + (i % 3));
+    }
+
+    // rtnorm_fill_rows matches rtnorm row by row.
+    gsl_rng_set(rng, 7);
+    for(i = 0; i < 1000; ++i)
+        v[i] = rtnorm(rng, a[i], b[i], mu[i], sigma[i]);
+    gsl_rng_set(rng, 7);
+    rtnorm_fill_rows(rng, 1000, a, b, mu, sigma, v + 1000);
+    assert(memcmp(v, v + 1000, 1000 * sizeof(double)) == 0);
+
+    // NULL mu and sigma mean 0 and 1.
+    gsl_rng_set(rng, 7);
+    for(i = 0; i < 1000; ++i)
+        v[i] = rtnorm(rng, a[i], b[i], 0.0, 1.0);
+    gsl_rng_set(rng, 7);
+    rtnorm_fill_rows(rng, 1000, a, b, NULL, NULL, v + 1000);
+    assert(memcmp(v, v + 1000, 1000 * sizeof(double)) == 0);
+
+    // Sorted rows of one interval are drawn in row order, ...
+    gsl_rng_set(rng, 7);
+    rtnorm_fill(rng, a[0], b[0], mu[0], sigma[0], 1000, v);
+    for(i = 0; i < 1000; ++i) {
+        a2[i] = a[0];
+        b2[i] = b[0];
+        mu2[i] = mu[0];
+        sigma2[i] = sigma[0];
+    }
+    gsl_rng_set(rng, 7);
+    rtnorm_fill_rows_sorted(rng, 1000, a2, b2, mu2, sigma2, v + 1000);
+    assert(memcmp(v, v + 1000, 1000 * sizeof(double)) == 0);
+
+    // ... rows further left first, and rows beyond the boxes last,
+    // whatever the scaling.
+    for(i = 0; i < 999; ++i) {
+        a2[i] = i % 3 == 0 ? 1.0 : i % 3 == 1 ? -1.0 : 5.0;
+        b2[i] = a2[i] + 0.5;
+        mu2[i] = i % 2 ? 0.0 : 2.0;
+        sigma2[i] = i % 2 ? 1.0 : 3.0;
+        a2[i] = mu2[i] + sigma2[i] * a2[i];
+        b2[i] = mu2[i] + sigma2[i] * b2[i];
+    }
+    gsl_rng_set(rng, 7);
+    rtnorm_fill(rng, -1.0, -0.5, 0.0, 1.0, 333, v);
+    rtnorm_fill(rng, 1.0, 1.5, 0.0, 1.0, 333, v + 333);
+    rtnorm_fill(rng, 5.0, 5.5, 0.0, 1.0, 333, v + 666);
+    gsl_rng_set(rng, 7);
+    rtnorm_fill_rows_sorted(rng, 999, a2, b2, mu2, sigma2, v + 1000);
+    for(i = 0; i < 999; ++i) {
+        k = (i % 3 == 1 ? 0 : i % 3 == 0 ? 1 : 2) * 333 + i / 3;
+        assert(fabs((v[1000 + i] - mu2[i]) / sigma2[i] - v[k]) < 1e-12);
+    }
+
+    // Column files, raw and .npy.
+    write_column("xcolumns_a.tmp", a, n, 0);
+    write_column("xcolumns_b.tmp", b, n, 1);
+    write_column("xcolumns_mu.tmp", mu, n, 0);
+    write_column("xcolumns_sigma.tmp", sigma, n, 1);
+
+    assert(rtnorm_columns("xcolumns_a.tmp", "xcolumns_b.tmp",
+                          "xcolumns_mu.tmp", "xcolumns_sigma.tmp",
+                          "xcolumns_out1.tmp", gsl_rng_taus, 99, 1) == n);
+    out = binio_map_in("xcolumns_out1.tmp", &size);
+    assert(size == n * sizeof(double));
+    for(i = 0; i < n; ++i)
+        assert(a[i] <= out[i] && out[i] <= b[i]);
+
+    // Each chunk matches rtnorm_fill_rows with the chunk's seed.
+    for(i = 0; i < n; i += RTNORM_CHUNK) {
+        size_t      m = n - i < RTNORM_CHUNK ? n - i : RTNORM_CHUNK;
+        gsl_rng_set(rng, chunk_seed(99, i / RTNORM_CHUNK));
+        rtnorm_fill_rows(rng, m, a + i, b + i, mu + i, sigma + i, v + i);
+    }
+    assert(memcmp(v, out, n * sizeof(double)) == 0);
+
+    // Output has the format of column a, and does not depend on the
+    // number of threads.
+    write_column("xcolumns_anpy.tmp", a, n, 1);
+    rtnorm_columns("xcolumns_anpy.tmp", "xcolumns_b.tmp",
+                   "xcolumns_mu.tmp", "xcolumns_sigma.tmp",
+                   "xcolumns_out2.tmp", gsl_rng_taus, 99, 3);
+    out2 = binio_map_in("xcolumns_out2.tmp", &size);
+    off = npy_parse((char *) out2, size, descr, &nout);
+    assert(off == NPY_HEADER_SIZE);
+    assert(strcmp(descr, "<f8") == 0 && nout == n);
+    assert(memcmp(out, (char *) out2 + off, n * sizeof(double)) == 0);
+    binio_unmap(out2, size);
+
+    rtnorm_columns("xcolumns_a.tmp", "xcolumns_b.tmp",
+                   "xcolumns_mu.tmp", "xcolumns_sigma.tmp",
+                   "xcolumns_out2.tmp", gsl_rng_taus, 99, 4);
+    out2 = binio_map_in("xcolumns_out2.tmp", &size);
+    assert(memcmp(out, out2, n * sizeof(double)) == 0);
+    if(verbose)
+        printf("out[0]=%lf out[n-1]=%lf\n", out[0], out[n - 1]);
+
+    binio_unmap(out, n * sizeof(double));
+    binio_unmap(out2, size);
+    unlink("xcolumns_a.tmp");
+    unlink("xcolumns_anpy.tmp");
+    unlink("xcolumns_b.tmp");
+    unlink("xcolumns_mu.tmp");
+    unlink("xcolumns_sigma.tmp");
+    unlink("xcolumns_out1.tmp");
+    unlink("xcolumns_out2.tmp");
+    gsl_rng_free(rng);
+    free(a);
+    free(b);
+    free(mu);
+    free(sigma);
+    free(v);
+    printf("%-26s %s\n", "xcolumns", "OK");
+    return 0;
+}
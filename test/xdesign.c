@@ -0,0 +1,352 @@
+//  Unit tests for design.c, record.c, rtnorm_cost and the thresholds of
+//  rtnorm.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#define _GNU_SOURCE
+#undef NDEBUG
+#include <assert.h>
+#include <dlfcn.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "design.h"
+#include "record.h"
+
+#define M 200000
+
+// A generator that counts the uniforms drawn from another
+static gsl_rng *inner;
+static unsigned long ncalls;
+
+static void counting_set(void *state, unsigned long seed);
+static unsigned long counting_get(void *state);
+static double counting_get_double(void *state);
+static void read_array(FILE * fp, const char *name, double *out, int n);
+
+static void counting_set(void *state, unsigned long seed) {
+    if(inner)
+        gsl_rng_set(inner, seed);
+}
+
+static unsigned long counting_get(void *state) {
+    ++ncalls;
+    return gsl_rng_get(inner);
+}
+
+static double counting_get_double(void *state) {
+    ++ncalls;
+    return gsl_rng_uniform(inner);
+}
+
+static const gsl_rng_type counting = {
+    "counting", 0xffffffffUL, 0, sizeof(int),
+    counting_set, counting_get, counting_get_double
+};
+
+// Calls to log, counted by standing in for the library's
+static unsigned long nlogs;
+
+double log(double z) {
+    static double (*libm_log) (double);
+
+    if(libm_log == NULL)
+        libm_log = (double (*)(double)) dlsym(RTLD_NEXT, "log");
+    ++nlogs;
+    return libm_log(z);
+}
+
+// Read the n values of the array called name in a file written by
+// design_write.
+static void read_array(FILE * fp, const char *name, double *out, int n) {
+    char        word[64];
+    int         k, ch;
+
+    rewind(fp);
+    while(fscanf(fp, "%63s", word) == 1)
+        if(strncmp(word, name, strlen(name)) == 0
+           && word[strlen(name)] == '[')
+            break;
+    while((ch = fgetc(fp)) != '{')
+        assert(ch != EOF);
+    for(k = 0; k < n; ++k)
+        assert(fscanf(fp, " %lf ,", out + k) == 1);
+}
+
+int main(int argc, char **argv) {
+    int         verbose = 0, i, k, nbad;
+    Design     *d, *s;
+    RtnormCost  c;
+    const RtnormTable *t = &rtnorm_table;
+    gsl_rng    *rng;
+    double     *v = malloc(M * sizeof(double)), p, se;
+    double     *ra, *rb, *rc, total;
+    size_t      n, j;
+    char        fname[] = "xdesign.tmp";
+    struct {
+        double      a, b;
+    } iv[] = {
+        {-1.0, 1.0},
+        {0.0, INFINITY},
+        {-0.3, 2.5},
+        {-2.0, 3.0},
+        {1.0, 1.2},
+        {0.5, 0.51},
+        {0.5, 0.5015},
+        {3.0, INFINITY},
+        {4.0, 6.0},
+    };
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(strncmp(argv[1], "-v", 2) != 0) {
+            fprintf(stderr, "usage: xdesign [-v]\n");
+            exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        fprintf(stderr, "usage: xdesign [-v]\n");
+        exit(EXIT_FAILURE);
+    }
+    inner = gsl_rng_alloc(gsl_rng_taus);
+    rng = gsl_rng_alloc(&counting);
+    assert(v && inner && rng);
+    gsl_rng_set(rng, 1);
+
+    // Built from scratch, the shipped design reproduces its tables.
+    d = design_build(1954, 2047, 5);
+    assert(d);
+    assert(d->t.N == t->N);
+    assert(d->t.kmode == t->kmode);
+    assert(d->t.kmin == 5);
+    assert(d->t.I0 == t->I0);
+    assert(d->t.nncell == t->nncell);
+    assert(fabs(d->t.xmin - t->xmin) < 1e-6);
+    assert(fabs(d->t.xmax - t->xmax) < 1e-6);
+    assert(fabs(d->t.INVH / t->INVH - 1.0) < 1e-3);
+    assert(fabs(d->t.yl0 / t->yl0 - 1.0) < 1e-5);
+    assert(fabs(d->t.ylN / t->ylN - 1.0) < 1e-5);
+    for(k = 0; k <= t->N; ++k)
+        assert(fabs(d->t.x[k] - t->x[k]) < 1e-6);
+    for(k = 0; k < t->N; ++k)
+        assert(fabs(d->t.yu[k] / t->yu[k] - 1.0) < 1e-5);
+    for(i = nbad = 0; i < t->nncell; ++i)
+        nbad += d->t.ncell[i] != t->ncell[i];
+    if(verbose)
+        printf("rebuilt xmax %.11f, %d ncell entries differ\n",
+               d->t.xmax, nbad);
+    assert(nbad <= 2);
+    design_free(d);
+
+    // A span reaches xmin, and xmax to within a box.
+    d = design_span(-1.0, 2.5, 4);
+    assert(d);
+    assert(d->t.x[0] <= -1.0 && d->t.x[1] > -1.0);
+    assert(fabs(d->t.xmax - 2.5) < d->t.x[d->t.N] - d->t.x[d->t.N - 1]);
+    assert(d->t.x[d->t.kmode + 1] == 0.0);
+    design_free(d);
+
+    // design_write prints computed tables exactly.
+    {
+        FILE       *fp = tmpfile();
+        double     *w;
+
+        d = design_build(1954, 2047, 5);
+        w = malloc((d->t.N + 1) * sizeof(double));
+        assert(fp && d && w);
+        design_write(d, fp);
+        read_array(fp, "x", w, d->t.N + 1);
+        assert(memcmp(w, d->t.x, (d->t.N + 1) * sizeof(double)) == 0);
+        read_array(fp, "yu", w, d->t.N);
+        assert(memcmp(w, d->t.yu, d->t.N * sizeof(double)) == 0);
+        design_free(d);
+        fclose(fp);
+        free(w);
+    }
+
+    // The density lies within the squeeze of every box.
+    for(k = 0; k < t->N; ++k) {
+        RtnormSqueeze q;
+        double      h = (t->x[k + 1] - t->x[k]) / 64, z, f;
+
+        rtnorm_table_squeeze(t, k, &q);
+        for(j = 0; j <= 64; ++j) {
+            z = j * h;
+            f = exp(-0.5 * (t->x[k] + z) * (t->x[k] + z)) / sqrt(2 * M_PI);
+            assert(fabs(f - (q.c0 + z * (q.c1 + z * q.c2))) <= q.eps);
+        }
+        assert(q.eps < 0.01 * t->yu[k]);
+    }
+
+    // Predicted uniforms and logs per draw match the counts.
+    s = design_shipped();
+    for(i = 0; i < (int) (sizeof(iv) / sizeof(iv[0])); ++i) {
+        c = rtnorm_cost(iv[i].a, iv[i].b, 0.0, 1.0);
+        ncalls = nlogs = 0;
+        rtnorm_fill(rng, iv[i].a, iv[i].b, 0.0, 1.0, M, v);
+        if(verbose)
+            printf("[%g,%g] regime %d accept %.4f uniforms %.4f (counted"
+                   " %.4f) logs %.6f (counted %.6f)\n", iv[i].a, iv[i].b,
+                   c.regime, c.accept, c.uniforms, (double) ncalls / M,
+                   c.logs, (double) nlogs / M);
+        assert(c.regime != RTNORM_GAUSSIAN);
+        assert(0.0 < c.accept && c.accept <= 1.0);
+        assert(fabs(c.uniforms * M / ncalls - 1.0) < 0.02);
+        assert(fabs(nlogs - c.logs * M)
+               < 5 * sqrt(c.logs * M) + 0.02 * c.logs * M + 5);
+    }
+
+    // rtnorm_cost standardizes, and agrees with the shipped design.
+    {
+        RtnormCost  e;
+
+        c = rtnorm_cost(1.0, 9.0, 2.0, 3.0);
+        design_cost(s, -1.0 / 3.0, 7.0 / 3.0, &e);
+        assert(c.regime == e.regime && c.accept == e.accept
+               && c.uniforms == e.uniforms && c.logs == e.logs);
+        c = rtnorm_cost(-9.0, -1.0, -2.0, 3.0);
+        assert(c.regime == e.regime && c.accept == e.accept
+               && c.uniforms == e.uniforms && c.logs == e.logs);
+    }
+
+    // A wide interval on the left needs Gaussian draws.
+    design_cost(s, -3.0, 3.0, &c);
+    assert(c.regime == RTNORM_GAUSSIAN);
+    assert(fabs(c.normals - 1.0 / (1.0 - erfc(3.0 * M_SQRT1_2))) < 1e-9);
+
+    // Thresholds move intervals between algorithms without changing
+    // their distribution.
+    {
+        RtnormTable tt = rtnorm_table;
+        RtnormPlan  pl;
+        double      mean, sum;
+
+        assert(tt.xgauss >= tt.xmin && tt.xexp <= tt.xmax);
+        tt.xexp = 1.0;
+        tt.xgauss = -1.0;
+        tt.kmin = 0;
+        rtnorm_plan_init_table(&pl, &tt, 1.5, 2.0);
+        assert(pl.regime == RTNORM_EXPONENTIAL);
+        rtnorm_plan_init_table(&pl, &tt, -1.5, 3.0);
+        assert(pl.regime == RTNORM_GAUSSIAN);
+        rtnorm_plan_init_table(&pl, &tt, -0.5, 0.5001);
+        assert(pl.regime == RTNORM_CHOPIN);
+
+        // Exponential proposal at rate 0 never accepts.
+        tt.kmin = 100;
+        rtnorm_plan_init_table(&pl, &tt, 0.0, 0.01);
+        assert(pl.regime == RTNORM_CHOPIN);
+        assert(rtnorm(rng, 0.0, 1e-4, 0.0, 1.0) <= 1e-4);
+
+        // Mean of [1.5,2] drawn by the exponential proposal
+        tt.kmin = 0;
+        rtnorm_plan_init_table(&pl, &tt, 1.5, 2.0);
+        for(j = 0, sum = 0.0; j < M; ++j)
+            sum += rtnorm_plan_draw(&pl, rng);
+        mean = (exp(-1.125) - exp(-2.0)) / sqrt(2 * M_PI)
+            / (0.5 * (erfc(1.5 * M_SQRT1_2) - erfc(2.0 * M_SQRT1_2)));
+        if(verbose)
+            printf("mean of [1.5,2] %.5f (exact %.5f)\n", sum / M, mean);
+        assert(fabs(sum / M - mean) < 5 * 0.5 / sqrt(12.0 * M));
+    }
+
+    // Beyond xmax, [3, infinity) gets its full share of the tail.
+    rtnorm_fill(rng, 3.0, INFINITY, 0.0, 1.0, M, v);
+    for(j = n = 0; j < M; ++j)
+        n += v[j] > t->xmax;
+    p = erfc(t->xmax * M_SQRT1_2) / erfc(3.0 * M_SQRT1_2);
+    se = sqrt(p * (1 - p) / M);
+    if(verbose)
+        printf("fraction beyond xmax %.5f (exact %.5f)\n", (double) n / M, p);
+    assert(fabs((double) n / M - p) < 5 * se);
+
+    // Recording counts draws, and the histogram survives a round trip.
+    record_start();
+    rtnorm_fill(rng, 0.5, 1.0, 0.0, 1.0, 100, v);
+    rtnorm(rng, -2.0, -1.0, 0.0, 1.0);
+    record_stop();
+    rtnorm(rng, -2.0, -1.0, 0.0, 1.0);
+    assert(record_count() == 101);
+    assert(record_save(fname) == 0);
+    assert(record_load(fname, &n, &ra, &rb, &rc) == 0);
+    unlink(fname);
+    assert(n == 2);
+    for(j = 0, total = 0.0; j < n; ++j) {
+        total += rc[j];
+        if(rc[j] == 100.0) {
+            assert(fabs(ra[j] - 0.5) < 1.0 / 16);
+            assert(fabs(log10((rb[j] - ra[j]) / 0.5)) < 7.0 / 64);
+        } else {
+            assert(rc[j] == 1.0);
+            assert(fabs(ra[j] - 1.0) < 1.0 / 16);
+        }
+    }
+    assert(total == 101.0);
+    free(ra);
+    free(rb);
+    free(rc);
+
+    // The version covers the thresholds as well as the boxes.
+    {
+        RtnormTable tt = *t;
+        unsigned long long ver = rtnorm_table_version();
+
+        assert(rtnorm_table_hash(&tt) == ver);
+        tt.kmin += 1;
+        assert(rtnorm_table_hash(&tt) != ver);
+        tt = *t;
+        tt.xgauss += 0.01;
+        assert(rtnorm_table_hash(&tt) != ver);
+        tt = *t;
+        tt.xexp -= 0.01;
+        assert(rtnorm_table_hash(&tt) != ver);
+    }
+
+    // Tables moved to a huge page are aligned copies, and draws from
+    // them do not change, nor does the version.
+    {
+        unsigned long long ver = rtnorm_table_version();
+        const double *x0 = t->x, *yu0 = t->yu;
+        const int  *ncell0 = t->ncell;
+        double     *w = malloc(M * sizeof(double));
+        int         kind;
+
+        assert(w);
+        gsl_rng_set(rng, 11);
+        rtnorm_fill(rng, -1.0, 1.5, 0.0, 1.0, M, v);
+        kind = rtnorm_table_hugepage();
+        if(verbose)
+            printf("rtnorm_table_hugepage: %d\n", kind);
+        assert(-1 <= kind && kind <= 2);
+        assert(rtnorm_table_hugepage() == kind);
+        if(kind >= 0) {
+            assert(t->x != x0 && t->yu != yu0 && t->ncell != ncell0);
+            assert((size_t) t->x % 4096 == 0);
+            assert((size_t) t->yu % 64 == 0 && (size_t) t->ncell % 64 == 0);
+            assert(memcmp(t->x, x0, (t->N + 1) * sizeof(double)) == 0);
+            assert(memcmp(t->yu, yu0, t->N * sizeof(double)) == 0);
+            assert(memcmp(t->ncell, ncell0, t->nncell * sizeof(int)) == 0);
+        }
+        gsl_rng_set(rng, 11);
+        rtnorm_fill(rng, -1.0, 1.5, 0.0, 1.0, M, w);
+        assert(memcmp(v, w, M * sizeof(double)) == 0);
+        assert(rtnorm_table_version() == ver);
+        free(w);
+    }
+
+    design_free(s);
+    gsl_rng_free(rng);
+    gsl_rng_free(inner);
+    free(v);
+    printf("%-26s %s\n", "xdesign", "OK");
+    return 0;
+}
@@ -0,0 +1,104 @@
+//  Unit tests for reduce.c.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "reduce.h"
+
+#define N 100003
+#define NBINS 10
+
+static double square(double x, void *data);
+
+static double square(double x, void *data) {
+    return x * x;
+}
+
+int main(int argc, char **argv) {
+    int         verbose = 0, i;
+    double     *v = malloc(N * sizeof(double));
+    double      sum = 0.0, sumsq = 0.0, s1 = 0.0, s2 = 0.0, mean, var;
+    double      a = -1.0, b = 2.5, mu = 0.5, sigma = 1.5, e;
+    unsigned long count[NBINS], count2[NBINS], tot;
+    RtnormMoments m = { 0 }, m1 = { 0 }, m2 = { 0 };
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(strncmp(argv[1], "-v", 2) != 0) {
+            fprintf(stderr, "usage: xreduce [-v]\n");
+            exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        fprintf(stderr, "usage: xreduce [-v]\n");
+        exit(EXIT_FAILURE);
+    }
+    assert(v && rng);
+
+    // Reference values from stored samples
+    gsl_rng_set(rng, 3);
+    rtnorm_fill(rng, a, b, mu, sigma, N, v);
+    memset(count2, 0, sizeof(count2));
+    for(i = 0; i < N; ++i) {
+        s1 += v[i];
+        s2 += v[i] * v[i];
+        count2[(int) ((v[i] - a) * NBINS / (b - a))] += 1;
+    }
+    mean = s1 / N;
+    var = s2 / N - mean * mean;
+
+    gsl_rng_set(rng, 3);
+    rtnorm_sums(rng, a, b, mu, sigma, N, &sum, &sumsq);
+    assert(fabs(sum - s1) < 1e-9 * fabs(s1));
+    assert(fabs(sumsq - s2) < 1e-9 * s2);
+
+    gsl_rng_set(rng, 3);
+    rtnorm_moments(rng, a, b, mu, sigma, N, &m);
+    assert(m.n == N);
+    assert(fabs(m.mean - mean) < 1e-12);
+    assert(fabs(m.m2 / m.n - var) < 1e-9);
+
+    // Merging moments of two halves gives the moments of the whole.
+    gsl_rng_set(rng, 3);
+    rtnorm_moments(rng, a, b, mu, sigma, 50000, &m1);
+    rtnorm_moments(rng, a, b, mu, sigma, N - 50000, &m2);
+    rtnorm_moments_merge(&m1, &m2);
+    assert(m1.n == N);
+    assert(fabs(m1.mean - m.mean) < 1e-12);
+    assert(fabs(m1.m2 - m.m2) < 1e-9 * m.m2);
+
+    memset(count, 0, sizeof(count));
+    gsl_rng_set(rng, 3);
+    rtnorm_hist(rng, a, b, mu, sigma, N, a, b, NBINS, count);
+    for(tot = i = 0; i < NBINS; ++i) {
+        assert(count[i] == count2[i]);
+        tot += count[i];
+    }
+    assert(tot == N);
+
+    gsl_rng_set(rng, 3);
+    e = rtnorm_expect(rng, a, b, mu, sigma, N, square, NULL);
+    assert(fabs(e - s2 / N) < 1e-12 * e);
+    assert(isnan(rtnorm_expect(rng, a, b, mu, sigma, 0, square, NULL)));
+
+    if(verbose)
+        printf("mean=%lf var=%lf E[X^2]=%lf\n", m.mean, m.m2 / m.n, e);
+
+    gsl_rng_free(rng);
+    free(v);
+    printf("%-26s %s\n", "xreduce", "OK");
+    return 0;
+}
@@ -0,0 +1,294 @@
+//  Unit tests for rtinv.c.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtinv.h"
+#include "stats.h"
+
+#define N 50000
+
+// Strata in the tests of stratified and Latin hypercube sampling, and
+// how far the CDF of a value may stray outside its stratum
+#define NS 2000
+#define TOL 1e-9
+
+// Critical value of the Kolmogorov-Smirnov statistic, times sqrt(n),
+// at level 0.001
+#define KS_CRIT 1.95
+
+static void cdf2(double a, double b, double x, double *f, double *s);
+
+// CDF *f and survival function *s at x of the standard Gaussian
+// truncated to [a,b], each computed without subtraction from 1, so
+// that both stay accurate far into either tail.
+static void cdf2(double a, double b, double x, double *f, double *s) {
+    double      la, r, m;
+
+    if(x <= a) {
+        *f = 0.0, *s = 1.0;
+        return;
+    }
+    if(x >= b) {
+        *f = 1.0, *s = 0.0;
+        return;
+    }
+    if(b <= 0.0) {
+        cdf2(-b, -a, -x, s, f);
+        return;
+    }
+    if(a >= 0.0) {
+        la = stats_log_upper(a);
+        r = exp(stats_log_upper(b) - la);
+        *f = -expm1(stats_log_upper(x) - la) / (1.0 - r);
+        *s = (exp(stats_log_upper(x) - la) - r) / (1.0 - r);
+        return;
+    }
+    m = 1.0 - exp(stats_log_upper(-a)) - exp(stats_log_upper(b));
+    *f = (exp(stats_log_upper(-x)) - exp(stats_log_upper(-a))) / m;
+    *s = (exp(stats_log_upper(x)) - exp(stats_log_upper(b))) / m;
+}
+
+int main(int argc, char **argv) {
+    int         verbose = 0, j, k, max;
+    size_t      i;
+    double     *u = malloc(N * sizeof(double));
+    double     *w = malloc(N * sizeof(double));
+    double      d, f, s, r, m0, m1, v0, v1;
+    double      nn[] = { 1.0, 10.0, 1e6, 1e15 };
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    struct {
+        double      a, b, mu, sigma;
+    } c[] = {
+        {-INFINITY, INFINITY, 0.0, 1.0},
+        {-1.0, 2.0, 0.0, 1.0},
+        {0.5, INFINITY, 0.0, 1.0},
+        {-5.0, -4.5, 0.0, 1.0},
+        {3.0, 9.0, 2.0, 0.25},
+        {40.0, INFINITY, 0.0, 1.0},
+        {-60.0, -45.0, 0.0, 1.0},
+    };
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(strncmp(argv[1], "-v", 2) != 0) {
+            fprintf(stderr, "usage: xrtinv [-v]\n");
+            exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        fprintf(stderr, "usage: xrtinv [-v]\n");
+        exit(EXIT_FAILURE);
+    }
+    assert(u && w && rng);
+    gsl_rng_set(rng, 7);
+
+    // The largest of n draws has CDF F^n, and the smallest has
+    // survival function (1-F)^n: either, evaluated at the draws, is
+    // uniform.
+    for(j = 0; j < (int) (sizeof(c) / sizeof(c[0])); ++j) {
+        for(k = 0; k < (int) (sizeof(nn) / sizeof(nn[0])); ++k) {
+            for(max = 0; max < 2; ++max) {
+                // Extremes of so many draws lie closer to a finite
+                // bound than doubles there can resolve.
+                if(nn[k] > 1e9 && !isinf(max ? c[j].b : c[j].a))
+                    continue;
+                for(i = 0; i < N; ++i) {
+                    if(max)
+                        r = rtnorm_max(rng, nn[k], c[j].a, c[j].b, c[j].mu,
+                                       c[j].sigma);
+                    else
+                        r = rtnorm_min(rng, nn[k], c[j].a, c[j].b, c[j].mu,
+                                       c[j].sigma);
+                    assert(c[j].a <= r && r <= c[j].b);
+                    cdf2((c[j].a - c[j].mu) / c[j].sigma,
+                         (c[j].b - c[j].mu) / c[j].sigma,
+                         (r - c[j].mu) / c[j].sigma, &f, &s);
+                    u[i] = max ? exp(nn[k] * log1p(-s))
+                        : exp(nn[k] * log1p(-f));
+                }
+                d = stats_ks_uniform(u, N);
+                if(verbose)
+                    printf("[%g, %g] %s of %g: KS %.3f\n", c[j].a, c[j].b,
+                           max ? "max" : "min", nn[k], d);
+                assert(d < KS_CRIT);
+            }
+        }
+    }
+
+    // Same means as the extremes of n draws from rtnorm
+    for(max = 0; max < 2; ++max) {
+        m0 = m1 = v0 = v1 = 0.0;
+        for(i = 0; i < N; ++i) {
+            rtnorm_fill(rng, -1.0, 2.0, 0.5, 1.5, 10, w);
+            r = w[0];
+            for(k = 1; k < 10; ++k)
+                r = max ? fmax(r, w[k]) : fmin(r, w[k]);
+            m0 += r;
+            v0 += r * r;
+            r = max ? rtnorm_max(rng, 10.0, -1.0, 2.0, 0.5, 1.5)
+                : rtnorm_min(rng, 10.0, -1.0, 2.0, 0.5, 1.5);
+            m1 += r;
+            v1 += r * r;
+        }
+        m0 /= N, m1 /= N;
+        v0 = v0 / N - m0 * m0;
+        v1 = v1 / N - m1 * m1;
+        if(verbose)
+            printf("%s of 10: mean %.5f by rtnorm, %.5f direct\n",
+                   max ? "max" : "min", m0, m1);
+        assert(fabs(m0 - m1) < 5.0 * sqrt((v0 + v1) / N));
+    }
+
+    // Stratified: value i lies in stratum i, at a position uniform in
+    // probability within it.
+    for(j = 0; j < (int) (sizeof(c) / sizeof(c[0])); ++j) {
+        rtnorm_fill_stratified(rng, c[j].a, c[j].b, c[j].mu, c[j].sigma,
+                               NS, u);
+        for(i = 0; i < NS; ++i) {
+            assert(c[j].a <= u[i] && u[i] <= c[j].b);
+            cdf2((c[j].a - c[j].mu) / c[j].sigma,
+                 (c[j].b - c[j].mu) / c[j].sigma,
+                 (u[i] - c[j].mu) / c[j].sigma, &f, &s);
+            assert((double) i / NS - TOL <= f);
+            assert(f <= (double) (i + 1) / NS + TOL);
+            assert((double) (NS - 1 - i) / NS - TOL <= s);
+            assert(s <= (double) (NS - i) / NS + TOL);
+            w[i] = fmin(fmax(NS * f - i, 0.0), 1.0);
+        }
+        d = stats_ks_uniform(w, NS);
+        if(verbose)
+            printf("[%g, %g] stratified: KS within strata %.3f\n", c[j].a,
+                   c[j].b, d);
+        assert(d < KS_CRIT);
+    }
+
+    // Narrow intervals, straddling 0 or deep in a tail, where the
+    // density is nearly flat: value i lies in stratum i of the
+    // interval's width, up to the spacing of doubles there.
+    {
+        struct {
+            double      a, b, tol;
+        } e[] = {
+            {-5e-15, 5e-15, 1e-9},
+            {-1e-9, 2e-9, 1e-6},
+            {5.0, 5.0 + 1e-9, 2e-6},
+            {-60.0, -60.0 + 1e-9, 2e-5},
+        };
+
+        for(j = 0; j < (int) (sizeof(e) / sizeof(e[0])); ++j) {
+            rtnorm_fill_stratified(rng, e[j].a, e[j].b, 0.0, 1.0, NS, u);
+            for(i = 0; i < NS; ++i) {
+                assert(e[j].a <= u[i] && u[i] <= e[j].b);
+                f = (u[i] - e[j].a) / (e[j].b - e[j].a);
+                assert((double) i / NS - e[j].tol <= f);
+                assert(f <= (double) (i + 1) / NS + e[j].tol);
+            }
+            if(verbose)
+                printf("[%g, %g] stratified: first %.17g, last %.17g\n",
+                       e[j].a, e[j].b, u[0], u[NS - 1]);
+        }
+    }
+
+    // Latin hypercube: every stratum of every margin holds exactly one
+    // point, and margins are assigned strata independently.
+    {
+        double      a[3] = { -1.0, 40.0, -60.0 };
+        double      b[3] = { 2.0, INFINITY, -45.0 };
+        double      sigma[3] = { 2.0, 1.0, 1.0 };
+        int        *seen = calloc(3 * NS, sizeof(int)), same = 1;
+        size_t      kk[3];
+
+        assert(seen);
+        rtnorm_fill_lhs(rng, NS, 3, a, b, NULL, sigma, u);
+        for(i = 0; i < NS; ++i) {
+            for(j = 0; j < 3; ++j) {
+                r = u[i * 3 + j];
+                assert(a[j] <= r && r <= b[j]);
+                cdf2(a[j] / sigma[j], b[j] / sigma[j], r / sigma[j], &f,
+                     &s);
+                kk[j] = f * NS;
+                kk[j] = kk[j] < NS ? kk[j] : NS - 1;
+                ++seen[j * NS + kk[j]];
+                w[j * NS + i] = fmin(fmax(NS * f - kk[j], 0.0), 1.0);
+            }
+            same &= kk[0] == kk[1] && kk[1] == kk[2];
+        }
+        for(i = 0; i < 3 * NS; ++i)
+            assert(seen[i] == 1);
+        assert(!same);
+        d = stats_ks_uniform(w, 3 * NS);
+        if(verbose)
+            printf("Latin hypercube: KS within strata %.3f\n", d);
+        assert(d < KS_CRIT);
+        free(seen);
+    }
+
+    // Antithetic pairs: partners have complementary CDFs, each half of
+    // the pairs has the distribution of rtnorm, and on intervals
+    // symmetric about mu partners are mirror images.
+    for(j = 0; j < (int) (sizeof(c) / sizeof(c[0])); ++j) {
+        rtnorm_fill_antithetic(rng, c[j].a, c[j].b, c[j].mu, c[j].sigma,
+                               N, u);
+        m0 = 0.0;
+        for(i = 0; i < N; ++i) {
+            assert(c[j].a <= u[i] && u[i] <= c[j].b);
+            cdf2((c[j].a - c[j].mu) / c[j].sigma,
+                 (c[j].b - c[j].mu) / c[j].sigma,
+                 (u[i] - c[j].mu) / c[j].sigma, &f, &s);
+            if(i % 2 == 0)
+                m0 = f;
+            else
+                assert(fabs(m0 + f - 1.0) < TOL);
+            w[i / 2 + (i % 2) * (N / 2)] = f;
+        }
+        d = fmax(stats_ks_uniform(w, N / 2), stats_ks_uniform(w + N / 2, N / 2));
+        if(verbose)
+            printf("[%g, %g] antithetic: KS %.3f\n", c[j].a, c[j].b, d);
+        assert(d < KS_CRIT);
+    }
+    rtnorm_fill_antithetic(rng, -3.0, 3.0, 0.0, 2.0, 1001, u);
+    for(i = 0; i + 1 < 1001; i += 2)
+        assert(u[i] == -u[i + 1]);
+    assert(-3.0 <= u[1000] && u[1000] <= 3.0);
+    rtnorm_fill_antithetic(rng, -1.5, 2.5, 0.5, 2.0, 1001, u);
+    for(i = 0; i + 1 < 1001; i += 2)
+        assert(fabs(u[i] + u[i + 1] - 1.0) < 1e-14);
+
+    // Rows give the same values as calls one at a time.
+    {
+        double      a[4] = { -1.0, 0.5, -60.0, 3.0 };
+        double      b[4] = { 2.0, INFINITY, -45.0, 9.0 };
+        double      mu[4] = { 0.0, 1.0, 0.0, 2.0 };
+        double      sigma[4] = { 1.0, 2.0, 1.0, 0.25 };
+        double      n[4] = { 3.0, 1e9, 7.5, 1.0 };
+
+        gsl_rng_set(rng, 9);
+        rtnorm_max_rows(rng, 4, n, a, b, mu, sigma, u);
+        rtnorm_min_rows(rng, 4, n, a, b, NULL, NULL, u + 4);
+        gsl_rng_set(rng, 9);
+        for(i = 0; i < 4; ++i)
+            w[i] = rtnorm_max(rng, n[i], a[i], b[i], mu[i], sigma[i]);
+        for(i = 0; i < 4; ++i)
+            w[4 + i] = rtnorm_min(rng, n[i], a[i], b[i], 0.0, 1.0);
+        assert(memcmp(u, w, 8 * sizeof(double)) == 0);
+    }
+
+    printf("%-26s %s\n", "xrtinv", "OK");
+    free(u);
+    free(w);
+    gsl_rng_free(rng);
+    return 0;
+}
@@ -12,9 +12,14 @@
 //  Depends: LibGSL
 //  OS: Unix based system
 
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
 #include <stdio.h>
 #include <gsl/gsl_rng.h>
+#include <gsl/gsl_cdf.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "rtnorm.h"
 
@@ -30,6 +35,53 @@ int main(void) {
     gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
     gsl_rng_set(rng, (unsigned long) time(NULL));
 
+    //--- the top of narrow intervals ---
+    // Each interval spans a handful of boxes, and its top tenth must
+    // get its share of the draws. kb was once the box holding the left
+    // end of b's grid cell, which left the top of many intervals empty.
+    gsl_rng    *fixed = gsl_rng_alloc(gsl_rng_taus);
+    gsl_rng_set(fixed, 1);
+    for(int j = 0; j < 40; j++) {
+        double      lo = 0.1 + 0.0371 * j, hi = lo + 0.006;
+        double      cut = hi - 0.0006, p;
+        int         n = 0, m = 20000;
+
+        p = (gsl_cdf_ugaussian_Q(cut) - gsl_cdf_ugaussian_Q(hi))
+            / (gsl_cdf_ugaussian_Q(lo) - gsl_cdf_ugaussian_Q(hi));
+        for(int k = 0; k < m; k++)
+            n += rtnorm(fixed, lo, hi, 0.0, 1.0) > cut;
+        assert(fabs((double) n / m - p) < 5 * sqrt(p * (1 - p) / m));
+    }
+
+    //--- the right tail ---
+    // Draws from [2, inf) beyond 3.6, past the last box, must have the
+    // Gaussian share. A rejected tail proposal once sent the sampler
+    // back to choose a box, which took about 7% of it away.
+    {
+        double      p = gsl_cdf_ugaussian_Q(3.6) / gsl_cdf_ugaussian_Q(2.0);
+        int         n = 0, m = 2000000;
+
+        for(int k = 0; k < m; k++)
+            n += rtnorm(fixed, 2.0, INFINITY, 0.0, 1.0) > 3.6;
+        assert(fabs((double) n / m - p) < 5 * sqrt(p * (1 - p) / m));
+    }
+
+    //--- narrow intervals with an end at 0 ---
+    // These span fewer than kmin boxes but cannot use the exponential
+    // proposal, whose rate would be 0; they once looped forever, so
+    // give up after a few seconds rather than hang.
+    alarm(10);
+    for(int k = 0; k < 1000; k++) {
+        x = rtnorm(fixed, 0.0, 1e-4, 0.0, 1.0);
+        assert(0.0 <= x && x <= 1e-4);
+        x = rtnorm(fixed, -1e-4, 0.0, 0.0, 1.0);
+        assert(-1e-4 <= x && x <= 0.0);
+        x = rtnorm(fixed, 2.0, 2.0 + 3e-4, 2.0, 3.0);
+        assert(2.0 <= x && x <= 2.0 + 3e-4);
+    }
+    alarm(0);
+    gsl_rng_free(fixed);
+
     //--- generate and display the random numbers ---
     printf("underlying distribution: Normal(%lf, %lf)\n", mu, sigma);
     printf("truncated interval: [%lf, %lf]\n", a, b);
@@ -0,0 +1,288 @@
+//  Unit tests for rtnormf.c: Kolmogorov-Smirnov tests of each vector
+//  kernel against the exact distribution function, and agreement
+//  between kernels, for one interval and for a different one per row.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_cdf.h>
+
+#include "rtnormf.h"
+#include "xoshiro.h"
+#include "stats.h"
+
+#define N 100000
+
+// sqrt(N) times the KS statistic exceeds this with probability 0.001.
+#define KS_CRIT 1.95
+
+static double cdf(double z, double a, double b);
+static double ks(const float *v, double *u, size_t n, double a, double b,
+                 double mu, double sigma);
+static double row_cdf(double v, double a, double b, double mu,
+                      double sigma);
+
+// Distribution function of the standard Gaussian truncated to [a,b],
+// computed from whichever tail keeps it accurate. In the right tail,
+// work with logs, because the upper tail probabilities underflow.
+static double cdf(double z, double a, double b) {
+    if(a >= 0.0)
+        return -expm1(stats_log_upper(z) - stats_log_upper(a))
+            / -expm1(stats_log_upper(b) - stats_log_upper(a));
+    return (gsl_cdf_ugaussian_P(z) - gsl_cdf_ugaussian_P(a))
+        / (gsl_cdf_ugaussian_P(b) - gsl_cdf_ugaussian_P(a));
+}
+
+// sqrt(n) times the Kolmogorov-Smirnov statistic of v. Fills u with
+// the distribution function at v, sorted.
+static double ks(const float *v, double *u, size_t n, double a, double b,
+                 double mu, double sigma) {
+    size_t      i;
+
+    for(i = 0; i < n; ++i)
+        u[i] = cdf((v[i] - mu) / sigma, (a - mu) / sigma, (b - mu) / sigma);
+    return stats_ks_uniform(u, n);
+}
+
+// Distribution function of a row at v. Left of the mode, use the
+// mirror image, whose tail cdf keeps accurate.
+static double row_cdf(double v, double a, double b, double mu,
+                      double sigma) {
+    double      z = (v - mu) / sigma, za = (a - mu) / sigma;
+    double      zb = (b - mu) / sigma;
+
+    if(zb <= 0.0)
+        return 1.0 - cdf(-z, -zb, -za);
+    return cdf(z, za, zb);
+}
+
+int main(int argc, char **argv) {
+    int         verbose = 0, j, kn;
+    size_t      i;
+    float      *v = malloc(N * sizeof(float));
+    float      *w = malloc(N * sizeof(float));
+    float      *ra = malloc(N * sizeof(float));
+    float      *rb = malloc(N * sizeof(float));
+    float      *rmu = malloc(N * sizeof(float));
+    float      *rsig = malloc(N * sizeof(float));
+    double     *u = malloc(N * sizeof(double)), lo, width;
+    double      d;
+    float       r;
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    const char *name[] = { "generic", "avx2", "avx512" };
+    const char *best;
+    struct {
+        float       a, b, mu, sigma;
+    } c[] = {
+        {-1.0, 1.0, 0.0, 1.0},
+        {-INFINITY, INFINITY, 0.0, 1.0},
+        {0.0, INFINITY, 0.0, 1.0},
+        {-INFINITY, 2.0, 0.0, 1.0},
+        {-0.3, 3.2, 0.0, 1.0},
+        {2.0, 12.0, 10.0, 2.5},
+        {0.4, 0.45, 0.0, 1.0},
+        {4.0, 6.0, 0.0, 1.0},
+        {40.0, 41.0, 0.0, 1.0},
+        {-2.5, -2.2, 0.0, 1.0},
+        {-3.0, 20.0, -1.0, 0.5},
+        {-2.1, 2.3, 0.0, 1.0},
+        {-5.0, 3.0, 0.0, 1.0},
+        {-12.0, 1.0, 2.0, 3.0},
+    };
+    const int   ncases = sizeof(c) / sizeof(c[0]);
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(strncmp(argv[1], "-v", 2) != 0) {
+            fprintf(stderr, "usage: xrtnormf [-v]\n");
+            exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        fprintf(stderr, "usage: xrtnormf [-v]\n");
+        exit(EXIT_FAILURE);
+    }
+    assert(v && w && ra && rb && rmu && rsig && u && rng);
+
+    best = rtnormf_simd();
+    if(verbose)
+        printf("default kernel: %s\n", best);
+    assert(!rtnormf_set_simd("nonesuch"));
+    assert(strcmp(rtnormf_simd(), best) == 0);
+
+    for(kn = 0; kn < 3; ++kn) {
+        if(!rtnormf_set_simd(name[kn])) {
+            assert(kn > 0);
+            continue;
+        }
+        for(j = 0; j < ncases; ++j) {
+            gsl_rng_set(rng, j + 1);
+            rtnormf_fill(rng, c[j].a, c[j].b, c[j].mu, c[j].sigma, N, v);
+            for(i = 0; i < N; ++i)
+                assert(c[j].a <= v[i] && v[i] <= c[j].b);
+            d = ks(v, u, N, c[j].a, c[j].b, c[j].mu, c[j].sigma);
+            if(verbose)
+                printf("%-8s [%g,%g] mu=%g sigma=%g: KS=%.3f\n", name[kn],
+                       c[j].a, c[j].b, c[j].mu, c[j].sigma, d);
+            assert(d < KS_CRIT);
+        }
+
+        // Same seed, same candidates: kernels agree to within rounding.
+        gsl_rng_set(rng, 100);
+        rtnormf_fill(rng, -1.5f, 2.5f, 0.0f, 1.0f, N, v);
+        rtnormf_set_simd("generic");
+        gsl_rng_set(rng, 100);
+        rtnormf_fill(rng, -1.5f, 2.5f, 0.0f, 1.0f, N, w);
+        for(i = 0; i < N; ++i)
+            assert(fabsf(v[i] - w[i]) <= 4e-7f * (1.0f + fabsf(w[i])));
+
+        // The ziggurat kernels agree exactly.
+        rtnormf_set_simd(name[kn]);
+        gsl_rng_set(rng, 102);
+        rtnormf_fill(rng, -2.1f, 2.3f, 0.0f, 1.0f, N, v);
+        rtnormf_set_simd("generic");
+        gsl_rng_set(rng, 102);
+        rtnormf_fill(rng, -2.1f, 2.3f, 0.0f, 1.0f, N, w);
+        assert(memcmp(v, w, N * sizeof(float)) == 0);
+    }
+    rtnormf_set_simd(best);
+
+    // Rows from every regime, in both orientations, mixed
+    gsl_rng_set(rng, 200);
+    for(i = 0; i < N; ++i) {
+        rmu[i] = 10.0 * gsl_rng_uniform(rng) - 5.0;
+        rsig[i] = exp(4.0 * gsl_rng_uniform(rng) - 2.0);
+        switch (i % 5) {
+        case 0:                // Chopin's boxes, or a short interval
+            lo = 6.0 * gsl_rng_uniform(rng) - 3.0;
+            width = exp(6.5 * gsl_rng_uniform(rng) - 5.0);
+            break;
+        case 1:                // wide, reaching into the left tail
+            lo = -2.2 - 6.0 * gsl_rng_uniform(rng);
+            width = -lo + 5.0 * gsl_rng_uniform(rng) - 1.0;
+            break;
+        case 2:                // the right tail
+            lo = 3.5 + 6.5 * gsl_rng_uniform(rng);
+            width = INFINITY;
+            break;
+        case 3:                // left of the mode, to be flipped
+            lo = -3.0 - 2.0 * gsl_rng_uniform(rng);
+            width = exp(3.0 * gsl_rng_uniform(rng) - 3.0);
+            break;
+        default:
+            lo = -INFINITY;
+            width = INFINITY;
+        }
+        ra[i] = rmu[i] + rsig[i] * lo;
+        rb[i] = isinf(width) ? INFINITY : rmu[i] + rsig[i] * (lo + width);
+        if(i % 10 == 7) {       // the right tail, mirrored
+            float       tmp = ra[i];
+            ra[i] = 2 * rmu[i] - rb[i];
+            rb[i] = 2 * rmu[i] - tmp;
+        }
+    }
+    for(kn = 0; kn < 3; ++kn) {
+        if(!rtnormf_set_simd(name[kn]))
+            continue;
+        gsl_rng_set(rng, 201);
+        rtnormf_fill_rows(rng, N, ra, rb, rmu, rsig, v);
+        for(i = 0; i < N; ++i) {
+            assert(ra[i] <= v[i] && v[i] <= rb[i]);
+            u[i] = row_cdf(v[i], ra[i], rb[i], rmu[i], rsig[i]);
+        }
+        d = stats_ks_uniform(u, N);
+        if(verbose)
+            printf("%-8s rows: KS=%.3f\n", name[kn], d);
+        assert(d < KS_CRIT);
+
+        // Kernels plan alike, so they agree to within rounding.
+        rtnormf_set_simd("generic");
+        gsl_rng_set(rng, 201);
+        rtnormf_fill_rows(rng, N, ra, rb, rmu, rsig, w);
+        for(i = 0; i < N; ++i)
+            assert(fabsf(v[i] - w[i])
+                   <= 4e-7f * (fabsf(w[i]) + 4.0f * rsig[i]));
+    }
+    rtnormf_set_simd(best);
+
+    // Without mu and sigma, rows are standard; any block length works.
+    for(i = 0; i < 1000; ++i) {
+        ra[i] = 2.0 * (i % 7) - 6.0;
+        rb[i] = ra[i] + 0.5 * (i % 3) + 0.01;
+        rmu[i] = 0.0f;
+        rsig[i] = 1.0f;
+    }
+    for(j = 1; j <= 1000; j += 333) {
+        gsl_rng_set(rng, 202);
+        rtnormf_fill_rows(rng, j, ra, rb, NULL, NULL, v);
+        gsl_rng_set(rng, 202);
+        rtnormf_fill_rows(rng, j, ra, rb, rmu, rsig, w);
+        assert(memcmp(v, w, j * sizeof(float)) == 0);
+        for(i = 0; i < (size_t) j; ++i)
+            assert(ra[i] <= v[i] && v[i] <= rb[i]);
+    }
+
+    // Uniforms filled in bulk by xoshiro256+x8
+    {
+        gsl_rng    *x8 = gsl_rng_alloc(rtnorm_rng_xoshiro256px8);
+
+        assert(x8);
+        for(j = 0; j < ncases; ++j) {
+            gsl_rng_set(x8, j + 1);
+            rtnormf_fill(x8, c[j].a, c[j].b, c[j].mu, c[j].sigma, N, v);
+            d = ks(v, u, N, c[j].a, c[j].b, c[j].mu, c[j].sigma);
+            if(verbose)
+                printf("x8       [%g,%g] mu=%g sigma=%g: KS=%.3f\n",
+                       c[j].a, c[j].b, c[j].mu, c[j].sigma, d);
+            assert(d < KS_CRIT);
+        }
+        gsl_rng_free(x8);
+    }
+
+    // The ziggurat's tail beyond its base rectangle, at 3.4426, holds
+    // 2 Q(3.4426) = 5.762e-4 of the mass.
+    gsl_rng_set(rng, 103);
+    for(j = kn = 0; j < 10; ++j) {
+        rtnormf_fill(rng, -INFINITY, INFINITY, 0.0f, 1.0f, N, v);
+        for(i = 0; i < N; ++i)
+            kn += fabsf(v[i]) > 3.442619855899f;
+    }
+    if(verbose)
+        printf("%d values beyond 3.4426 in %d\n", kn, 10 * N);
+    assert(fabs(kn - 576.2) < 5 * sqrt(576.2));
+
+    // Far in the tail, floats cannot resolve the distribution, but
+    // values must still lie within bounds and near a.
+    gsl_rng_set(rng, 101);
+    rtnormf_fill(rng, 5000.0f, INFINITY, 0.0f, 1.0f, N, v);
+    for(i = 0; i < N; ++i)
+        assert(v[i] >= 5000.0f && v[i] < 5000.01f);
+
+    // Short runs and single draws
+    for(i = 0; i < 100; ++i) {
+        r = rtnormf(rng, -0.5f, 1.5f, 0.0f, 1.0f);
+        assert(-0.5f <= r && r <= 1.5f);
+        rtnormf_fill(rng, 0.2f, 3.0f, 0.0f, 1.0f, i % 7, v);
+    }
+
+    gsl_rng_free(rng);
+    free(v);
+    free(w);
+    free(ra);
+    free(rb);
+    free(rmu);
+    free(rsig);
+    free(u);
+    printf("%-26s %s\n", "xrtnormf", "OK");
+    return 0;
+}
@@ -0,0 +1,255 @@
+//  Unit tests for rtnorm.hpp: Kolmogorov-Smirnov tests with engines
+//  of each width, bulk generation, reductions checked against
+//  rtnorm_reduce, and the requirements of a RandomNumberDistribution.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <random>
+#include <sstream>
+#include <vector>
+#include <gsl/gsl_rng.h>
+
+// The C function rtnorm and namespace rtnorm cannot share the global
+// scope; see rtnorm.hpp.
+namespace capi {
+extern "C" {
+#include "rtnorm.h"
+#include "reduce.h"
+}
+}
+#include "rtnorm.hpp"
+
+#define N 20000
+
+// sqrt(N) times the KS statistic exceeds this with probability 0.001.
+#define KS_CRIT 1.95
+
+// Upper tail probability of the standard Gaussian
+static double upper(double z) {
+    return 0.5 * std::erfc(z * M_SQRT1_2);
+}
+
+// Distribution function of the standard Gaussian truncated to [a,b],
+// computed from whichever tail keeps it accurate.
+static double cdf(double z, double a, double b) {
+    if(a >= 0.0)
+        return (upper(a) - upper(z)) / (upper(a) - upper(b));
+    return (upper(-z) - upper(-a)) / (upper(-b) - upper(-a));
+}
+
+// sqrt(n) times the Kolmogorov-Smirnov statistic. Sorts v.
+template<class T>
+static double ks(std::vector<T> &v, double a, double b, double mu,
+                 double sigma) {
+    double      d = 0.0, f;
+    std::size_t i, n = v.size();
+
+    std::sort(v.begin(), v.end());
+    for(i = 0; i < n; ++i) {
+        f = cdf((v[i] - mu) / sigma, (a - mu) / sigma, (b - mu) / sigma);
+        d = std::max(d, std::fabs(f - (double) i / n));
+        d = std::max(d, std::fabs(f - (double) (i + 1) / n));
+    }
+    return d * std::sqrt((double) n);
+}
+
+// Engine whose uniforms, as rtnorm.hpp makes them from 64-bit output,
+// are exactly those gsl_rng_uniform draws from gen, so that the C and
+// C++ samplers see the same random numbers.
+struct gsl_engine {
+    typedef unsigned long long result_type;
+
+    static constexpr result_type min() {
+        return 0;
+    }
+    static constexpr result_type max() {
+        return ~0ULL;
+    }
+    result_type operator()() {
+        return static_cast<result_type>(std::ldexp(gsl_rng_uniform(gen),
+                                                   64));
+    }
+
+    gsl_rng    *gen;
+};
+
+// Fold for rtnorm_reduce that appends each block to a vector
+static void append(const double *x, std::size_t m, void *state) {
+    auto        v = static_cast<std::vector<double> *>(state);
+
+    v->insert(v->end(), x, x + m);
+}
+
+// Draw N values one at a time and N in bulk from each case, and test
+// both.
+template<class T, class URBG>
+static void check(URBG &g, const char *name, int verbose) {
+    typedef rtnorm::truncated_normal_distribution<T> dist;
+    const double inf = INFINITY;
+    struct {
+        double      a, b, mu, sigma;
+    } c[] = {
+        {-1.0, 1.0, 0.0, 1.0},
+        {-inf, inf, 0.0, 1.0},
+        {0.0, inf, 0.0, 1.0},
+        {-0.3, 3.2, 0.0, 1.0},
+        {2.0, 12.0, 10.0, 2.5},
+        {0.4, 0.45, 0.0, 1.0},
+        {4.0, 6.0, 0.0, 1.0},
+        {-inf, -2.5, 0.0, 1.0},
+        {-3.0, 20.0, -1.0, 0.5},
+    };
+    std::vector<T> v(N);
+    double      d1, d2;
+
+    for(auto &cj : c) {
+        dist        d(cj.a, cj.b, cj.mu, cj.sigma);
+
+        for(auto &x : v)
+            x = d(g);
+        for(auto x : v)
+            assert(cj.a <= x && x <= cj.b);
+        d1 = ks(v, cj.a, cj.b, cj.mu, cj.sigma);
+
+        d.generate(v.begin(), v.end(), g);
+        for(auto x : v)
+            assert(cj.a <= x && x <= cj.b);
+        d2 = ks(v, cj.a, cj.b, cj.mu, cj.sigma);
+        if(verbose)
+            std::printf("%-12s [%g,%g] mu=%g sigma=%g: KS=%.3f %.3f\n",
+                        name, cj.a, cj.b, cj.mu, cj.sigma, d1, d2);
+        assert(d1 < KS_CRIT);
+        assert(d2 < KS_CRIT);
+    }
+}
+
+int main(int argc, char **argv) {
+    int         verbose = 0;
+    std::mt19937_64 g64(1);
+    std::mt19937 g32(2);
+    std::minstd_rand g31(3);
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(std::strncmp(argv[1], "-v", 2) != 0) {
+            std::fprintf(stderr, "usage: xrtnormpp [-v]\n");
+            std::exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        std::fprintf(stderr, "usage: xrtnormpp [-v]\n");
+        std::exit(EXIT_FAILURE);
+    }
+
+    // 64-bit, 32-bit and 31-bit engines take different paths to a
+    // uniform double.
+    check<double>(g64, "mt19937_64", verbose);
+    check<double>(g32, "mt19937", verbose);
+    check<double>(g31, "minstd_rand", verbose);
+    check<float>(g64, "float", verbose);
+
+    // Parameters, equality and streaming
+    {
+        typedef rtnorm::truncated_normal_distribution<> dist;
+        dist        d(-1.0, 2.0, 0.5, 3.0), e;
+        dist::param_type p(0.0, 1.0);
+        std::stringstream ss;
+
+        assert(d.a() == -1.0 && d.b() == 2.0);
+        assert(d.mean() == 0.5 && d.stddev() == 3.0);
+        assert(d.min() == -1.0 && d.max() == 2.0);
+        assert(e.a() == -INFINITY && e.b() == INFINITY);
+        assert(d != e);
+        assert(d.param() != p);
+        e.param(d.param());
+        assert(d == e);
+
+        ss << d;
+        ss >> e;
+        assert(d == e);
+
+        // Copies of one state give the same draws.
+        std::mt19937_64 h1(7), h2(7);
+        for(int i = 0; i < 100; ++i)
+            assert(d(h1) == e(h2));
+
+        // Parameters passed per call
+        for(int i = 0; i < 1000; ++i) {
+            double      x = d(g64, p);
+            assert(0.0 <= x && x <= 1.0);
+        }
+    }
+
+    // generate works through any forward iterator.
+    {
+        rtnorm::truncated_normal_distribution<> d(1.0, 1.5);
+        std::list<double> l(1000);
+
+        d.generate(l.begin(), l.end(), g32);
+        for(auto x : l)
+            assert(1.0 <= x && x <= 1.5);
+    }
+
+    // reduce passes the values rtnorm_reduce would, block by block,
+    // given the same uniforms. The intervals need no Gaussian draws,
+    // which the two samplers make differently.
+    {
+        const double inf = INFINITY;
+        struct {
+            double      a, b;
+        } c[] = {
+            {-1.0, 2.0}, {0.5, 3.0}, {3.0, 6.0}, {0.4, 0.401}, {4.0, inf},
+        };
+        gsl_rng    *gen = gsl_rng_alloc(gsl_rng_taus);
+        gsl_engine  e = { gen };
+        std::vector<double> u, v;
+        std::size_t n = 1000, nblock = 0;
+
+        for(auto &cj : c) {
+            rtnorm::truncated_normal_distribution<> d(cj.a, cj.b);
+
+            u.clear();
+            v.clear();
+            gsl_rng_set(gen, 9);
+            capi::rtnorm_reduce(gen, cj.a, cj.b, 0.0, 1.0, n, append, &u);
+            gsl_rng_set(gen, 9);
+            rtnorm::reduce(d.param(), e, n,
+                           [&](const double *x, std::size_t m) {
+                               assert(m <= RTNORM_REDUCE_BLOCK);
+                               v.insert(v.end(), x, x + m);
+                               ++nblock;
+                           });
+            assert(u == v);
+        }
+        assert(nblock == 5 * ((n + RTNORM_REDUCE_BLOCK - 1)
+                              / RTNORM_REDUCE_BLOCK));
+        gsl_rng_free(gen);
+    }
+
+    // The right tail beyond the last box gets its full share. See
+    // xrtnorm.c.
+    {
+        rtnorm::truncated_normal_distribution<> d(2.0, INFINITY);
+        double      p = upper(3.6) / upper(2.0);
+        int         n = 0, m = 2000000;
+
+        for(int i = 0; i < m; ++i)
+            n += d(g64) > 3.6;
+        assert(std::fabs(double(n) / m - p) < 5 * std::sqrt(p * (1 - p) / m));
+    }
+
+    std::printf("%-26s %s\n", "xrtnormpp", "OK");
+    return 0;
+}
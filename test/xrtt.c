@@ -0,0 +1,148 @@
+//  Unit tests for rtt.c: Kolmogorov-Smirnov tests against the exact
+//  distribution function of the truncated t.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_cdf.h>
+
+#include "rtt.h"
+#include "stats.h"
+
+#define N 20000
+
+// sqrt(N) times the KS statistic exceeds this with probability 0.001.
+#define KS_CRIT 1.95
+
+static double cdf(double t, double a, double b, double nu);
+static double ks(double *v, size_t n, double a, double b, double nu,
+                 double mu, double sigma);
+
+// Distribution function of the standard t truncated to [a,b],
+// computed from whichever tail keeps it accurate.
+static double cdf(double t, double a, double b, double nu) {
+    if(a >= 0.0)
+        return (gsl_cdf_tdist_Q(a, nu) - gsl_cdf_tdist_Q(t, nu))
+            / (gsl_cdf_tdist_Q(a, nu) - gsl_cdf_tdist_Q(b, nu));
+    return (gsl_cdf_tdist_P(t, nu) - gsl_cdf_tdist_P(a, nu))
+        / (gsl_cdf_tdist_P(b, nu) - gsl_cdf_tdist_P(a, nu));
+}
+
+// sqrt(n) times the Kolmogorov-Smirnov statistic. Replaces v by its
+// distribution function values, sorted.
+static double ks(double *v, size_t n, double a, double b, double nu,
+                 double mu, double sigma) {
+    size_t      i;
+
+    for(i = 0; i < n; ++i)
+        v[i] = cdf((v[i] - mu) / sigma, (a - mu) / sigma, (b - mu) / sigma,
+                   nu);
+    return stats_ks_uniform(v, n);
+}
+
+int main(int argc, char **argv) {
+    int         verbose = 0, j;
+    size_t      i;
+    double     *v = malloc(N * sizeof(double));
+    double     *lo = malloc(N * sizeof(double));
+    double     *hi = malloc(N * sizeof(double));
+    double     *df = malloc(N * sizeof(double));
+    double      d, acc;
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    struct {
+        double      a, b, nu, mu, sigma;
+    } c[] = {
+        {-1.0, 1.0, 3.0, 0.0, 1.0},
+        {-2.0, 5.0, 1.0, 1.0, 2.0},
+        {0.0, INFINITY, 4.0, 0.0, 1.0},
+        {3.0, INFINITY, 5.0, 0.0, 1.0},
+        {10.0, 12.0, 30.0, 0.0, 1.0},
+        {50.0, INFINITY, 2.0, 0.0, 1.0},
+        {0.5, 0.51, 3.0, 0.0, 1.0},
+        {-0.01, 0.01, 3.0, 0.0, 1.0},
+        {-INFINITY, -4.0, 7.0, 0.0, 1.0},
+        {-9.0, -6.0, 0.5, 2.0, 3.0},
+        {-INFINITY, INFINITY, 2.5, -1.0, 0.5},
+    };
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(strncmp(argv[1], "-v", 2) != 0) {
+            fprintf(stderr, "usage: xrtt [-v]\n");
+            exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        fprintf(stderr, "usage: xrtt [-v]\n");
+        exit(EXIT_FAILURE);
+    }
+    assert(v && lo && hi && df && rng);
+    gsl_rng_set(rng, 1);
+
+    for(j = 0; j < (int) (sizeof(c) / sizeof(c[0])); ++j) {
+        rtt_fill(rng, c[j].a, c[j].b, c[j].nu, c[j].mu, c[j].sigma, N, v);
+        for(i = 0; i < N; ++i)
+            assert(c[j].a <= v[i] && v[i] <= c[j].b);
+        d = ks(v, N, c[j].a, c[j].b, c[j].nu, c[j].mu, c[j].sigma);
+        acc = rtt_accept((c[j].a - c[j].mu) / c[j].sigma,
+                         (c[j].b - c[j].mu) / c[j].sigma, c[j].nu);
+        if(verbose)
+            printf("[%g,%g] nu=%g: KS=%.3f accept=%.3f\n",
+                   c[j].a, c[j].b, c[j].nu, d, acc);
+        assert(d < KS_CRIT);
+        assert(acc > 0.1 && acc <= 1.0);
+    }
+
+    // Heterogeneous rows: alternate between two intervals, and test
+    // each half separately.
+    for(i = 0; i < N; ++i) {
+        lo[i] = (i % 2) ? 2.0 : -3.0;
+        hi[i] = (i % 2) ? 4.0 : -1.0;
+        df[i] = (i % 2) ? 3.0 : 8.0;
+    }
+    rtt_fill_rows(rng, N, lo, hi, df, NULL, NULL, v);
+    for(i = 0; i < N / 2; ++i) {
+        lo[i] = v[2 * i];
+        hi[i] = v[2 * i + 1];
+    }
+    d = ks(lo, N / 2, -3.0, -1.0, 8.0, 0.0, 1.0);
+    assert(d < KS_CRIT);
+    d = ks(hi, N / 2, 2.0, 4.0, 3.0, 0.0, 1.0);
+    assert(d < KS_CRIT);
+
+    // The fewest degrees of freedom allowed, where the gamma variate
+    // is tiny, and would underflow to 0 without the redraw, most often.
+    for(i = 0; i < N; ++i) {
+        lo[i] = (i % 3 == 0) ? -INFINITY : (i % 3 == 1) ? 1.0 : -2.0;
+        hi[i] = (i % 3 == 0) ? INFINITY : (i % 3 == 1) ? INFINITY : 3.0;
+        df[i] = RTT_NU_MIN;
+    }
+    rtt_fill_rows(rng, N, lo, hi, df, NULL, NULL, v);
+    for(i = 0; i < N; ++i)
+        assert(!isnan(v[i]) && lo[i] <= v[i] && v[i] <= hi[i]);
+    rtt_fill(rng, -2.0, 3.0, RTT_NU_MIN, 0.0, 1.0, N, v);
+    for(i = 0; i < N; ++i)
+        assert(-2.0 <= v[i] && v[i] <= 3.0);
+    d = ks(v, N, -2.0, 3.0, RTT_NU_MIN, 0.0, 1.0);
+    if(verbose)
+        printf("[-2,3] nu=%g: KS=%.3f\n", RTT_NU_MIN, d);
+    assert(d < KS_CRIT);
+
+    gsl_rng_free(rng);
+    free(v);
+    free(lo);
+    free(hi);
+    free(df);
+    printf("%-26s %s\n", "xrtt", "OK");
+    return 0;
+}
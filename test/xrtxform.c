@@ -0,0 +1,146 @@
+//  Unit tests for rtxform.c and fastexp.h.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gsl/gsl_rng.h>
+#include <gsl/gsl_cdf.h>
+
+#include "rtnorm.h"
+#include "fastexp.h"
+#include "rtxform.h"
+
+#define N 200000
+
+static double mean(const double *v, size_t n);
+
+static double mean(const double *v, size_t n) {
+    double      s = 0.0;
+    size_t      i;
+
+    for(i = 0; i < n; ++i)
+        s += v[i];
+    return s / n;
+}
+
+int main(int argc, char **argv) {
+    int         verbose = 0;
+    size_t      i;
+    double     *v = malloc(N * sizeof(double));
+    double     *w = malloc(N * sizeof(double));
+    double      x, e, err, maxerr = 0.0, m, expected, p, z;
+    double      a, b, mu, sigma;
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(strncmp(argv[1], "-v", 2) != 0) {
+            fprintf(stderr, "usage: xrtxform [-v]\n");
+            exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        fprintf(stderr, "usage: xrtxform [-v]\n");
+        exit(EXIT_FAILURE);
+    }
+    assert(v && w && rng);
+
+    // fast_exp is within about 1 ulp wherever exp is a normal double.
+    for(x = -708.0; x < 709.7; x += 0.000937) {
+        e = exp(x);
+        err = fabs(fast_exp(x) - e) / e;
+        if(err > maxerr)
+            maxerr = err;
+    }
+    if(verbose)
+        printf("fast_exp: max relative error %g\n", maxerr);
+    assert(maxerr < 4e-16);
+    assert(fast_exp(0.0) == 1.0);
+    assert(fast_exp(-1000.0) == 0.0);
+    assert(isinf(fast_exp(1000.0)));
+
+    // The log-normal sampler matches exp of rtnorm_fill on log bounds.
+    a = 0.5, b = 4.0, mu = 0.2, sigma = 0.8;
+    gsl_rng_set(rng, 11);
+    rtlnorm_fill(rng, a, b, mu, sigma, N, v);
+    gsl_rng_set(rng, 11);
+    rtnorm_fill(rng, log(a), log(b), mu, sigma, N, w);
+    for(i = 0; i < N; ++i) {
+        assert(a <= v[i] && v[i] <= b);
+        assert(fabs(v[i] - exp(w[i])) <= 4e-16 * v[i]);
+    }
+
+    // Lower bound 0 means no truncation on the left.
+    rtlnorm_fill(rng, 0.0, 1.0, 0.0, 1.0, N, v);
+    for(i = 0; i < N; ++i)
+        assert(0.0 <= v[i] && v[i] <= 1.0);
+
+    // Folded Gaussian: compare the mean with numerical integration
+    // of the density of |Y| over [a,b].
+    a = 0.25, b = 3.0, mu = -0.7, sigma = 1.3;
+    rtfnorm_fill(rng, a, b, mu, sigma, N, v);
+    for(i = 0; i < N; ++i)
+        assert(a <= v[i] && v[i] <= b);
+    {
+        double      num = 0.0, den = 0.0, h = (b - a) / 10000, f;
+        for(x = a + h / 2; x < b; x += h) {
+            f = exp(-0.5 * pow((x - mu) / sigma, 2))
+                + exp(-0.5 * pow((x + mu) / sigma, 2));
+            num += x * f;
+            den += f;
+        }
+        expected = num / den;
+    }
+    m = mean(v, N);
+    if(verbose)
+        printf("folded mean: %lf expected %lf\n", m, expected);
+    assert(fabs(m - expected) < 0.01);
+
+    // Probability of the positive side
+    p = (gsl_cdf_ugaussian_P((b - mu) / sigma)
+         - gsl_cdf_ugaussian_P((a - mu) / sigma));
+    z = (gsl_cdf_ugaussian_P((-a - mu) / sigma)
+         - gsl_cdf_ugaussian_P((-b - mu) / sigma));
+    if(verbose)
+        printf("P(Y > 0) = %lf\n", p / (p + z));
+
+    // Far tails on both sides don't produce NaN.
+    rtfnorm_fill(rng, 40.0, 41.0, 0.5, 1.0, 1000, v);
+    for(i = 0; i < 1000; ++i)
+        assert(40.0 <= v[i] && v[i] <= 41.0);
+
+    // Half-normal
+    rtfnorm_fill(rng, 0.0, 2.0, 0.0, 1.0, 1000, v);
+    for(i = 0; i < 1000; ++i)
+        assert(0.0 <= v[i] && v[i] <= 2.0);
+
+    // Affine transformation, positive and negative slopes.
+    a = -1.0, b = 2.0, mu = 0.5, sigma = 2.0;
+    gsl_rng_set(rng, 5);
+    rtnorm_fill_affine(rng, a, b, mu, sigma, 3.0, 2.0, N, v);
+    gsl_rng_set(rng, 5);
+    rtnorm_fill(rng, a, b, mu, sigma, N, w);
+    for(i = 0; i < N; ++i)
+        assert(fabs(v[i] - (3.0 + 2.0 * w[i])) < 1e-12);
+    rtnorm_fill_affine(rng, a, b, mu, sigma, 3.0, -2.0, N, v);
+    for(i = 0; i < N; ++i)
+        assert(-1.0 <= v[i] && v[i] <= 5.0);
+    m = mean(v, N);
+    expected = 3.0 - 2.0 * mean(w, N);
+    assert(fabs(m - expected) < 0.02);
+
+    gsl_rng_free(rng);
+    free(v);
+    free(w);
+    printf("%-26s %s\n", "xrtxform", "OK");
+    return 0;
+}
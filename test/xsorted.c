@@ -0,0 +1,133 @@
+//  Unit tests for rtnorm_fill_sorted.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "stats.h"
+
+#define N 100000
+
+// Critical value of the Kolmogorov-Smirnov statistic, times sqrt(n),
+// at level 0.001
+#define KS_CRIT 1.95
+
+static double cdf(double a, double b, double x);
+static double ks_sorted(double *v, size_t n, double a, double b,
+                        double mu, double sigma);
+
+// CDF at x of the standard Gaussian truncated to [a,b], computed in
+// the tail that holds the interval, so that it stays accurate far
+// from the mode.
+static double cdf(double a, double b, double x) {
+    double      la, lb;
+
+    if(x <= a)
+        return 0.0;
+    if(x >= b)
+        return 1.0;
+    if(b <= 0.0)
+        return 1.0 - cdf(-b, -a, -x);
+    la = stats_log_upper(a);
+    lb = stats_log_upper(b);
+    if(a >= 0.0)
+        return -expm1(stats_log_upper(x) - la) / -expm1(lb - la);
+    return (exp(stats_log_upper(-x)) - exp(stats_log_upper(-a))) /
+        (1.0 - exp(stats_log_upper(-a)) - exp(lb));
+}
+
+// Kolmogorov-Smirnov statistic of the sorted sample v[0..n-1] against
+// the Gaussian with mean mu and standard deviation sigma, truncated to
+// [a,b], scaled by sqrt(n). Replaces v by its CDF values, which stay
+// sorted.
+static double ks_sorted(double *v, size_t n, double a, double b,
+                        double mu, double sigma) {
+    size_t      i;
+
+    a = (a - mu) / sigma;
+    b = (b - mu) / sigma;
+    for(i = 0; i < n; ++i)
+        v[i] = cdf(a, b, (v[i] - mu) / sigma);
+    return stats_ks_sorted(v, n);
+}
+
+int main(int argc, char **argv) {
+    int         verbose = 0, j;
+    size_t      i;
+    double     *v = malloc(N * sizeof(double)), d;
+    gsl_rng    *rng = gsl_rng_alloc(gsl_rng_taus);
+    struct {
+        double      a, b, mu, sigma;
+    } c[] = {
+        {-INFINITY, INFINITY, 0.0, 1.0},
+        {-1.0, 2.0, 0.0, 1.0},
+        {0.5, 3.0, 0.0, 1.0},
+        {-5.0, -4.5, 0.0, 1.0},
+        {1e-3, 2e-3, 0.0, 1.0},
+        {-INFINITY, -8.0, 0.0, 1.0},
+        {3.0, 9.0, 2.0, 0.25},
+        {-3.0, 14.0, 4.0, 3.0},
+        {40.0, INFINITY, 0.0, 1.0},
+        {-60.0, -45.0, 0.0, 1.0},
+        {500.0, 500.01, 0.0, 1.0},
+    };
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(strncmp(argv[1], "-v", 2) != 0) {
+            fprintf(stderr, "usage: xsorted [-v]\n");
+            exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        fprintf(stderr, "usage: xsorted [-v]\n");
+        exit(EXIT_FAILURE);
+    }
+    assert(v && rng);
+    gsl_rng_set(rng, 3);
+
+    // Output is sorted, within bounds, and has the distribution of
+    // rtnorm, from the mode to the far tails on either side.
+    for(j = 0; j < (int) (sizeof(c) / sizeof(c[0])); ++j) {
+        rtnorm_fill_sorted(rng, c[j].a, c[j].b, c[j].mu, c[j].sigma, N, v);
+        for(i = 0; i < N; ++i) {
+            assert(c[j].a <= v[i] && v[i] <= c[j].b);
+            assert(i == 0 || v[i - 1] <= v[i]);
+        }
+        d = ks_sorted(v, N, c[j].a, c[j].b, c[j].mu, c[j].sigma);
+        if(verbose)
+            printf("[%g, %g] mu %g sigma %g: KS %.3f\n", c[j].a, c[j].b,
+                   c[j].mu, c[j].sigma, d);
+        assert(d < KS_CRIT);
+    }
+
+    // Small samples, and none
+    rtnorm_fill_sorted(rng, -1.0, 1.0, 0.0, 1.0, 1, v);
+    assert(-1.0 <= v[0] && v[0] <= 1.0);
+    v[0] = 7.0;
+    rtnorm_fill_sorted(rng, -1.0, 1.0, 0.0, 1.0, 0, v);
+    assert(v[0] == 7.0);
+
+    // Same seed, same sample
+    gsl_rng_set(rng, 5);
+    rtnorm_fill_sorted(rng, 0.2, 1.7, 0.0, 1.0, 1000, v);
+    gsl_rng_set(rng, 5);
+    rtnorm_fill_sorted(rng, 0.2, 1.7, 0.0, 1.0, 1000, v + 1000);
+    assert(memcmp(v, v + 1000, 1000 * sizeof(double)) == 0);
+
+    printf("%-26s %s\n", "xsorted", "OK");
+    free(v);
+    gsl_rng_free(rng);
+    return 0;
+}
@@ -0,0 +1,243 @@
+//  Unit tests for xoshiro.c and rtnorm_tls.c, including statistical
+//  tests of the eight streams of xoshiro256+x8.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gsl/gsl_rng.h>
+
+#include "rtnorm.h"
+#include "rtnorm_tls.h"
+#include "chunks.h"
+#include "xoshiro.h"
+
+#define NTHREADS 3
+#define M 1000
+
+// Chi-square with 255 degrees of freedom exceeds this with
+// probability 0.001, and sqrt(n) times a correlation exceeds this with
+// probability 6e-5.
+#define CHI2_255 330.5
+#define CORR_CRIT 4.0
+
+typedef struct Arg {
+    long        index;
+    double      out[M];
+} Arg;
+
+static void *worker(void *varg);
+static void reference(unsigned long seed, long index, double *out);
+
+// Each thread sets its index and draws M values, half singly.
+static void *worker(void *varg) {
+    Arg        *arg = varg;
+    int         i;
+
+    rtnorm_tls_thread(arg->index);
+    for(i = 0; i < M / 2; ++i)
+        arg->out[i] = rtnorm_tls(-1.0, 2.0, 0.5, 2.0);
+    rtnorm_tls_fill(-1.0, 2.0, 0.5, 2.0, M - M / 2, arg->out + M / 2);
+    return NULL;
+}
+
+// What thread "index" should draw with the given global seed.
+static void reference(unsigned long seed, long index, double *out) {
+    gsl_rng    *rng = gsl_rng_alloc(rtnorm_rng_xoshiro256p);
+
+    assert(rng);
+    gsl_rng_set(rng, chunk_seed(seed, index));
+    rtnorm_fill(rng, -1.0, 2.0, 0.5, 2.0, M, out);
+    gsl_rng_free(rng);
+}
+
+int main(int argc, char **argv) {
+    int         verbose = 0, i;
+    double      ref[M], v[M], u, sum = 0.0, lo = 0.0;
+    gsl_rng    *rng = gsl_rng_alloc(rtnorm_rng_xoshiro256p);
+    pthread_t   thread[NTHREADS];
+    Arg        *arg = malloc(NTHREADS * sizeof(Arg));
+    const long  n = 1000000;
+    long        j;
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(strncmp(argv[1], "-v", 2) != 0) {
+            fprintf(stderr, "usage: xtls [-v]\n");
+            exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        fprintf(stderr, "usage: xtls [-v]\n");
+        exit(EXIT_FAILURE);
+    }
+    assert(rng && arg);
+
+    // Known answers, from an independent implementation of the
+    // reference algorithm with splitmix64 seeding.
+    gsl_rng_set(rng, 1);
+    assert(gsl_rng_get(rng) == 0x02cbb47dUL);
+    assert(gsl_rng_get(rng) == 0xe2cdc0c2UL);
+    assert(gsl_rng_get(rng) == 0x288fe817UL);
+    assert(chunks_rng_type("xoshiro256+") == rtnorm_rng_xoshiro256p);
+    assert(strcmp(gsl_rng_name(rng), "xoshiro256+") == 0);
+
+    // Uniforms have the right mean and use more than 32 bits.
+    for(j = 0; j < n; ++j) {
+        u = gsl_rng_uniform(rng);
+        assert(0.0 <= u && u < 1.0);
+        sum += u;
+        lo += fmod(u * 4294967296.0, 1.0);
+    }
+    if(verbose)
+        printf("uniform mean %.5f, mean low part %.5f\n", sum / n, lo / n);
+    assert(fabs(sum / n - 0.5) < 5 * sqrt(1.0 / (12.0 * n)));
+    assert(fabs(lo / n - 0.5) < 0.01);
+
+    // Stream 0 of xoshiro256+x8 is xoshiro256+; the others differ.
+    {
+        gsl_rng    *x8 = gsl_rng_alloc(rtnorm_rng_xoshiro256px8);
+        double     *w = malloc(n * sizeof(double));
+        double     *z = malloc(M * sizeof(double)), chi, mean, var, c;
+        long        count[256], pairs[256], k, len;
+        unsigned long x, prev = 0;
+        int         lag;
+
+        assert(x8 && w && z);
+        assert(chunks_rng_type("xoshiro256+x8") == rtnorm_rng_xoshiro256px8);
+        gsl_rng_set(rng, 5);
+        gsl_rng_set(x8, 5);
+        for(j = 0; j < 8 * M; ++j) {
+            x = gsl_rng_get(x8);
+            if(j % 8 == 0)
+                assert(x == gsl_rng_get(rng));
+            else
+                assert(x != prev);
+            prev = x;
+        }
+
+        // Single draws and bulk fills of any length take the same
+        // numbers in the same order.
+        gsl_rng_set(x8, 6);
+        rtnorm_rng_uniform_fill(x8, M, ref);
+        gsl_rng_set(x8, 6);
+        for(i = j = 0; j < M; ++i) {
+            len = (i * 37) % 29;
+            if(len > M - j)
+                len = M - j;
+            if(i % 3 == 0)
+                z[j++] = gsl_rng_uniform(x8);
+            else {
+                rtnorm_rng_uniform_fill(x8, len, z + j);
+                j += len;
+            }
+        }
+        assert(memcmp(ref, z, M * sizeof(double)) == 0);
+
+        // Any generator can fill.
+        gsl_rng_set(rng, 7);
+        rtnorm_rng_uniform_fill(rng, M, ref);
+        gsl_rng_set(rng, 7);
+        for(j = 0; j < M; ++j)
+            assert(ref[j] == gsl_rng_uniform(rng));
+
+        // Moments, equidistribution of single values and of pairs, and
+        // correlation between the streams (lags 1 to 7) and within one
+        // (lag 8)
+        gsl_rng_set(x8, 8);
+        rtnorm_rng_uniform_fill(x8, n, w);
+        memset(count, 0, sizeof(count));
+        memset(pairs, 0, sizeof(pairs));
+        for(j = 0, mean = var = 0.0; j < n; ++j) {
+            assert(0.0 <= w[j] && w[j] < 1.0);
+            mean += w[j];
+            var += (w[j] - 0.5) * (w[j] - 0.5);
+            ++count[(int) (w[j] * 256)];
+            if(j % 2)
+                ++pairs[(int) (w[j - 1] * 16) * 16 + (int) (w[j] * 16)];
+        }
+        mean /= n;
+        var /= n;
+        if(verbose)
+            printf("x8: mean %.5f, variance %.5f\n", mean, var);
+        assert(fabs(mean - 0.5) < 5 * sqrt(1.0 / (12.0 * n)));
+        assert(fabs(var - 1.0 / 12) < 5 * sqrt(1.0 / (180.0 * n)));
+        for(k = 0, chi = 0.0; k < 256; ++k)
+            chi += (count[k] - n / 256.0) * (count[k] - n / 256.0)
+                / (n / 256.0);
+        if(verbose)
+            printf("x8: chi-square of values %.1f\n", chi);
+        assert(chi < CHI2_255);
+        for(k = 0, chi = 0.0; k < 256; ++k)
+            chi += (pairs[k] - n / 512.0) * (pairs[k] - n / 512.0)
+                / (n / 512.0);
+        if(verbose)
+            printf("x8: chi-square of pairs %.1f\n", chi);
+        assert(chi < CHI2_255);
+        for(lag = 1; lag <= 8; ++lag) {
+            for(j = lag, c = 0.0; j < n; ++j)
+                c += (w[j] - 0.5) * (w[j - lag] - 0.5);
+            c = c / (n - lag) * 12.0;
+            if(verbose)
+                printf("x8: correlation at lag %d %+.5f\n", lag, c);
+            assert(fabs(c) * sqrt((double) n) < CORR_CRIT);
+        }
+
+        // rtnorm draws the same distribution from it.
+        gsl_rng_set(x8, 9);
+        rtnorm_fill(x8, 0.0, INFINITY, 0.0, 1.0, n, w);
+        for(j = 0, mean = 0.0; j < n; ++j)
+            mean += w[j];
+        mean /= n;
+        assert(fabs(mean - sqrt(2 / M_PI)) < 5 * sqrt((1 - 2 / M_PI) / n));
+
+        gsl_rng_free(x8);
+        free(w);
+        free(z);
+    }
+
+    // The first thread to draw gets index 0.
+    rtnorm_tls_seed(42);
+    reference(42, 0, ref);
+    rtnorm_tls_fill(-1.0, 2.0, 0.5, 2.0, M, v);
+    assert(memcmp(ref, v, sizeof(v)) == 0);
+    assert(rtnorm_tls_rng() == rtnorm_tls_rng());
+
+    // Threads with fixed indices draw reproducible streams.
+    for(i = 0; i < NTHREADS; ++i) {
+        arg[i].index = i + 1;
+        assert(pthread_create(thread + i, NULL, worker, arg + i) == 0);
+    }
+    for(i = 0; i < NTHREADS; ++i) {
+        pthread_join(thread[i], NULL);
+        reference(42, i + 1, ref);
+        assert(memcmp(ref, arg[i].out, sizeof(ref)) == 0);
+    }
+
+    // A new global seed restarts every stream.
+    rtnorm_tls_seed(43);
+    reference(43, 0, ref);
+    for(i = 0; i < M; ++i)
+        v[i] = rtnorm_tls(-1.0, 2.0, 0.5, 2.0);
+    assert(memcmp(ref, v, sizeof(v)) == 0);
+
+    // So does setting the index.
+    rtnorm_tls_thread(7);
+    reference(43, 7, ref);
+    rtnorm_tls_fill(-1.0, 2.0, 0.5, 2.0, M, v);
+    assert(memcmp(ref, v, sizeof(v)) == 0);
+
+    gsl_rng_free(rng);
+    free(arg);
+    printf("%-26s %s\n", "xtls", "OK");
+    return 0;
+}
@@ -0,0 +1,110 @@
+//  Unit tests for rtnorm_views.hpp: range concepts, composition with
+//  standard views, agreement with generate, and streaming moments.
+//
+//  Licence: GNU General Public License Version 2
+//  see http://www.gnu.org/licenses/old-licenses/gpl-2.0.txt
+
+#undef NDEBUG
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <ranges>
+#include <vector>
+
+#include "rtnorm_views.hpp"
+
+#define N 200000
+
+typedef rtnorm::sample_view<std::mt19937_64> view64;
+static_assert(std::ranges::input_range<view64>);
+static_assert(std::ranges::view<view64>);
+static_assert(std::same_as<std::ranges::range_value_t<view64>, double>);
+
+// Standard Gaussian density
+static double phi(double z) {
+    return std::isinf(z) ? 0.0 : std::exp(-0.5 * z * z) / std::sqrt(2 * M_PI);
+}
+
+int main(int argc, char **argv) {
+    int         verbose = 0;
+    const double a = -0.5, b = 2.0;
+    double      z, mean, var, m, m2, delta;
+    std::size_t n;
+
+    switch (argc) {
+    case 1:
+        break;
+    case 2:
+        if(std::strncmp(argv[1], "-v", 2) != 0) {
+            std::fprintf(stderr, "usage: xviews [-v]\n");
+            std::exit(EXIT_FAILURE);
+        }
+        verbose = 1;
+        break;
+    default:
+        std::fprintf(stderr, "usage: xviews [-v]\n");
+        std::exit(EXIT_FAILURE);
+    }
+
+    // A view yields exactly what generate would.
+    {
+        std::mt19937_64 g(1), h(1);
+        rtnorm::truncated_normal_distribution<> d(1.0, 3.0, 0.5, 2.0);
+        std::vector<double> v(1000);
+        std::size_t i = 0;
+
+        d.generate(v.begin(), v.end(), h);
+        for(double x : rtnorm::views::samples(g, 1.0, 3.0, 0.5, 2.0)
+            | std::views::take(v.size())
+            | std::views::transform([](double y) {
+                                    return 2 * y;}))
+            assert(x == 2 * v[i++]);
+        assert(i == v.size());
+    }
+
+    // Streaming moments in constant memory
+    {
+        std::mt19937_64 g(2);
+
+        n = 0;
+        m = m2 = 0.0;
+        for(double x : rtnorm::views::samples(g, a, b) | std::views::take(N)) {
+            assert(a <= x && x <= b);
+            ++n;
+            delta = x - m;
+            m += delta / n;
+            m2 += delta * (x - m);
+        }
+        assert(n == N);
+
+        z = 0.5 * (std::erfc(-b * M_SQRT1_2) - std::erfc(-a * M_SQRT1_2));
+        mean = (phi(a) - phi(b)) / z;
+        var = 1 + (a * phi(a) - b * phi(b)) / z - mean * mean;
+        if(verbose)
+            std::printf("mean %.5f (exact %.5f) var %.5f (exact %.5f)\n",
+                        m, mean, m2 / (n - 1), var);
+        assert(std::fabs(m - mean) < 5 * std::sqrt(var / N));
+        assert(std::fabs(m2 / (n - 1) - var) < 0.02 * var);
+    }
+
+    // Floats, and views that stop mid-block
+    {
+        std::mt19937 g(3);
+        auto        s = rtnorm::views::samples<float>(g, 0.0, 1.0);
+        int         k = 0;
+
+        static_assert(std::same_as<std::ranges::range_value_t<decltype(s)>,
+                      float>);
+        for(float x : s) {
+            assert(0.0f <= x && x <= 1.0f);
+            if(++k == 100)
+                break;
+        }
+    }
+
+    std::printf("%-26s %s\n", "xviews", "OK");
+    return 0;
+}